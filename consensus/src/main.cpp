@@ -46,7 +46,7 @@ int main(int argc, char **argv) {
   readFastaReads(orig_reads, reads_filename.c_str());
   map_reads(&reads, orig_reads);
 
-  readAfgContigs(contigs, contigs_filename.c_str());
+  readAfgContigs(contigs, contigs_filename.c_str(), threadLen);
 
   std::cerr << "Read " << orig_reads.size() << " reads" << std::endl;
   std::cerr << "Read " << contigs.size() << " contigs" << std::endl;
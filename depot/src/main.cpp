@@ -7,26 +7,35 @@
 #include "ra/ra.hpp"
 #include <vector>
 
-using std::fstream;
 using std::string;
 using std::vector;
 
 // global vars
 cmdline::parser args;
 int thread_num;
+int batch_size;
 string reads_format;
+string quality_mode;
 string reads_filename;
 string overlaps_filename;
 string overlaps_format;
 string depot_path;
+string output_path;
+int shards_size;
+int shard_index;
 
 void init_args(int argc, char** argv) {
   // input params
   args.add<string>("depot", 'd', "depot path", true);
   args.add<string>("reads", 'r', "reads file", false);
   args.add<string>("overlaps", 'x', "overlaps file", false);
-  args.add<string>("overlaps_format", 'X', "overlaps format; supported: mhap, radump", false, "mhap");
-  args.add<string>("reads_format", 's', "reads format; supported: fasta, fastq, afg", false, "fasta");
+  args.add<string>("overlaps_format", 'X', "overlaps format; supported: mhap, paf, radump", false, "mhap");
+  args.add<string>("reads_format", 's', "reads format; supported: fasta, fastq (both optionally gzipped), afg", false, "fasta");
+  args.add<string>("quality", 'q', "quality mode used by import_reads; supported: raw, bin, drop", false, "raw");
+  args.add<int>("batch_size", 'b', "size of read batches in MB used by import_reads", false, 256);
+  args.add<string>("output", 'o', "sharded depot path created by shard", false);
+  args.add<int>("shards", 'n', "number of shards used by shard", false, 4);
+  args.add<int>("shard", 'k', "index of the shard used by dump_shard", false, 0);
 
   args.parse_check(argc, argv);
 }
@@ -36,51 +45,62 @@ void read_args() {
   depot_path = args.get<string>("depot");
   reads_filename = args.get<string>("reads");
   reads_format = args.get<string>("reads_format");
+  quality_mode = args.get<string>("quality");
   overlaps_filename = args.get<string>("overlaps");
   overlaps_format = args.get<string>("overlaps_format");
+  batch_size = args.get<int>("batch_size");
+  output_path = args.get<string>("output");
+  shards_size = args.get<int>("shards");
+  shard_index = args.get<int>("shard");
 }
 
-void load_reads(vector<Read*>* reads) {
+void import_reads_cmd() {
   if (reads_filename.size() == 0) {
     fprintf(stderr, "Reads filename is not provided\n");
     exit(1);
   }
 
-  fprintf(stderr, "Reading %s...\n", reads_filename.c_str());
+  ReadFormat format;
   if (reads_format == "fasta") {
-    readFastaReads(*reads, reads_filename.c_str());
+    format = ReadFormat::kFasta;
   } else if (reads_format == "fastq") {
-    readFastqReads(*reads, reads_filename.c_str());
+    format = ReadFormat::kFastq;
   } else if (reads_format == "afg") {
-    readAfgReads(*reads, reads_filename.c_str());
+    format = ReadFormat::kAfg;
   } else {
-    assert(false);
+    fprintf(stderr, "Reads format '%s' not supported\n", reads_format.c_str());
+    exit(1);
   }
 
-  fprintf(stderr, "Read %lu reads\n", reads->size());
-}
-
-void import_reads_cmd() {
-  vector<Read*> reads;
-
-  load_reads(&reads);
+  QualityMode quality;
+  if (quality_mode == "raw") {
+    quality = QualityMode::kRaw;
+  } else if (quality_mode == "bin") {
+    quality = QualityMode::kBinned;
+  } else if (quality_mode == "drop") {
+    quality = QualityMode::kDrop;
+  } else {
+    fprintf(stderr, "Quality mode '%s' not supported\n", quality_mode.c_str());
+    exit(1);
+  }
 
-  fprintf(stderr, "Filling depot with reads...\n");
   Depot depot(depot_path);
 
-  depot.store_reads(reads);
+  // reads are parsed and stored in batches so memory usage is bounded
+  fprintf(stderr, "Filling depot with reads from %s...\n", reads_filename.c_str());
+  ReadBatchReader reader(reads_filename.c_str(), format, 0,
+      (uint64_t) batch_size << 20, thread_num, quality);
+  depot.store_reads(reader);
 
   fprintf(stderr, "Depot filled\n");
-
-  for (auto r: reads)    delete r;
 }
 
 void load_overlaps(OverlapSet* overlaps, const string overlaps_path, const string overlaps_format, ReadSet& reads) {
 
   if (overlaps_format == "mhap") {
-    fstream overlaps_file(overlaps_filename);
-    MHAP::read_overlaps(*overlaps, reads, overlaps_file);
-    overlaps_file.close();
+    MHAP::read_overlaps(*overlaps, reads, overlaps_path.c_str(), thread_num);
+  } else if (overlaps_format == "paf") {
+    PAF::read_overlaps(*overlaps, reads, overlaps_path.c_str(), thread_num);
   } else if (overlaps_format == "radump") {
     FILE* fd = must_fopen(overlaps_path, "r");
     readRadumpOverlaps(overlaps, reads, fd);
@@ -128,7 +148,7 @@ void dump_overlaps_cmd() {
   vector<Read*> reads;
   vector<Overlap*> overlaps;
 
-  Depot depot(depot_path);
+  Depot depot(depot_path, true);
 
   fprintf(stderr, "Reading reads...\n");
   depot.load_reads(reads);
@@ -139,24 +159,82 @@ void dump_overlaps_cmd() {
   fprintf(stderr, "Read %lu overlaps\n", overlaps.size());
 
   fprintf(stderr, "a_id\tb_id\ttype\ta_lo\ta_hi\ta_len\tb_lo\tb_hi\tb_len\torig_error\twiden_error\n");
-  writeRadumpOverlaps(stdout, overlaps);
+  writeRadumpOverlaps(stdout, overlaps, thread_num);
+}
+
+void compact_cmd() {
+  Depot depot(depot_path);
+
+  fprintf(stderr, "Compacting overlaps...\n");
+  depot.compact_overlaps();
+  fprintf(stderr, "Depot compacted\n");
 }
 
 void dump_reads_cmd() {
-  vector<Read*> reads;
+  ReadStore reads;
 
-  Depot depot(depot_path);
+  Depot depot(depot_path, true);
 
   fprintf(stderr, "Reading reads...\n");
   depot.load_reads(reads);
   fprintf(stderr, "Read %lu reads\n", reads.size());
 
   fprintf(stderr, "id\tlen\tcov\n");
-  for (auto r : reads) {
+  for (const auto& r : reads) {
     fprintf(stdout, "%d\t%u\t%lf\n", r->id(), r->length(), r->coverage());
   }
 }
 
+void shard_cmd() {
+  if (output_path.size() == 0) {
+    fprintf(stderr, "Sharded depot path is not provided\n");
+    exit(1);
+  }
+
+  vector<Read*> reads;
+  vector<Overlap*> overlaps;
+
+  Depot depot(depot_path, true);
+
+  fprintf(stderr, "Reading reads...\n");
+  depot.load_reads(reads);
+  fprintf(stderr, "Read %lu reads\n", reads.size());
+
+  fprintf(stderr, "Reading overlaps...\n");
+  depot.load_overlaps(overlaps, reads);
+  fprintf(stderr, "Read %lu overlaps\n", overlaps.size());
+
+  ShardedDepot sharded(output_path);
+  sharded.store(reads, overlaps, shards_size);
+
+  fprintf(stderr, "shard\treads_begin\treads_end\tboundary_reads\toverlaps\tboundary_overlaps\n");
+  for (uint32_t k = 0; k < sharded.size(); ++k) {
+    const auto& it = sharded.manifest(k);
+    fprintf(stderr, "%u\t%lu\t%lu\t%lu\t%lu\t%lu\n", k, it.reads_begin, it.reads_end,
+      it.boundary_reads, it.overlaps, it.boundary_overlaps);
+  }
+
+  for (auto r: reads)     delete r;
+  for (auto o: overlaps)  delete o;
+}
+
+void dump_shard_cmd() {
+  vector<Read*> reads;
+  vector<Overlap*> overlaps;
+
+  ShardedDepot depot(depot_path, true);
+
+  fprintf(stderr, "Reading shard %d...\n", shard_index);
+  depot.load_shard(shard_index, reads, overlaps);
+  fprintf(stderr, "Read %lu overlaps\n", overlaps.size());
+
+  fprintf(stderr, "a_id\tb_id\ttype\ta_lo\ta_hi\ta_len\tb_lo\tb_hi\tb_len\torig_error\twiden_error\n");
+  writeRadumpOverlaps(stdout, overlaps, thread_num);
+
+  for (auto r: reads)     delete r;
+  for (auto o: overlaps)  delete o;
+}
+
 int main(int argc, char **argv) {
 
   init_args(argc, argv);
@@ -178,6 +256,12 @@ int main(int argc, char **argv) {
     dump_overlaps_cmd();
   } else if (cmd == "dump_reads") {
     dump_reads_cmd();
+  } else if (cmd == "compact") {
+    compact_cmd();
+  } else if (cmd == "shard") {
+    shard_cmd();
+  } else if (cmd == "dump_shard") {
+    dump_shard_cmd();
   } else {
     fprintf(stderr, "Command '%s' not defined\n", cmd.c_str());
     args.usage();
@@ -66,7 +66,7 @@ int main(int argc, char **argv) {
   filterContainedOverlaps(nocontainments, overlaps, reads, true);
 
   fprintf(stderr, "Updating depot...\n");
-  depot.store_overlaps(nocontainments);
+  depot.update_overlaps(overlaps, nocontainments);
 
   for (auto r: reads)    delete r;
   for (auto o: overlaps) delete o;
@@ -4,6 +4,7 @@
 
 #include "cmdline/cmdline.h"
 #include "ra/ra.hpp"
+#include <algorithm>
 #include <vector>
 
 using std::fstream;
@@ -53,74 +54,36 @@ void write_specs_to(const string path) {
   fclose(spec_file_fd);
 }
 
-void filter_overlaps_by_absolute_errate(OverlapSet* overlaps, double upper_limit) {
-  fprintf(stderr, "Filtering overlaps with errate > %lf\n", upper_limit);
-
-  int next_position = 0, size_before = overlaps->size();
-  for (int i = 0; i < (int) overlaps->size(); ++i) {
-    auto o = (*overlaps)[i];
-    if (o->err_rate() >= upper_limit) continue;
-
-    (*overlaps)[next_position] = o;
-    next_position++;
-  }
-
-  overlaps->resize(next_position);
-
-  int diff = size_before - overlaps->size();
+void print_filtered(int size_before, int size_after) {
+  int diff = size_before - size_after;
   fprintf(stderr, "Filtered %d overlaps (%lf%%)\n", diff, 100.0 * diff / size_before);
 }
 
-void print_stats(OverlapSet& overlaps) {
-  fprintf(stderr, "Statistic\terror_rate\tcount\n");
+void print_stats(vector<double>& err_rates) {
+  sort(err_rates.begin(), err_rates.end());
 
-  int index = 0.5 * overlaps.size();
-  fprintf(stderr, "p50\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  fprintf(stderr, "Statistic\terror_rate\tcount\n");
 
-  index = 0.6 * overlaps.size();
-  fprintf(stderr, "p60\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  int index = 0.5 * err_rates.size();
+  fprintf(stderr, "p50\t%lf\t%d\n", err_rates[index], index);
 
-  index = 0.7 * overlaps.size();
-  fprintf(stderr, "p70\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  index = 0.6 * err_rates.size();
+  fprintf(stderr, "p60\t%lf\t%d\n", err_rates[index], index);
 
-  index = 0.8 * overlaps.size();
-  fprintf(stderr, "p80\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  index = 0.7 * err_rates.size();
+  fprintf(stderr, "p70\t%lf\t%d\n", err_rates[index], index);
 
-  index = 0.9 * overlaps.size();
-  fprintf(stderr, "p90\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  index = 0.8 * err_rates.size();
+  fprintf(stderr, "p80\t%lf\t%d\n", err_rates[index], index);
 
-  index = 0.95 * overlaps.size();
-  fprintf(stderr, "p95\t%lf\t%d\n", overlaps[index]->err_rate(), index);
+  index = 0.9 * err_rates.size();
+  fprintf(stderr, "p90\t%lf\t%d\n", err_rates[index], index);
 
-  index = 0.99 * overlaps.size();
-  fprintf(stderr, "p99\t%lf\t%d\n", overlaps[index]->err_rate(), index);
-}
+  index = 0.95 * err_rates.size();
+  fprintf(stderr, "p95\t%lf\t%d\n", err_rates[index], index);
 
-bool compare_by_errate(Overlap* a, Overlap* b) {
-  return a->err_rate() < b->err_rate();
-}
-
-void filter_overlaps_by_covered_length(OverlapSet* overlaps, double min_length) {
-  fprintf(stderr, "Filtering overlaps with covered length < %lf\n", min_length);
-
-  int next_position = 0, size_before = overlaps->size();
-  for (int i = 0; i < (int) overlaps->size(); ++i) {
-    auto o = (*overlaps)[i];
-    if (o->covered_percentage(o->a()) < min_length) {
-      continue;
-    }
-    if (o->covered_percentage(o->b()) < min_length) {
-      continue;
-    }
-
-    (*overlaps)[next_position] = o;
-    next_position++;
-  }
-
-  overlaps->resize(next_position);
-
-  int diff = size_before - overlaps->size();
-  fprintf(stderr, "Filtered %d overlaps (%lf%%)\n", diff, 100.0 * diff / size_before);
+  index = 0.99 * err_rates.size();
+  fprintf(stderr, "p99\t%lf\t%d\n", err_rates[index], index);
 }
 
 int main(int argc, char **argv) {
@@ -130,29 +93,52 @@ int main(int argc, char **argv) {
   init_specs();
 
   vector<Read*> reads;
-  vector<Overlap*> overlaps;
 
   Depot depot(depot_path);
 
   depot.load_reads(reads);
   fprintf(stderr, "Read %lu reads\n", reads.size());
 
-  depot.load_overlaps(overlaps, reads);
-  fprintf(stderr, "Read %lu overlaps\n", overlaps.size());
+  // overlaps are selected in the depot, only error rates and indices are kept in memory
+  vector<double> err_rates, covered_err_rates, kept_err_rates;
+  depot.load_overlap_err_rates(err_rates);
+  fprintf(stderr, "Read %lu overlaps\n", err_rates.size());
+
+  OverlapPredicate covered;
+  covered.min_covered = MIN_COVERED_LENGTH;
 
-  sort(overlaps.begin(), overlaps.end(), compare_by_errate);
+  OverlapPredicate kept = covered;
+  kept.max_err_rate = MAX_ABSOLUTE_ERRATE;
+
+  vector<uint32_t> covered_indices, kept_indices, filtered;
+  depot.select_overlaps(covered_indices, reads, covered);
+  depot.select_overlaps(kept_indices, reads, kept);
+
+  for (auto i: covered_indices) covered_err_rates.push_back(err_rates[i]);
+  for (auto i: kept_indices)    kept_err_rates.push_back(err_rates[i]);
+
+  for (uint32_t i = 0, j = 0; i < err_rates.size(); ++i) {
+    if (j < kept_indices.size() && kept_indices[j] == i) {
+      ++j;
+      continue;
+    }
+    filtered.push_back(i);
+  }
 
-  print_stats(overlaps);
-  filter_overlaps_by_covered_length(&overlaps, MIN_COVERED_LENGTH);
-  print_stats(overlaps);
-  filter_overlaps_by_absolute_errate(&overlaps, MAX_ABSOLUTE_ERRATE);
-  print_stats(overlaps);
+  print_stats(err_rates);
+  fprintf(stderr, "Filtering overlaps with covered length < %lf\n", MIN_COVERED_LENGTH);
+  print_filtered(err_rates.size(), covered_err_rates.size());
+  print_stats(covered_err_rates);
+  fprintf(stderr, "Filtering overlaps with errate > %lf\n", MAX_ABSOLUTE_ERRATE);
+  print_filtered(covered_err_rates.size(), kept_err_rates.size());
+  print_stats(kept_err_rates);
 
   fprintf(stderr, "Updating depot...\n");
-  depot.store_overlaps(overlaps);
+  // kept overlaps stay in their stored order, the depot is not rewritten
+  // sorted by error rate anymore
+  depot.remove_overlaps(filtered);
 
   for (auto r: reads)               delete r;
-  for (auto o: overlaps)            delete o;
 
   write_specs_to(working_directory + "/filter_erroneous_overlaps.spec");
 
@@ -52,7 +52,7 @@ int main(int argc, char **argv) {
   fprintf(stderr, "%0.2lf%% overlaps filtered as transitive\n", fraction * 100);
 
   fprintf(stderr, "Updating depot...");
-  depot.store_overlaps(notransitives);
+  depot.update_overlaps(overlaps, notransitives);
 
   for (auto r: reads)       delete r;
   for (auto o: overlaps)    delete o;
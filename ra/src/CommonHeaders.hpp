@@ -20,8 +20,10 @@
 #include <sys/stat.h>
 
 #include <mutex>
+#include <condition_variable>
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <cassert>
@@ -29,12 +31,15 @@
 #include <cmath>
 #include <string>
 #include <thread>
+#include <atomic>
 #include <vector>
 #include <stack>
 #include <deque>
 #include <tuple>
+#include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <set>
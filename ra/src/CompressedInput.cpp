@@ -0,0 +1,290 @@
+/*!
+ * @file CompressedInput.cpp
+ *
+ * @brief CompressedInput class source file
+ */
+
+#include <condition_variable>
+#include <zlib.h>
+
+#include "CompressedInput.hpp"
+
+// gzip member header without optional fields
+static const uint32_t kGzipHeaderSize = 12;
+static const uint32_t kGzipFooterSize = 8;
+
+// decompressed bytes returned by one gzip read
+static const uint32_t kGzipChunkSize = 1 << 20;
+
+static uint32_t readUint16(const unsigned char* bytes) {
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static uint32_t readUint32(const unsigned char* bytes) {
+    return readUint16(bytes) | (readUint16(bytes + 2) << 16);
+}
+
+// returns BSIZE + 1 of a BGZF block or 0 if extra field has no BC subfield
+static uint32_t bgzfBlockSize(const unsigned char* extra, uint32_t extra_length) {
+
+    for (uint32_t i = 0; i + 4 <= extra_length;) {
+
+        uint32_t subfield_length = readUint16(extra + i + 2);
+
+        if (extra[i] == 'B' && extra[i + 1] == 'C' && subfield_length == 2 &&
+            i + 6 <= extra_length) {
+            return readUint16(extra + i + 4) + 1;
+        }
+
+        i += 4 + subfield_length;
+    }
+
+    return 0;
+}
+
+Compression detectCompression(const char* path) {
+
+    FILE* f = fopen(path, "rb");
+    ASSERT(f != nullptr, "CompressedInput", "cannot open file %s with mode rb", path);
+
+    unsigned char header[kGzipHeaderSize + 6];
+    size_t header_length = fread(header, 1, sizeof(header), f);
+    fclose(f);
+
+    if (header_length < kGzipHeaderSize || header[0] != 0x1f || header[1] != 0x8b) {
+        return Compression::kNone;
+    }
+
+    // FEXTRA flag
+    if ((header[3] & 4) != 0 && bgzfBlockSize(header + kGzipHeaderSize,
+        std::min<uint32_t>(readUint16(header + 10), header_length - kGzipHeaderSize)) != 0) {
+        return Compression::kBgzf;
+    }
+
+    return Compression::kGzip;
+}
+
+//*****************************************************************************
+// gzip
+
+class GzipInput: public CompressedInput {
+public:
+
+    GzipInput(const char* path) {
+        file_ = gzopen(path, "rb");
+        ASSERT(file_ != nullptr, "CompressedInput", "cannot open file %s", path);
+        gzbuffer(file_, 1 << 17);
+    }
+
+    ~GzipInput() {
+        gzclose(file_);
+    }
+
+    bool read(std::vector<char>& dst) {
+
+        size_t size = dst.size();
+        dst.resize(size + kGzipChunkSize);
+
+        int length = gzread(file_, dst.data() + size, kGzipChunkSize);
+        ASSERT(length >= 0, "CompressedInput", "corrupted gzip input");
+
+        dst.resize(size + length);
+        return length > 0;
+    }
+
+private:
+
+    gzFile file_;
+};
+
+//*****************************************************************************
+// BGZF
+
+class BgzfInput: public CompressedInput {
+public:
+
+    BgzfInput(const char* path, int threadLen)
+            : file_(nullptr), next_block_(0), consumed_blocks_(0),
+            total_blocks_(-1), stop_(false), ready_(), threads_() {
+
+        file_ = fopen(path, "rb");
+        ASSERT(file_ != nullptr, "CompressedInput", "cannot open file %s with mode rb", path);
+
+        threadLen = std::max(threadLen, 1);
+        capacity_ = 4 * threadLen;
+
+        for (int i = 0; i < threadLen; ++i) {
+            threads_.emplace_back(&BgzfInput::inflate_blocks, this);
+        }
+    }
+
+    ~BgzfInput() {
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        not_full_.notify_all();
+
+        for (auto& it: threads_) {
+            it.join();
+        }
+
+        fclose(file_);
+    }
+
+    bool read(std::vector<char>& dst) {
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (true) {
+
+            not_empty_.wait(lock, [&] {
+                return consumed_blocks_ == total_blocks_ ||
+                    ready_.count(consumed_blocks_) != 0;
+            });
+
+            if (consumed_blocks_ == total_blocks_) return false;
+
+            // hand over all consecutive blocks which are already inflated
+            size_t size = dst.size();
+            for (auto it = ready_.find(consumed_blocks_); it != ready_.end() &&
+                it->first == consumed_blocks_; it = ready_.erase(it), ++consumed_blocks_) {
+                dst.insert(dst.end(), it->second.begin(), it->second.end());
+            }
+
+            not_full_.notify_all();
+
+            // empty blocks (e.g. the EOF marker) are skipped
+            if (dst.size() != size) return true;
+        }
+    }
+
+private:
+
+    // reads the next compressed block, must be called with mutex_ locked
+    bool read_block(std::vector<unsigned char>& block) {
+
+        unsigned char header[kGzipHeaderSize];
+        size_t header_length = fread(header, 1, kGzipHeaderSize, file_);
+        if (header_length == 0) return false;
+
+        ASSERT(header_length == kGzipHeaderSize && header[0] == 0x1f &&
+            header[1] == 0x8b && (header[3] & 4) != 0, "CompressedInput",
+            "corrupted BGZF block");
+
+        uint32_t extra_length = readUint16(header + 10);
+        block.resize(extra_length);
+        ASSERT(fread(block.data(), 1, extra_length, file_) == extra_length,
+            "CompressedInput", "corrupted BGZF block");
+
+        uint32_t block_size = bgzfBlockSize(block.data(), extra_length);
+        ASSERT(block_size >= kGzipHeaderSize + extra_length + kGzipFooterSize,
+            "CompressedInput", "corrupted BGZF block");
+
+        uint32_t data_length = block_size - kGzipHeaderSize - extra_length;
+        block.resize(data_length);
+        ASSERT(fread(block.data(), 1, data_length, file_) == data_length,
+            "CompressedInput", "corrupted BGZF block");
+
+        return true;
+    }
+
+    void inflate_block(std::vector<char>& dst, std::vector<unsigned char>& block) {
+
+        uint32_t compressed_length = block.size() - kGzipFooterSize;
+        uint32_t length = readUint32(block.data() + compressed_length + 4);
+
+        dst.resize(length);
+        if (length == 0) return;
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        ASSERT(inflateInit2(&stream, -15) == Z_OK, "CompressedInput",
+            "cannot initialize zlib");
+
+        stream.next_in = block.data();
+        stream.avail_in = compressed_length;
+        stream.next_out = (unsigned char*) dst.data();
+        stream.avail_out = length;
+
+        int status = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        ASSERT(status == Z_STREAM_END && stream.total_out == length &&
+            crc32(0, stream.next_out - length, length) == readUint32(block.data() +
+            compressed_length), "CompressedInput", "corrupted BGZF block");
+    }
+
+    void inflate_blocks() {
+
+        std::vector<unsigned char> block;
+
+        while (true) {
+
+            uint64_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+
+                // at most capacity_ blocks are inflated ahead of the reader
+                not_full_.wait(lock, [&] {
+                    return stop_ || next_block_ == total_blocks_ ||
+                        next_block_ < consumed_blocks_ + capacity_;
+                });
+
+                if (stop_ || next_block_ == total_blocks_) return;
+
+                if (!read_block(block)) {
+                    total_blocks_ = next_block_;
+                    not_full_.notify_all();
+                    not_empty_.notify_all();
+                    return;
+                }
+
+                index = next_block_++;
+            }
+
+            std::vector<char> data;
+            inflate_block(data, block);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_[index].swap(data);
+            }
+            not_empty_.notify_all();
+        }
+    }
+
+    FILE* file_;
+
+    uint64_t next_block_;
+    uint64_t consumed_blocks_;
+    uint64_t total_blocks_;
+    uint64_t capacity_;
+    bool stop_;
+
+    std::map<uint64_t, std::vector<char>> ready_;
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+
+    std::vector<std::thread> threads_;
+};
+
+//*****************************************************************************
+// CompressedInput
+
+CompressedInput* CompressedInput::create(const char* path, int threadLen) {
+
+    switch (detectCompression(path)) {
+        case Compression::kGzip:
+            return new GzipInput(path);
+        case Compression::kBgzf:
+            return new BgzfInput(path, threadLen);
+        default:
+            ASSERT(false, "CompressedInput", "file %s is not compressed", path);
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,61 @@
+/*!
+ * @file CompressedInput.hpp
+ *
+ * @brief CompressedInput class header file
+ */
+
+#pragma once
+
+#include "CommonHeaders.hpp"
+
+/*!
+ * @brief Input file compression types
+ */
+enum class Compression {
+    kNone,
+    kGzip,
+    kBgzf
+};
+
+/*!
+ * @brief Method for compression detection
+ * @details Checks the gzip magic bytes and the BGZF extra subfield.
+ *
+ * @param [in] path path to file
+ * @return compression type
+ */
+Compression detectCompression(const char* path);
+
+/*!
+ * @brief CompressedInput class
+ * @details Sequential source of decompressed bytes. Gzip files (including
+ * concatenated members) are inflated by zlib as they are read. BGZF files
+ * are split into independent blocks which are inflated by worker threads
+ * and handed over in file order through a bounded queue.
+ */
+class CompressedInput {
+public:
+
+    /*!
+     * @brief Method for CompressedInput creation
+     *
+     * @param [in] path path to gzip or BGZF compressed file
+     * @param [in] threadLen number of threads used for BGZF decompression
+     * @return CompressedInput object pointer
+     */
+    static CompressedInput* create(const char* path, int threadLen);
+
+    /*!
+     * @brief CompressedInput destructor
+     */
+    virtual ~CompressedInput() {};
+
+    /*!
+     * @brief Method for decompressed input retrieval
+     * @details Appends the next part of decompressed input to dst.
+     *
+     * @param [out] dst byte buffer
+     * @return false if the end of input was reached (nothing is appended)
+     */
+    virtual bool read(std::vector<char>& dst) = 0;
+};
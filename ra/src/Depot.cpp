@@ -7,11 +7,20 @@
  * @date Oct 14, 2015
  */
 
+#include <sys/mman.h>
+
 #include "DepotObject.hpp"
+#include "IO.hpp"
 #include "Depot.hpp"
 
 constexpr mode_t kPermissions = 0775;
-constexpr uint32_t kBufferSize = 1024 * 1024 * 1024;
+constexpr uint32_t kBufferSize = 64 * 1024 * 1024;
+constexpr uint32_t kColumnBufferSize = 1024 * 1024;
+constexpr uint32_t kReadBlockSize = 4 * 1024 * 1024;
+constexpr uint64_t kPrefetchWindow = 16 * 1024 * 1024;
+constexpr uint32_t kPrefetchAhead = 4;
+// objects deserialized between updates of the prefetching position
+constexpr uint32_t kPrefetchObjects = 4096;
 
 FILE* fopenWrapper(const char* file_name, const char* mode) {
     auto file = fopen(file_name, mode);
@@ -77,12 +86,243 @@ void openAndLockFile(FILE** dst, const char* path) {
     flockWrapper(*dst, LOCK_EX | LOCK_NB);
 }
 
+void openAndShareLockFile(FILE** dst, const char* path) {
+    *dst = fopenWrapper(path, "rb");
+    flockWrapper(*dst, LOCK_SH | LOCK_NB);
+}
+
+const char* mmapWrapper(FILE* file, size_t* length) {
+
+    struct stat buf;
+    ASSERT(fstat(fileno(file), &buf) == 0, "Depot", "Unable to stat file (fstat)!");
+
+    *length = buf.st_size;
+    if (*length == 0) {
+        return nullptr;
+    }
+
+    auto data = mmap(nullptr, *length, PROT_READ, MAP_SHARED, fileno(file), 0);
+    ASSERT(data != MAP_FAILED, "Depot", "Unable to map file (mmap)!");
+
+    return (const char*) data;
+}
+
+void munmapWrapper(const char* data, size_t length) {
+    if (data != nullptr) {
+        munmap((void*) data, length);
+    }
+}
+
+uint32_t threadsSize() {
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// splits [0, length) into one range per thread
+void parallelRanges(uint32_t length,
+    const std::function<void(uint32_t, uint32_t)>& function) {
+
+    uint32_t threads_size = std::max(1U, std::min(threadsSize(), length));
+    if (threads_size == 1) {
+        function(0, length);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < threads_size; ++i) {
+        threads.emplace_back(function, (uint64_t) length * i / threads_size,
+            (uint64_t) length * (i + 1) / threads_size);
+    }
+
+    for (auto& it: threads) {
+        it.join();
+    }
+}
+
+void prefetchMemory(const char* begin, const char* end) {
+
+    static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+
+    // advice only, errors are ignored
+    uintptr_t aligned = (uintptr_t) begin & ~(page_size - 1);
+    madvise((void*) aligned, (uintptr_t) end - aligned, MADV_WILLNEED);
+}
+
+// asks the kernel to read mapped ranges into the page cache on a background
+// thread, so disk reads overlap with deserialization on the calling threads;
+// all ranges are split into the same number of windows which are read in
+// order, at most ahead windows beyond the position set with advance (or all
+// at once if ahead is zero)
+class Prefetcher {
+public:
+
+    Prefetcher(const std::vector<std::pair<const char*, const char*>>& ranges,
+        uint32_t ahead)
+            : ranges_(ranges), windows_(0), ahead_(ahead), position_(0),
+            stop_(false), mutex_(), condition_(), thread_() {
+
+        for (const auto& it: ranges_) {
+            windows_ = std::max<uint64_t>(windows_,
+                (it.second - it.first + kPrefetchWindow - 1) / kPrefetchWindow);
+        }
+
+        thread_ = std::thread(&Prefetcher::run, this);
+    }
+
+    ~Prefetcher() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_one();
+        thread_.join();
+    }
+
+    void advance(uint64_t done, uint64_t total) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            position_ = windows_ * done / std::max<uint64_t>(total, 1);
+        }
+        condition_.notify_one();
+    }
+
+private:
+
+    void run() {
+
+        for (uint64_t window = 0; window < windows_; ++window) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [&]() {
+                    return stop_ || ahead_ == 0 || window < position_ + ahead_; });
+                if (stop_) {
+                    return;
+                }
+            }
+
+            for (const auto& it: ranges_) {
+                uint64_t length = it.second - it.first;
+                uint64_t lo = length * window / windows_;
+                uint64_t hi = length * (window + 1) / windows_;
+                if (lo < hi) {
+                    prefetchMemory(it.first + lo, it.first + hi);
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<const char*, const char*>> ranges_;
+    uint64_t windows_;
+    uint64_t ahead_;
+    uint64_t position_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+};
+
+// mapped memory holding objects [begin, end)
+std::pair<const char*, const char*> mappedRange(const DepotMapping& mapping,
+    uint32_t begin, uint32_t end) {
+
+    if (mapping.blocked()) {
+        return std::make_pair(mapping.data() + mapping.block_offset(mapping.block_of(begin)),
+            mapping.data() + mapping.block_offset(mapping.block_of(end - 1) + 1));
+    }
+
+    return std::make_pair(mapping.data() + mapping.object_offset(begin),
+        mapping.data() + mapping.object_offset(end));
+}
+
+// decodes the blocks holding objects [begin, end) in rounds of one block per
+// thread and passes the objects of each round in order with the index of the
+// first one relative to begin
+void forEachBlockRound(const DepotMapping& mapping, uint32_t begin, uint32_t end,
+    const std::function<void(const std::vector<const char*>&, uint32_t)>& function) {
+
+    uint32_t first_block = mapping.block_of(begin);
+    uint32_t last_block = mapping.block_of(end - 1);
+
+    uint32_t threads = threadsSize();
+    std::vector<ReadBlock> decoded(std::min(threads, last_block - first_block + 1));
+    std::vector<const char*> records;
+
+    for (uint32_t block = first_block; block <= last_block; block += threads) {
+
+        uint32_t round = std::min(threads, last_block - block + 1);
+
+        parallelRanges(round, [&](uint32_t range_begin, uint32_t range_end) {
+            for (uint32_t i = range_begin; i < range_end; ++i) {
+                mapping.decode_block(decoded[i], block + i);
+            }
+        });
+
+        records.clear();
+        uint32_t first = std::max(begin, mapping.block_begin(block)) - begin;
+
+        for (uint32_t i = 0; i < round; ++i) {
+            uint32_t block_begin = mapping.block_begin(block + i);
+            uint32_t j = begin > block_begin ? begin - block_begin : 0;
+
+            for (; j < decoded[i].size() && block_begin + j < end; ++j) {
+                records.push_back(decoded[i].record(j));
+            }
+        }
+
+        function(records, first);
+    }
+}
+
+std::string overlapSegmentPath(const std::string& path, uint32_t segment) {
+    return path + "/overlap_segment_" + std::to_string(segment) + ".bin";
+}
+
+std::string overlapAdjacencyPath(const std::string& path, uint32_t segment) {
+    return segment == 0 ? path + "/overlap_adjacency.bin" :
+        path + "/overlap_adjacency_" + std::to_string(segment) + ".bin";
+}
+
+std::string overlapZonesPath(const std::string& path, uint32_t segment) {
+    return segment == 0 ? path + "/overlap_zones.bin" :
+        path + "/overlap_zones_" + std::to_string(segment) + ".bin";
+}
+
+FILE* fopenIfExists(const char* path) {
+    return pathExists(path) == 0 ? fopenWrapper(path, "rb") : nullptr;
+}
+
 void unlockAndCloseFile(FILE* file) {
     flockWrapper(file, LOCK_UN);
     fclose(file);
 }
 
-Depot::Depot(const std::string& path) {
+Depot::Depot(const std::string& path, bool read_only)
+        : depot_path_(path), read_only_(read_only) {
+
+    if (read_only) {
+        ASSERT(pathExists(path.c_str()) == 0, "Depot", "Missing depot folder %s!",
+            path.c_str());
+
+        std::string path_ = path + "/read_data.bin";
+        openAndShareLockFile(&read_data_, path_.c_str());
+
+        path_ = path + "/read_index.bin";
+        openAndShareLockFile(&read_index_, path_.c_str());
+
+        path_ = path + "/overlap_data.bin";
+        openAndShareLockFile(&overlap_data_, path_.c_str());
+
+        path_ = path + "/overlap_index.bin";
+        openAndShareLockFile(&overlap_index_, path_.c_str());
+
+        // missing in depots written before overlaps could be removed
+        path_ = path + "/overlap_tombstones.bin";
+        overlap_tombstones_ = nullptr;
+        if (pathExists(path_.c_str()) == 0) {
+            openAndShareLockFile(&overlap_tombstones_, path_.c_str());
+        }
+        return;
+    }
 
     createFolder(path.c_str());
 
@@ -97,6 +337,9 @@ Depot::Depot(const std::string& path) {
 
     path_ = path + "/overlap_index.bin";
     openAndLockFile(&overlap_index_, path_.c_str());
+
+    path_ = path + "/overlap_tombstones.bin";
+    openAndLockFile(&overlap_tombstones_, path_.c_str());
 }
 
 Depot::~Depot() {
@@ -105,12 +348,71 @@ Depot::~Depot() {
     unlockAndCloseFile(read_index_);
     unlockAndCloseFile(overlap_data_);
     unlockAndCloseFile(overlap_index_);
+    if (overlap_tombstones_ != nullptr) {
+        unlockAndCloseFile(overlap_tombstones_);
+    }
+}
+
+std::unique_lock<std::mutex> Depot::read_lock() {
+
+    // files of read-only depots do not change while they are open
+    if (read_only_) {
+        return std::unique_lock<std::mutex>(mutex_, std::defer_lock);
+    }
+    return std::unique_lock<std::mutex>(mutex_);
+}
+
+void Depot::check_writable() const {
+    ASSERT(!read_only_, "Depot", "Unable to change depot %s opened read-only!",
+        depot_path_.c_str());
 }
 
 void Depot::store_reads(const ReadSet& src)  {
 
     ASSERT(src.size() != 0, "Depot", "Can not store an empty ReadSet!");
-    store(src, read_data_, read_index_);
+    write_reads(src, true);
+}
+
+void Depot::store_reads(const ReadStore& src)  {
+
+    ASSERT(src.size() != 0, "Depot", "Can not store an empty ReadStore!");
+    write_reads(src, true);
+}
+
+void Depot::store_reads(ReadBatchReader& src) {
+
+    check_writable();
+
+    ReadStore batches[2];
+    ASSERT(src.next_batch(batches[0]), "Depot", "Can not store an empty ReadStore!");
+
+    write_reads(batches[0], true);
+
+    // batch i is written while batch i + 1 is parsed
+    bool has_next = src.next_batch(batches[1]);
+
+    for (uint32_t i = 1; has_next; ++i) {
+
+        auto writer = std::async(std::launch::async, [this, &batches, i]() {
+            append_reads(batches[i % 2]);
+        });
+
+        has_next = src.next_batch(batches[(i + 1) % 2]);
+
+        writer.get();
+    }
+}
+
+void Depot::append_reads(const ReadSet& src) {
+
+    ASSERT(src.size() != 0, "Depot", "Can not append an empty ReadSet!");
+    write_reads(src, false);
+}
+
+void Depot::append_reads(const ReadStore& src) {
+
+    ASSERT(src.size() != 0, "Depot", "Can not append an empty ReadStore!");
+    write_reads(src, false);
 }
 
 Read* Depot::load_read(uint32_t index) {
@@ -125,176 +427,1931 @@ void Depot::load_reads(ReadSet& dst) {
 }
 
 void Depot::load_reads(ReadSet& dst, uint32_t begin, uint32_t length) {
-    load(dst, begin, length, read_data_, read_index_);
+    load(dst, begin, length, read_data_, read_index_, [](const char* bytes) {
+        return static_cast<Read*>(DepotObject::deserialize(bytes)); });
 }
 
-void Depot::store_overlaps(const OverlapSet& src) {
+void Depot::load_reads(ReadStore& dst) {
+    load_reads(dst, 0, -1); // read all
+}
 
-    ASSERT(src.size() != 0, "Depot", "Can not store empty OverlapSet!");
-    store(src, overlap_data_, overlap_index_);
+void Depot::load_reads(ReadStore& dst, uint32_t begin, uint32_t length) {
+    load_bytes(begin, length, read_data_, read_index_,
+        [&dst](const char* bytes) { Read::deserialize(bytes, dst); });
 }
 
-Overlap* Depot::load_overlap(uint32_t index, const ReadSet& reads) {
+void Depot::scan_reads(uint32_t batch_size,
+    const std::function<void(const ReadStore&, uint32_t)>& callback) {
 
-    OverlapSet temp;
-    load_overlaps(temp, index, 1, reads);
-    return temp.front();
+    ASSERT(batch_size != 0, "Depot", "Invalid batch size!");
+
+    ReadStore batch;
+    uint32_t first = 0;
+
+    load_bytes(0, -1, read_data_, read_index_, [&](const char* bytes) {
+        Read::deserialize(bytes, batch);
+        if (batch.size() == batch_size) {
+            callback(batch, first);
+            first += batch.size();
+            batch.clear();
+        }
+    });
+
+    if (batch.size() != 0) {
+        callback(batch, first);
+    }
 }
 
-void Depot::load_overlaps(OverlapSet& dst, const ReadSet& reads) {
-    load_overlaps(dst, 0, -1, reads); // read all
+// creates overlaps with the given indices in place
+void materializeOverlaps(OverlapSet& dst, const OverlapSegments& overlaps,
+    const std::vector<uint32_t>& indices, const ReadSet& reads) {
+
+    size_t offset = dst.size();
+    dst.resize(offset + indices.size());
+
+    parallelRanges(indices.size(), [&](uint32_t range_begin, uint32_t range_end) {
+        for (uint32_t i = range_begin; i < range_end; ++i) {
+            dst[offset + i] = overlaps.overlap(indices[i]).materialize(reads);
+        }
+    });
 }
 
-void Depot::load_overlaps(OverlapSet& dst, uint32_t begin, uint32_t length,
-    const ReadSet& reads) {
+// same as Overlap::length
+uint32_t overlapLength(const MappedOverlap& overlap) {
 
-    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+    uint32_t a_length = overlap.a_hi() - overlap.a_lo();
+    uint32_t b_length = overlap.a() == overlap.b() ? a_length :
+        overlap.b_hi() - overlap.b_lo();
 
-    load(dst, begin, length, overlap_data_, overlap_index_);
+    return (a_length + b_length) / 2;
+}
 
-    for (auto& it: dst) {
+// smaller one of Overlap::covered_percentage of both reads
+double overlapCovered(const MappedOverlap& overlap, const ReadSet& reads) {
 
-        auto id = (uint64_t) it->read_a_;
-        ASSERT(id < reads.size(), "Depot", "Missing read %lu!", id);
-        it->read_a_ = reads[id];
+    ASSERT(overlap.a() < reads.size(), "Depot", "Missing read %u!", overlap.a());
+    ASSERT(overlap.b() < reads.size(), "Depot", "Missing read %u!", overlap.b());
 
-        id = (uint64_t) it->read_b_;
-        ASSERT(id < reads.size(), "Depot", "Missing read %lu!", id);
-        it->read_b_ = reads[id];
+    double a_covered = (overlap.a_hi() - overlap.a_lo()) /
+        (double) reads[overlap.a()]->length();
+    if (overlap.a() == overlap.b()) {
+        return a_covered;
     }
+
+    return std::min(a_covered, (overlap.b_hi() - overlap.b_lo()) /
+        (double) reads[overlap.b()]->length());
 }
 
-template<typename T>
-void Depot::store(const std::vector<T*>& src, FILE* data, FILE* index) {
+// stored fields of an overlap
+struct OverlapFields {
+    double err_rate;
+    double orig_err_rate;
+    uint32_t a;
+    uint32_t b;
+    int32_t a_hang;
+    int32_t b_hang;
+    uint32_t a_lo;
+    uint32_t a_hi;
+    uint32_t b_lo;
+    uint32_t b_hi;
+    uint32_t confirmations;
+    uint8_t flags;
+};
+
+OverlapFields overlapFields(const MappedOverlap& overlap) {
+    return { overlap.err_rate(), overlap.orig_err_rate(), overlap.a(), overlap.b(),
+        overlap.a_hang(), overlap.b_hang(), overlap.a_lo(), overlap.a_hi(),
+        overlap.b_lo(), overlap.b_hi(), overlap.confirmations(),
+        (uint8_t) ((overlap.is_innie() ? OverlapColumns::kInnie : 0) |
+            (overlap.is_dovetail() ? OverlapColumns::kDovetail : 0)) };
+}
+
+void Depot::store_overlaps(const OverlapSet& src) {
+
+    check_writable();
+
+    ASSERT(src.size() != 0, "Depot", "Can not store empty OverlapSet!");
 
     std::unique_lock<std::mutex> lock(mutex_);
 
-    fseekWrapper(index, 0, SEEK_SET);
-    fseekWrapper(data, 0, SEEK_SET);
+    // the index file is only used by the older format
+    fflush(overlap_index_);
+    fflush(overlap_data_);
+    ftruncateWraper(overlap_index_, 0);
+    ftruncateWraper(overlap_data_, 0);
+    fseekWrapper(overlap_data_, 0, SEEK_SET);
 
-    uint32_t offsets_size = src.size() + 2;
-    uint64_t* offsets = new uint64_t[offsets_size]();
-    offsets[0] = offsets_size - 2;
+    remove_overlap_segments();
 
-    size_t data_bytes = 0;
-    size_t index_bytes = offsets_size * sizeof(*offsets);
+    store_overlap_segment(overlap_data_, 0, src);
+}
 
-    uint32_t id = 1;
-    uint32_t uint32_size = sizeof(uint32_t);
+void Depot::append_overlaps(const OverlapSet& src) {
 
-    char* buffer = new char[kBufferSize];
-    uint32_t buffer_size = 0;
+    check_writable();
 
-    for (const auto& it: src) {
+    ASSERT(src.size() != 0, "Depot", "Can not append empty OverlapSet!");
 
-        char* bytes = nullptr;
-        uint32_t bytes_length = 0;
-        it->serialize(&bytes, &bytes_length);
+    std::unique_lock<std::mutex> lock(mutex_);
 
-        if (buffer_size + bytes_length > kBufferSize) {
-            fwriteWrapper(buffer, sizeof(*buffer), buffer_size, data);
-            buffer_size = 0;
-        }
+    uint32_t segment = 1;
+    while (pathExists(overlapSegmentPath(depot_path_, segment).c_str()) == 0) {
+        ++segment;
+    }
 
-        std::memcpy(buffer + buffer_size, &bytes_length, uint32_size);
-        buffer_size += uint32_size;
+    auto path = overlapSegmentPath(depot_path_, segment);
+    auto file = fopenWrapper(path.c_str(), "wb");
 
-        std::memcpy(buffer + buffer_size, bytes, bytes_length);
-        buffer_size += bytes_length;
+    store_overlap_segment(file, segment, src);
 
-        delete[] bytes;
+    fclose(file);
+}
+
+void Depot::remove_overlaps(const std::vector<uint32_t>& indices) {
+
+    check_writable();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    std::vector<uint64_t> bitmap((overlaps->rows_size() + 63) / 64, 0);
+
+    size_t length;
+    auto tombstones = mmapWrapper(overlap_tombstones_, &length);
+    std::memcpy(bitmap.data(), tombstones, std::min(length, bitmap.size() * sizeof(uint64_t)));
+    munmapWrapper(tombstones, length);
 
-        offsets[id + 1] = offsets[id] + bytes_length + uint32_size;
-        ++id;
+    for (const auto& it: indices) {
+        ASSERT(it < overlaps->size(), "Depot", "Overlap index %u out of range!", it);
+        uint64_t row = overlaps->row(it);
+        bitmap[row / 64] |= 1ULL << (row % 64);
     }
 
-    data_bytes = offsets[offsets_size - 1];
+    unmap_overlaps(overlaps, files);
 
-    if (buffer_size > 0) {
-        fwriteWrapper(buffer, sizeof(*buffer), buffer_size, data);
+    fseekWrapper(overlap_tombstones_, 0, SEEK_SET);
+    fwriteWrapper(bitmap.data(), sizeof(uint64_t), bitmap.size(), overlap_tombstones_);
+    fflush(overlap_tombstones_);
+}
+
+void Depot::update_overlaps(const OverlapSet& loaded, const OverlapSet& src) {
+
+    check_writable();
+
+    std::unordered_map<const Overlap*, uint32_t> indices;
+    for (uint32_t i = 0; i < loaded.size(); ++i) {
+        indices.emplace(loaded[i], i);
     }
 
-    fwriteWrapper(offsets, sizeof(*offsets), offsets_size, index);
+    std::vector<bool> kept(loaded.size(), false);
+    OverlapSet appended;
+
+    for (const auto& it: src) {
+        auto index = indices.find(it);
+        if (index == indices.end()) {
+            appended.push_back(it);
+        } else {
+            kept[index->second] = true;
+        }
+    }
 
-    delete[] buffer;
-    delete[] offsets;
+    std::vector<uint32_t> removed;
+    for (uint32_t i = 0; i < kept.size(); ++i) {
+        if (!kept[i]) {
+            removed.push_back(i);
+        }
+    }
 
-    ftruncateWraper(index, index_bytes);
-    ftruncateWraper(data, data_bytes);
+    if (!removed.empty()) {
+        remove_overlaps(removed);
+    }
+    if (!appended.empty()) {
+        append_overlaps(appended);
+    }
 }
 
-template<typename T>
-void Depot::load(std::vector<T*>& dst, uint32_t begin, uint32_t length,
-    FILE* data, FILE* index) {
+void Depot::compact_overlaps() {
+
+    check_writable();
 
     std::unique_lock<std::mutex> lock(mutex_);
 
-    ASSERT(!fileEmpty(index), "Depot",
-        "Unable to load from empty index file!");
-    ASSERT(!fileEmpty(data), "Depot",
-        "Unable to load from empty data file!");
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
 
-    uint64_t objects_length;
-    fseekWrapper(index, 0, SEEK_SET);
-    freadWrapper(&objects_length, sizeof(objects_length), 1, index);
+    if (overlaps->columns() != nullptr) {
+        unmap_overlaps(overlaps, files);
+        return;
+    }
 
-    ASSERT(begin < (uint32_t) objects_length, "Depot",
-        "Beginning index out of range!");
+    // overlaps are written to a new file which replaces the data file, so
+    // the data file is readable until then
+    auto path = depot_path_ + "/overlap_data.bin";
+    auto compacted_path = depot_path_ + "/overlap_data.tmp";
+
+    FILE* compacted;
+    openAndLockFile(&compacted, compacted_path.c_str());
+    ftruncateWraper(compacted, 0);
+
+    // rows are visited in order for each column
+    uint64_t row = 0;
+    auto fields = [&overlaps, &row](uint64_t i) {
+        if (i == 0) {
+            row = overlaps->row(0);
+        } else {
+            while (overlaps->removed(++row));
+        }
+        return overlapFields(overlaps->overlap_at(row));
+    };
+
+    store_overlap_columns(compacted, overlaps->size(), fields);
+    store_overlap_adjacency(0, overlaps->size(), fields);
+
+    // covered percentages need read lengths so bounds of the old zones are kept
+    uint64_t zone_row = 0;
+    store_overlap_zones(0, overlaps->size(), [&overlaps, &zone_row](uint64_t i) {
+        if (i == 0) {
+            zone_row = overlaps->row(0);
+        } else {
+            while (overlaps->removed(++zone_row));
+        }
 
-    length = std::min(length, (uint32_t) objects_length - begin);
+        OverlapZone zone;
+        if (!overlaps->zone(zone_row, zone)) {
+            zone.min_covered = 0;
+            zone.max_covered = std::numeric_limits<double>::infinity();
+        }
 
-    uint64_t* offsets = new uint64_t[length + 1];
-    fseekWrapper(index, begin * sizeof(uint64_t), SEEK_CUR);
-    freadWrapper(offsets, sizeof(*offsets), length + 1, index);
+        auto overlap = overlaps->overlap_at(zone_row);
+        zone.min_err_rate = zone.max_err_rate = overlap.err_rate();
+        zone.min_length = zone.max_length = overlapLength(overlap);
+        return zone;
+    });
 
-    fseekWrapper(data, offsets[0], SEEK_SET);
+    unmap_overlaps(overlaps, files);
 
-    uint32_t uint32_size = sizeof(uint32_t);
+    ASSERT(rename(compacted_path.c_str(), path.c_str()) == 0, "Depot",
+        "Unable to replace file %s (rename)!", path.c_str());
 
-    char* buffer = new char[kBufferSize];
-    uint32_t buffer_size = 0;
+    unlockAndCloseFile(overlap_data_);
+    overlap_data_ = compacted;
 
-    for (uint32_t i = 0; i < length; ++i) {
+    fflush(overlap_index_);
+    ftruncateWraper(overlap_index_, 0);
 
-        auto bytes_length = offsets[i + 1] - offsets[i];
+    remove_overlap_segments();
+}
 
-        if (buffer_size + bytes_length > kBufferSize) {
+void Depot::store_overlap_segment(FILE* dst, uint32_t segment, const OverlapSet& src) {
+
+    auto fields = [&src](uint64_t i) {
+        const auto& it = src[i];
+        return OverlapFields { it->err_rate_, it->orig_err_rate_, it->a(), it->b(),
+            it->a_hang_, it->b_hang_, it->a_lo_, it->a_hi_, it->b_lo_, it->b_hi_,
+            it->confirmations_,
+            (uint8_t) ((it->is_innie_ ? OverlapColumns::kInnie : 0) |
+                (it->is_dovetail_ ? OverlapColumns::kDovetail : 0)) };
+    };
+
+    store_overlap_columns(dst, src.size(), fields);
+    store_overlap_adjacency(segment, src.size(), fields);
+
+    store_overlap_zones(segment, src.size(), [&src](uint64_t i) {
+        const auto& it = src[i];
+        double covered = std::min(it->covered_percentage(it->a()),
+            it->covered_percentage(it->b()));
+        return OverlapZone { it->err_rate(), it->err_rate(), covered, covered,
+            it->length(), it->length() };
+    });
+}
 
-            freadWrapper(buffer, sizeof(*buffer), buffer_size, data);
+template<typename F>
+void Depot::store_overlap_zones(uint32_t segment, uint64_t size, F zone) {
 
-            uint32_t ptr = 0;
-            while (ptr < buffer_size) {
+    std::vector<OverlapZone> zones;
+    for (uint64_t i = 0; i < size; ++i) {
+        auto it = zone(i);
+        if (i % OverlapZones::kZoneSize == 0) {
+            zones.push_back(it);
+            continue;
+        }
 
-                uint32_t bytes_length_;
-                std::memcpy(&bytes_length_, buffer + ptr, uint32_size);
-                ptr += uint32_size;
+        auto& dst = zones.back();
+        dst.min_err_rate = std::min(dst.min_err_rate, it.min_err_rate);
+        dst.max_err_rate = std::max(dst.max_err_rate, it.max_err_rate);
+        dst.min_covered = std::min(dst.min_covered, it.min_covered);
+        dst.max_covered = std::max(dst.max_covered, it.max_covered);
+        dst.min_length = std::min(dst.min_length, it.min_length);
+        dst.max_length = std::max(dst.max_length, it.max_length);
+    }
 
-                dst.emplace_back(static_cast<T*>(DepotObject::deserialize(buffer + ptr)));
-                ptr += bytes_length_;
-            }
+    auto path = overlapZonesPath(depot_path_, segment);
+    auto file = fopenWrapper(path.c_str(), "wb");
 
-            buffer_size = 0;
+    uint32_t header[2] = { OverlapZones::kMagic, OverlapZones::kVersion };
+    uint64_t sizes[3] = { size, OverlapZones::kZoneSize, zones.size() };
+    fwriteWrapper(header, sizeof(*header), 2, file);
+    fwriteWrapper(sizes, sizeof(*sizes), 3, file);
+    fwriteWrapper(zones.data(), sizeof(OverlapZone), zones.size(), file);
+
+    fclose(file);
+}
+
+template<typename F>
+void Depot::store_overlap_adjacency(uint32_t segment, uint64_t size, F overlap) {
+
+    // rows are counted by read and placed with a counting sort
+    uint64_t reads_size = 0;
+    for (uint64_t i = 0; i < size; ++i) {
+        auto it = overlap(i);
+        reads_size = std::max<uint64_t>(reads_size, std::max(it.a, it.b) + 1);
+    }
+
+    std::vector<uint64_t> offsets(reads_size + 1, 0);
+    for (uint64_t i = 0; i < size; ++i) {
+        auto it = overlap(i);
+        ++offsets[it.a + 1];
+        if (it.b != it.a) {
+            ++offsets[it.b + 1];
+        }
+    }
+
+    for (uint64_t i = 0; i < reads_size; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::vector<uint32_t> rows(offsets.back());
+    std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+
+    for (uint64_t i = 0; i < size; ++i) {
+        auto it = overlap(i);
+        rows[next[it.a]++] = i;
+        if (it.b != it.a) {
+            rows[next[it.b]++] = i;
+        }
+    }
+
+    auto path = overlapAdjacencyPath(depot_path_, segment);
+    auto file = fopenWrapper(path.c_str(), "wb");
+
+    uint32_t header[2] = { OverlapAdjacency::kMagic, OverlapAdjacency::kVersion };
+    uint64_t sizes[3] = { reads_size, size, rows.size() };
+    fwriteWrapper(header, sizeof(*header), 2, file);
+    fwriteWrapper(sizes, sizeof(*sizes), 3, file);
+    fwriteWrapper(offsets.data(), sizeof(uint64_t), offsets.size(), file);
+    fwriteWrapper(rows.data(), sizeof(uint32_t), rows.size(), file);
+
+    fclose(file);
+}
+
+template<typename F>
+void Depot::store_overlap_columns(FILE* dst, uint64_t size, F overlap) {
+
+    uint32_t header[2] = { OverlapColumns::kMagic, OverlapColumns::kVersion };
+    fwriteWrapper(header, sizeof(*header), 2, dst);
+    fwriteWrapper(&size, sizeof(size), 1, dst);
+
+    // same order as in OverlapColumns
+    store_column<double>(dst, size, [&](uint64_t i) { return overlap(i).err_rate; });
+    store_column<double>(dst, size, [&](uint64_t i) { return overlap(i).orig_err_rate; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).a; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).b; });
+    store_column<int32_t>(dst, size, [&](uint64_t i) { return overlap(i).a_hang; });
+    store_column<int32_t>(dst, size, [&](uint64_t i) { return overlap(i).b_hang; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).a_lo; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).a_hi; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).b_lo; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).b_hi; });
+    store_column<uint32_t>(dst, size, [&](uint64_t i) { return overlap(i).confirmations; });
+    store_column<uint8_t>(dst, size, [&](uint64_t i) { return overlap(i).flags; });
+
+    fflush(dst);
+}
+
+template<typename T, typename F>
+void Depot::store_column(FILE* dst, uint64_t size, F value) {
+
+    std::vector<T> buffer;
+    buffer.reserve(std::min<uint64_t>(size, kColumnBufferSize));
+
+    for (uint64_t i = 0; i < size; ++i) {
+
+        buffer.push_back(value(i));
+
+        if (buffer.size() == kColumnBufferSize) {
+            fwriteWrapper(buffer.data(), sizeof(T), buffer.size(), dst);
+            buffer.clear();
+        }
+    }
+
+    if (!buffer.empty()) {
+        fwriteWrapper(buffer.data(), sizeof(T), buffer.size(), dst);
+    }
+}
+
+OverlapSegments* Depot::map_overlaps(std::vector<FILE*>& files) {
+
+    std::vector<FILE*> segments;
+    std::vector<FILE*> adjacencies(1, fopenIfExists(
+        overlapAdjacencyPath(depot_path_, 0).c_str()));
+    std::vector<FILE*> zones(1, fopenIfExists(overlapZonesPath(depot_path_, 0).c_str()));
+
+    for (uint32_t i = 1; ; ++i) {
+        auto path = overlapSegmentPath(depot_path_, i);
+        if (pathExists(path.c_str()) != 0) {
+            break;
         }
+        segments.push_back(fopenWrapper(path.c_str(), "rb"));
+        adjacencies.push_back(fopenIfExists(overlapAdjacencyPath(depot_path_, i).c_str()));
+        zones.push_back(fopenIfExists(overlapZonesPath(depot_path_, i).c_str()));
+    }
 
-        buffer_size += bytes_length;
+    if (!read_only_) {
+        fflush(overlap_data_);
+        fflush(overlap_index_);
+        fflush(overlap_tombstones_);
+    }
+
+    files = segments;
+    for (const auto& it: adjacencies) {
+        if (it != nullptr) {
+            files.push_back(it);
+        }
+    }
+    for (const auto& it: zones) {
+        if (it != nullptr) {
+            files.push_back(it);
+        }
     }
 
-    if (buffer_size > 0) {
+    return new OverlapSegments(overlap_data_, overlap_index_, segments,
+        overlap_tombstones_, adjacencies, zones);
+}
+
+void Depot::unmap_overlaps(OverlapSegments* overlaps, std::vector<FILE*>& files) {
+
+    delete overlaps;
 
-        freadWrapper(buffer, sizeof(*buffer), buffer_size, data);
+    for (const auto& it: files) {
+        fclose(it);
+    }
+    files.clear();
+}
 
-        uint32_t ptr = 0;
-        while (ptr < buffer_size) {
+void Depot::remove_overlap_segments() {
+
+    for (uint32_t i = 1; ; ++i) {
+        auto path = overlapSegmentPath(depot_path_, i);
+        if (pathExists(path.c_str()) != 0) {
+            break;
+        }
+        ASSERT(remove(path.c_str()) == 0, "Depot", "Unable to remove file %s!",
+            path.c_str());
 
-            uint32_t bytes_length;
-            std::memcpy(&bytes_length, buffer + ptr, uint32_size);
-            ptr += uint32_size;
+        path = overlapAdjacencyPath(depot_path_, i);
+        if (pathExists(path.c_str()) == 0) {
+            remove(path.c_str());
+        }
 
-            dst.emplace_back(static_cast<T*>(DepotObject::deserialize(buffer + ptr)));
-            ptr += bytes_length;
+        path = overlapZonesPath(depot_path_, i);
+        if (pathExists(path.c_str()) == 0) {
+            remove(path.c_str());
         }
     }
 
-    delete[] buffer;
-    delete[] offsets;
+    fflush(overlap_tombstones_);
+    ftruncateWraper(overlap_tombstones_, 0);
+}
+
+Overlap* Depot::load_overlap(uint32_t index, const ReadSet& reads) {
+
+    OverlapSet temp;
+    load_overlaps(temp, index, 1, reads);
+
+    ASSERT(temp.size() == 1, "Depot", "Overlap index %u out of range!", index);
+
+    return temp.front();
+}
+
+void Depot::load_overlaps(OverlapSet& dst, const ReadSet& reads) {
+    load_overlaps(dst, 0, -1, reads); // read all
+}
+
+void Depot::load_overlaps(OverlapSet& dst, uint32_t begin, uint32_t length,
+    const ReadSet& reads) {
+
+    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(overlap_data_), "Depot",
+        "Unable to load from empty data file!");
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    // an empty range (all overlaps removed) loads nothing
+    ASSERT(begin <= overlaps->size(), "Depot",
+        "Beginning index out of range!");
+
+    length = std::min(length, overlaps->size() - begin);
+
+    // overlaps are created in place so their order is kept
+    size_t offset = dst.size();
+    dst.resize(offset + length);
+
+    {
+        std::vector<std::pair<const char*, const char*>> ranges;
+        overlaps->mapped_ranges(begin, begin + length, ranges);
+        Prefetcher prefetcher(ranges, 0);
+
+        parallelRanges(length, [&](uint32_t range_begin, uint32_t range_end) {
+            for (uint32_t i = range_begin; i < range_end; ++i) {
+                dst[offset + i] = overlaps->overlap(begin + i).materialize(reads);
+            }
+        });
+    }
+
+    unmap_overlaps(overlaps, files);
+}
+
+void Depot::load_overlaps_for_reads(OverlapSet& dst, const std::vector<uint32_t>& ids,
+    const ReadSet& reads) {
+
+    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+
+    auto lock = read_lock();
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    std::vector<uint32_t> indices;
+    for (const auto& it: ids) {
+        overlaps->read_overlaps(it, indices);
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    materializeOverlaps(dst, *overlaps, indices, reads);
+
+    unmap_overlaps(overlaps, files);
+}
+
+void Depot::select_overlaps(std::vector<uint32_t>& dst, const ReadSet& reads,
+    const OverlapPredicate& predicate) {
+
+    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(overlap_data_), "Depot",
+        "Unable to load from empty data file!");
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    overlaps->select(predicate, reads, dst);
+
+    unmap_overlaps(overlaps, files);
+}
+
+void Depot::load_overlaps(OverlapSet& dst, const ReadSet& reads,
+    const OverlapPredicate& predicate) {
+
+    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(overlap_data_), "Depot",
+        "Unable to load from empty data file!");
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    std::vector<uint32_t> indices;
+    overlaps->select(predicate, reads, indices);
+
+    materializeOverlaps(dst, *overlaps, indices, reads);
+
+    unmap_overlaps(overlaps, files);
+}
+
+void Depot::load_overlap_err_rates(std::vector<double>& dst) {
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(overlap_data_), "Depot",
+        "Unable to load from empty data file!");
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    // only the error rate column is read
+    dst.reserve(dst.size() + overlaps->size());
+    for (uint64_t row = 0; row < overlaps->rows_size(); ++row) {
+        if (!overlaps->removed(row)) {
+            dst.push_back(overlaps->overlap_at(row).err_rate());
+        }
+    }
+
+    unmap_overlaps(overlaps, files);
+}
+
+void Depot::scan_overlaps(uint32_t batch_size, const ReadSet& reads,
+    const std::function<void(const OverlapSet&, uint32_t)>& callback) {
+
+    ASSERT(reads.size() != 0, "Depot", "Empty read set!");
+    ASSERT(batch_size != 0, "Depot", "Invalid batch size!");
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(overlap_data_), "Depot",
+        "Unable to load from empty data file!");
+
+    std::vector<FILE*> files;
+    auto overlaps = map_overlaps(files);
+
+    std::vector<std::pair<const char*, const char*>> ranges;
+    overlaps->mapped_ranges(0, overlaps->size(), ranges);
+    // objects of the first batch are reused for all following ones
+    OverlapSet batch;
+    batch.reserve(std::min(batch_size, overlaps->size()));
+
+    {
+        Prefetcher prefetcher(ranges, kPrefetchAhead);
+
+        for (uint32_t begin = 0; begin < overlaps->size(); begin += batch.size()) {
+
+            uint32_t length = std::min(batch_size, overlaps->size() - begin);
+            while (batch.size() < length) {
+                batch.push_back(new Overlap());
+            }
+            // only the last batch can be shorter
+            while (batch.size() > length) {
+                delete batch.back();
+                batch.pop_back();
+            }
+
+            parallelRanges(length, [&](uint32_t range_begin, uint32_t range_end) {
+                for (uint32_t i = range_begin; i < range_end; ++i) {
+                    overlaps->overlap(begin + i).materialize(batch[i], reads);
+                }
+            });
+
+            prefetcher.advance(begin + length, overlaps->size());
+            callback(batch, begin);
+        }
+    }
+
+    for (const auto& it: batch) {
+        delete it;
+    }
+    // slabs of the batch are not reused by the caller
+    releasePool();
+
+    unmap_overlaps(overlaps, files);
+}
+
+template<typename T>
+void Depot::write_reads(const T& src, bool truncate) {
+
+    check_writable();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (truncate) {
+        fflush(read_index_);
+        fflush(read_data_);
+        ftruncateWraper(read_index_, 0);
+        ftruncateWraper(read_data_, 0);
+    }
+
+    if (fileEmpty(read_index_)) {
+        append_read_blocks(src);
+        return;
+    }
+
+    uint64_t header;
+    fseekWrapper(read_index_, 0, SEEK_SET);
+    freadWrapper(&header, sizeof(header), 1, read_index_);
+
+    // reads appended to depots with uncompressed reads stay uncompressed
+    if (header == DepotMapping::kReadBlocksMagic) {
+        append_read_blocks(src);
+    } else {
+        append_objects(src, read_data_, read_index_);
+    }
+}
+
+template<typename T>
+void Depot::append_read_blocks(const T& src) {
+
+    // index holds the read and block counts followed by (first read, offset)
+    // pairs of all blocks and of the end of data
+    uint64_t header[3] = { DepotMapping::kReadBlocksMagic, 0, 0 };
+    std::vector<uint64_t> blocks;
+    uint64_t offset = 0;
+
+    if (!fileEmpty(read_index_)) {
+        fseekWrapper(read_index_, 0, SEEK_SET);
+        freadWrapper(header, sizeof(*header), 3, read_index_);
+
+        blocks.resize(2 * header[2] + 2);
+        freadWrapper(blocks.data(), sizeof(uint64_t), blocks.size(), read_index_);
+
+        offset = blocks.back();
+        blocks.resize(2 * header[2]);
+    }
+
+    fseekWrapper(read_data_, offset, SEEK_SET);
+
+    // up to one block per thread is encoded in parallel and written on a
+    // background thread while the reads of the next round are serialized
+    uint32_t threads = threadsSize();
+    std::vector<std::vector<const char*>> rounds[2];
+    rounds[0].resize(1);
+    rounds[1].resize(1);
+    uint32_t current = 0;
+    uint64_t records_bytes = 0;
+    std::future<void> writing;
+
+    auto write_blocks = [&](std::vector<std::vector<const char*>>& records) {
+
+        std::vector<std::vector<char>> encoded(records.size());
+        std::vector<std::future<void>> futures;
+
+        for (uint32_t i = 0; i < records.size(); ++i) {
+            futures.emplace_back(std::async(std::launch::async,
+                [&records, &encoded, i]() { encodeReadBlock(encoded[i], records[i]); }));
+        }
+
+        for (uint32_t i = 0; i < records.size(); ++i) {
+            futures[i].get();
+
+            if (records[i].empty()) {
+                continue;
+            }
+
+            fwriteWrapper(encoded[i].data(), sizeof(char), encoded[i].size(), read_data_);
+
+            blocks.push_back(header[1]);
+            blocks.push_back(offset);
+
+            header[1] += records[i].size();
+            header[2] += 1;
+            offset += encoded[i].size();
+
+            for (const auto& it: records[i]) {
+                delete[] it;
+            }
+        }
+
+        records.assign(1, std::vector<const char*>());
+    };
+
+    auto flush_round = [&]() {
+        if (writing.valid()) {
+            writing.get();
+        }
+        auto& round = rounds[current];
+        writing = std::async(std::launch::async, [&write_blocks, &round]() {
+            write_blocks(round); });
+        current ^= 1;
+    };
+
+    for (const auto& it: src) {
+
+        char* bytes = nullptr;
+        uint32_t bytes_length = 0;
+        it->serialize(&bytes, &bytes_length);
+
+        rounds[current].back().push_back(bytes);
+        records_bytes += bytes_length;
+
+        if (records_bytes >= kReadBlockSize) {
+            records_bytes = 0;
+
+            if (rounds[current].size() == threads) {
+                flush_round();
+            } else {
+                rounds[current].emplace_back();
+            }
+        }
+    }
+
+    flush_round();
+    writing.get();
+
+    blocks.push_back(header[1]);
+    blocks.push_back(offset);
+
+    fseekWrapper(read_index_, 0, SEEK_SET);
+    fwriteWrapper(header, sizeof(*header), 3, read_index_);
+    fwriteWrapper(blocks.data(), sizeof(uint64_t), blocks.size(), read_index_);
+
+    fflush(read_index_);
+    fflush(read_data_);
+    ftruncateWraper(read_index_, (blocks.size() + 3) * sizeof(uint64_t));
+    ftruncateWraper(read_data_, offset);
+}
+
+template<typename T>
+void Depot::append_objects(const T& src, FILE* data, FILE* index) {
+
+    // index holds the number of objects followed by their offsets
+    uint64_t objects_length = 0;
+    uint64_t data_bytes = 0;
+
+    if (fileEmpty(index)) {
+        uint64_t header[2] = { 0, 0 };
+        fseekWrapper(index, 0, SEEK_SET);
+        fwriteWrapper(header, sizeof(*header), 2, index);
+    } else {
+        fseekWrapper(index, 0, SEEK_SET);
+        freadWrapper(&objects_length, sizeof(objects_length), 1, index);
+        fseekWrapper(index, objects_length * sizeof(uint64_t), SEEK_CUR);
+        freadWrapper(&data_bytes, sizeof(data_bytes), 1, index);
+    }
+
+    fseekWrapper(data, data_bytes, SEEK_SET);
+
+    std::vector<uint64_t> offsets;
+    offsets.reserve(src.size());
+
+    uint64_t offset = data_bytes;
+    uint32_t uint32_size = sizeof(uint32_t);
+
+    // one buffer is written on a background thread while the other is filled
+    std::vector<char> buffers[2];
+    uint32_t current = 0;
+    std::future<void> writing;
+
+    auto flush_buffer = [&]() {
+        if (writing.valid()) {
+            writing.get();
+        }
+        auto& buffer = buffers[current];
+        writing = std::async(std::launch::async, [&buffer, data]() {
+            fwriteWrapper(buffer.data(), sizeof(char), buffer.size(), data);
+            buffer.clear(); });
+        current ^= 1;
+    };
+
+    for (const auto& it: src) {
+
+        char* bytes = nullptr;
+        uint32_t bytes_length = 0;
+        it->serialize(&bytes, &bytes_length);
+
+        if (buffers[current].size() + bytes_length + uint32_size > kBufferSize) {
+            flush_buffer();
+        }
+
+        auto& buffer = buffers[current];
+        buffer.insert(buffer.end(), (char*) &bytes_length,
+            (char*) &bytes_length + uint32_size);
+        buffer.insert(buffer.end(), bytes, bytes + bytes_length);
+
+        delete[] bytes;
+
+        offset += bytes_length + uint32_size;
+        offsets.push_back(offset);
+    }
+
+    flush_buffer();
+    writing.get();
+
+    fseekWrapper(index, (objects_length + 2) * sizeof(uint64_t), SEEK_SET);
+    fwriteWrapper(offsets.data(), sizeof(uint64_t), offsets.size(), index);
+
+    objects_length += offsets.size();
+
+    fseekWrapper(index, 0, SEEK_SET);
+    fwriteWrapper(&objects_length, sizeof(objects_length), 1, index);
+
+    fflush(index);
+    fflush(data);
+    ftruncateWraper(index, (objects_length + 2) * sizeof(uint64_t));
+    ftruncateWraper(data, offset);
+}
+
+template<typename T, typename F>
+void Depot::load(std::vector<T*>& dst, uint32_t begin, uint32_t length,
+    FILE* data, FILE* index, F create) {
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(index), "Depot",
+        "Unable to load from empty index file!");
+    ASSERT(!fileEmpty(data), "Depot",
+        "Unable to load from empty data file!");
+
+    DepotMapping mapping(data, index);
+
+    ASSERT(begin < mapping.size(), "Depot",
+        "Beginning index out of range!");
+
+    length = std::min(length, mapping.size() - begin);
+
+    // objects are created in place on several threads so their order is kept
+    size_t offset = dst.size();
+    dst.resize(offset + length);
+
+    // blocks are decoded in order, other objects all at once
+    Prefetcher prefetcher({ mappedRange(mapping, begin, begin + length) },
+        mapping.blocked() ? kPrefetchAhead : 0);
+
+    if (!mapping.blocked()) {
+        parallelRanges(length, [&](uint32_t range_begin, uint32_t range_end) {
+            for (uint32_t i = range_begin; i < range_end; ++i) {
+                dst[offset + i] = create(mapping.object(begin + i));
+            }
+        });
+        return;
+    }
+
+    forEachBlockRound(mapping, begin, begin + length,
+        [&](const std::vector<const char*>& records, uint32_t first) {
+            prefetcher.advance(first + records.size(), length);
+            parallelRanges(records.size(), [&](uint32_t range_begin, uint32_t range_end) {
+                for (uint32_t i = range_begin; i < range_end; ++i) {
+                    dst[offset + first + i] = create(records[i]);
+                }
+            });
+        });
+}
+
+void Depot::load_bytes(uint32_t begin, uint32_t length, FILE* data, FILE* index,
+    const std::function<void(const char*)>& callback) {
+
+    auto lock = read_lock();
+
+    ASSERT(!fileEmpty(index), "Depot",
+        "Unable to load from empty index file!");
+    ASSERT(!fileEmpty(data), "Depot",
+        "Unable to load from empty data file!");
+
+    // objects are deserialized straight from the page cache
+    DepotMapping mapping(data, index);
+
+    ASSERT(begin < mapping.size(), "Depot",
+        "Beginning index out of range!");
+
+    length = std::min(length, mapping.size() - begin);
+
+    Prefetcher prefetcher({ mappedRange(mapping, begin, begin + length) },
+        kPrefetchAhead);
+
+    if (!mapping.blocked()) {
+        for (uint32_t i = begin; i < begin + length; ++i) {
+            if ((i - begin) % kPrefetchObjects == 0) {
+                prefetcher.advance(i - begin, length);
+            }
+            callback(mapping.object(i));
+        }
+        return;
+    }
+
+    forEachBlockRound(mapping, begin, begin + length,
+        [&](const std::vector<const char*>& records, uint32_t first) {
+            prefetcher.advance(first + records.size(), length);
+            for (const auto& it: records) {
+                callback(it);
+            }
+        });
+}
+
+DepotMapping::DepotMapping(FILE* data, FILE* index)
+        : data_(nullptr), data_length_(0), index_(nullptr), index_length_(0),
+        offsets_(nullptr), size_(0), blocks_(nullptr), blocks_size_(0) {
+
+    data_ = mmapWrapper(data, &data_length_);
+    index_ = index != nullptr ? mmapWrapper(index, &index_length_) : nullptr;
+
+    if (index_ != nullptr) {
+        uint64_t size;
+        std::memcpy(&size, index_, sizeof(size));
+
+        if (size == kReadBlocksMagic) {
+            uint64_t header[3];
+            ASSERT(index_length_ >= sizeof(header), "Depot", "Invalid index file!");
+            std::memcpy(header, index_, sizeof(header));
+
+            ASSERT(index_length_ >= (2 * header[2] + 5) * sizeof(uint64_t), "Depot",
+                "Invalid index file!");
+            ASSERT(((const uint64_t*) index_)[2 * header[2] + 4] <= data_length_,
+                "Depot", "Truncated data file!");
+
+            size_ = header[1];
+            blocks_size_ = header[2];
+            blocks_ = (const uint64_t*) index_ + 3;
+            return;
+        }
+
+        ASSERT(index_length_ >= (size + 2) * sizeof(uint64_t), "Depot",
+            "Invalid index file!");
+
+        size_ = size;
+        offsets_ = (const uint64_t*) index_ + 1;
+    }
+}
+
+uint32_t DepotMapping::block_of(uint32_t index) const {
+
+    // first block whose first object is larger than index
+    uint32_t lo = 0, hi = blocks_size_;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (blocks_[2 * mid] <= index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo - 1;
+}
+
+void DepotMapping::decode_block(ReadBlock& dst, uint32_t block) const {
+    decodeReadBlock(dst, data_ + blocks_[2 * block + 1],
+        blocks_[2 * block + 3] - blocks_[2 * block + 1]);
+}
+
+DepotMapping::~DepotMapping() {
+    munmapWrapper(data_, data_length_);
+    munmapWrapper(index_, index_length_);
+}
+
+bool OverlapColumns::map(const char* data, size_t length) {
+
+    uint32_t header[2];
+    if (data == nullptr || length < kHeaderSize) {
+        return false;
+    }
+
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != kMagic) {
+        return false;
+    }
+
+    ASSERT(header[1] == kVersion, "Depot",
+        "Unsupported overlap data version %u!", header[1]);
+
+    std::memcpy(&size, data + sizeof(header), sizeof(size));
+
+    // columns are aligned as the header is
+    const char* ptr = data + kHeaderSize;
+    auto column = [&ptr, this](size_t width) {
+        const char* column = ptr;
+        ptr += size * width;
+        return column;
+    };
+
+    err_rate = (const double*) column(sizeof(double));
+    orig_err_rate = (const double*) column(sizeof(double));
+    a = (const uint32_t*) column(sizeof(uint32_t));
+    b = (const uint32_t*) column(sizeof(uint32_t));
+    a_hang = (const int32_t*) column(sizeof(int32_t));
+    b_hang = (const int32_t*) column(sizeof(int32_t));
+    a_lo = (const uint32_t*) column(sizeof(uint32_t));
+    a_hi = (const uint32_t*) column(sizeof(uint32_t));
+    b_lo = (const uint32_t*) column(sizeof(uint32_t));
+    b_hi = (const uint32_t*) column(sizeof(uint32_t));
+    confirmations = (const uint32_t*) column(sizeof(uint32_t));
+    flags = (const uint8_t*) column(sizeof(uint8_t));
+
+    ASSERT(ptr <= data + length, "Depot", "Truncated overlap data file!");
+
+    return true;
+}
+
+OverlapSegments::OverlapSegments(FILE* data, FILE* index,
+    const std::vector<FILE*>& segments, FILE* tombstones,
+    const std::vector<FILE*>& adjacencies, const std::vector<FILE*>& zones)
+        : mappings_(), columns_(), columnar_(), adjacency_mappings_(), adjacencies_(),
+        indexed_(), zone_mappings_(), zones_(), zoned_(), begins_(1, 0),
+        tombstones_(nullptr), tombstones_length_(0), ranks_(), size_(0) {
+
+    ASSERT(adjacencies.size() == segments.size() + 1, "Depot",
+        "Missing overlap adjacency file!");
+    ASSERT(zones.size() == segments.size() + 1, "Depot",
+        "Missing overlap zone map file!");
+
+    mappings_.push_back(new DepotMapping(data, index));
+    for (const auto& it: segments) {
+        mappings_.push_back(new DepotMapping(it, nullptr));
+    }
+
+    for (uint32_t i = 0; i < mappings_.size(); ++i) {
+        const auto& it = mappings_[i];
+
+        OverlapColumns columns;
+        bool columnar = it->size() == 0 && columns.map(it->data(), it->data_length());
+        ASSERT(columnar || i == 0, "Depot", "Invalid overlap segment!");
+
+        columns_.push_back(columnar ? columns : OverlapColumns());
+        columnar_.push_back(columnar);
+        begins_.push_back(begins_.back() + (columnar ? columns.size : it->size()));
+
+        // segments without a valid index are scanned
+        OverlapAdjacency adjacency;
+        auto adjacency_mapping = adjacencies[i] != nullptr ?
+            new DepotMapping(adjacencies[i], nullptr) : nullptr;
+        bool indexed = columnar && adjacency_mapping != nullptr &&
+            adjacency.map(adjacency_mapping->data(), adjacency_mapping->data_length(),
+                columns.size);
+
+        adjacency_mappings_.push_back(adjacency_mapping);
+        adjacencies_.push_back(indexed ? adjacency : OverlapAdjacency());
+        indexed_.push_back(indexed);
+
+        // overlaps of segments without a valid zone map are all checked
+        OverlapZones zone_map;
+        auto zone_mapping = zones[i] != nullptr ? new DepotMapping(zones[i], nullptr) :
+            nullptr;
+        bool zoned = columnar && zone_mapping != nullptr &&
+            zone_map.map(zone_mapping->data(), zone_mapping->data_length(), columns.size);
+
+        zone_mappings_.push_back(zone_mapping);
+        zones_.push_back(zoned ? zone_map : OverlapZones());
+        zoned_.push_back(zoned);
+    }
+
+    if (tombstones != nullptr) {
+        tombstones_ = mmapWrapper(tombstones, &tombstones_length_);
+    }
+
+    if (tombstones_ == nullptr) {
+        ASSERT(rows_size() < (1ULL << 32), "Depot", "Too many overlaps!");
+        size_ = rows_size();
+        return;
+    }
+
+    uint64_t words = (rows_size() + 63) / 64;
+    ranks_.reserve(words + 1);
+    ranks_.push_back(0);
+
+    for (uint64_t i = 0; i < words; ++i) {
+        uint64_t word = 0;
+        if ((i + 1) * sizeof(uint64_t) <= tombstones_length_) {
+            std::memcpy(&word, tombstones_ + i * sizeof(uint64_t), sizeof(word));
+        }
+
+        uint32_t bits = std::min<uint64_t>(64, rows_size() - i * 64);
+        uint64_t mask = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+
+        ranks_.push_back(ranks_.back() + __builtin_popcountll(~word & mask));
+    }
+
+    ASSERT(ranks_.back() < (1ULL << 32), "Depot", "Too many overlaps!");
+    size_ = ranks_.back();
+}
+
+OverlapSegments::~OverlapSegments() {
+
+    munmapWrapper(tombstones_, tombstones_length_);
+
+    for (const auto& it: adjacency_mappings_) {
+        delete it;
+    }
+    for (const auto& it: zone_mappings_) {
+        delete it;
+    }
+    for (const auto& it: mappings_) {
+        delete it;
+    }
+}
+
+uint32_t OverlapSegments::index(uint64_t row) const {
+
+    if (size_ == rows_size()) {
+        return row;
+    }
+
+    uint64_t word = 0;
+    if ((row / 64 + 1) * sizeof(uint64_t) <= tombstones_length_) {
+        std::memcpy(&word, tombstones_ + (row / 64) * sizeof(uint64_t), sizeof(word));
+    }
+
+    return ranks_[row / 64] + __builtin_popcountll(~word & ((1ULL << (row % 64)) - 1));
+}
+
+void OverlapSegments::read_overlaps(uint32_t id, std::vector<uint32_t>& dst) const {
+
+    for (uint32_t i = 0; i < mappings_.size(); ++i) {
+
+        if (indexed_[i]) {
+            const auto& adjacency = adjacencies_[i];
+            if (id >= adjacency.reads_size) {
+                continue;
+            }
+
+            for (uint64_t j = adjacency.offsets[id]; j < adjacency.offsets[id + 1]; ++j) {
+                uint64_t row = begins_[i] + adjacency.rows[j];
+                if (!removed(row)) {
+                    dst.push_back(index(row));
+                }
+            }
+            continue;
+        }
+
+        for (uint64_t row = begins_[i]; row < begins_[i + 1]; ++row) {
+            if (removed(row)) {
+                continue;
+            }
+            auto overlap = overlap_at(row);
+            if (overlap.a() == id || overlap.b() == id) {
+                dst.push_back(index(row));
+            }
+        }
+    }
+}
+
+template<typename T>
+void addColumnRange(std::vector<std::pair<const char*, const char*>>& dst,
+    const T* column, uint64_t begin, uint64_t end) {
+    dst.emplace_back((const char*) (column + begin), (const char*) (column + end));
+}
+
+void OverlapSegments::mapped_ranges(uint32_t begin, uint32_t end,
+    std::vector<std::pair<const char*, const char*>>& dst) const {
+
+    if (begin >= end) {
+        return;
+    }
+
+    uint64_t first = row(begin);
+    uint64_t last = row(end - 1) + 1;
+
+    for (uint32_t i = 0; i < mappings_.size(); ++i) {
+
+        uint64_t lo = std::max(first, begins_[i]);
+        uint64_t hi = std::min(last, begins_[i + 1]);
+        if (lo >= hi) {
+            continue;
+        }
+        lo -= begins_[i];
+        hi -= begins_[i];
+
+        if (!columnar_[i]) {
+            dst.emplace_back(mappings_[i]->data() + mappings_[i]->object_offset(lo),
+                mappings_[i]->data() + mappings_[i]->object_offset(hi));
+            continue;
+        }
+
+        const auto& columns = columns_[i];
+        addColumnRange(dst, columns.err_rate, lo, hi);
+        addColumnRange(dst, columns.orig_err_rate, lo, hi);
+        addColumnRange(dst, columns.a, lo, hi);
+        addColumnRange(dst, columns.b, lo, hi);
+        addColumnRange(dst, columns.a_hang, lo, hi);
+        addColumnRange(dst, columns.b_hang, lo, hi);
+        addColumnRange(dst, columns.a_lo, lo, hi);
+        addColumnRange(dst, columns.a_hi, lo, hi);
+        addColumnRange(dst, columns.b_lo, lo, hi);
+        addColumnRange(dst, columns.b_hi, lo, hi);
+        addColumnRange(dst, columns.confirmations, lo, hi);
+        addColumnRange(dst, columns.flags, lo, hi);
+    }
+}
+
+void OverlapSegments::select(const OverlapPredicate& predicate, const ReadSet& reads,
+    std::vector<uint32_t>& dst) const {
+
+    // rows are split between threads and selected indices joined in order
+    std::vector<std::vector<uint32_t>> selected(std::max(1U, threadsSize()));
+
+    parallelRanges(selected.size(), [&](uint32_t range_begin, uint32_t range_end) {
+        for (uint32_t i = range_begin; i < range_end; ++i) {
+            select_rows(predicate, reads, rows_size() * i / selected.size(),
+                rows_size() * (i + 1) / selected.size(), selected[i]);
+        }
+    });
+
+    for (const auto& it: selected) {
+        dst.insert(dst.end(), it.begin(), it.end());
+    }
+}
+
+void OverlapSegments::select_rows(const OverlapPredicate& predicate, const ReadSet& reads,
+    uint64_t begin, uint64_t end, std::vector<uint32_t>& dst) const {
+
+    for (uint32_t i = 0; i < mappings_.size(); ++i) {
+
+        uint64_t lo = std::max(begin, begins_[i]);
+        uint64_t hi = std::min(end, begins_[i + 1]);
+
+        while (lo < hi) {
+
+            // segments without a zone map are checked as a single zone
+            uint64_t zone_end = hi;
+
+            if (zoned_[i]) {
+                const auto& zones = zones_[i];
+                uint64_t zone = (lo - begins_[i]) / zones.zone_size;
+                zone_end = std::min(hi, begins_[i] + (zone + 1) * zones.zone_size);
+
+                if (!predicate.may_match(zones.zones[zone])) {
+                    lo = zone_end;
+                    continue;
+                }
+
+                if (predicate.all_match(zones.zones[zone])) {
+                    for (; lo < zone_end; ++lo) {
+                        if (!removed(lo)) {
+                            dst.push_back(index(lo));
+                        }
+                    }
+                    continue;
+                }
+            }
+
+            for (; lo < zone_end; ++lo) {
+                if (removed(lo)) {
+                    continue;
+                }
+                auto overlap = overlap_at(lo);
+                if (predicate.matches(overlap.err_rate(), overlapLength(overlap),
+                    overlapCovered(overlap, reads))) {
+                    dst.push_back(index(lo));
+                }
+            }
+        }
+    }
+}
+
+bool OverlapSegments::zone(uint64_t row, OverlapZone& dst) const {
+
+    uint32_t segment = std::upper_bound(begins_.begin(), begins_.end(), row) -
+        begins_.begin() - 1;
+
+    if (!zoned_[segment]) {
+        return false;
+    }
+
+    const auto& zones = zones_[segment];
+    dst = zones.zones[(row - begins_[segment]) / zones.zone_size];
+
+    return true;
+}
+
+bool OverlapZones::map(const char* data, size_t length, uint64_t overlaps_size) {
+
+    uint32_t header[2];
+    if (data == nullptr || length < kHeaderSize) {
+        return false;
+    }
+
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != kMagic || header[1] != kVersion) {
+        return false;
+    }
+
+    uint64_t sizes[3];
+    std::memcpy(sizes, data + sizeof(header), sizeof(sizes));
+
+    // zone maps of older overlaps are ignored
+    if (sizes[0] != overlaps_size || sizes[1] == 0 ||
+        sizes[2] != (overlaps_size + sizes[1] - 1) / sizes[1] ||
+        length != kHeaderSize + sizes[2] * sizeof(OverlapZone)) {
+        return false;
+    }
+
+    size = sizes[2];
+    zone_size = sizes[1];
+    zones = (const OverlapZone*) (data + kHeaderSize);
+
+    return true;
+}
+
+bool OverlapAdjacency::map(const char* data, size_t length, uint64_t overlaps_size) {
+
+    uint32_t header[2];
+    if (data == nullptr || length < kHeaderSize) {
+        return false;
+    }
+
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != kMagic || header[1] != kVersion) {
+        return false;
+    }
+
+    uint64_t sizes[3];
+    std::memcpy(sizes, data + sizeof(header), sizeof(sizes));
+
+    // indices of older overlaps are ignored
+    if (sizes[1] != overlaps_size || length != kHeaderSize +
+        (sizes[0] + 1) * sizeof(uint64_t) + sizes[2] * sizeof(uint32_t)) {
+        return false;
+    }
+
+    reads_size = sizes[0];
+    size = sizes[2];
+    offsets = (const uint64_t*) (data + kHeaderSize);
+    rows = (const uint32_t*) (offsets + reads_size + 1);
+
+    return true;
+}
+
+bool OverlapSegments::removed(uint64_t row) const {
+
+    if ((row / 64 + 1) * sizeof(uint64_t) > tombstones_length_) {
+        return false;
+    }
+
+    uint64_t word;
+    std::memcpy(&word, tombstones_ + (row / 64) * sizeof(uint64_t), sizeof(word));
+
+    return (word >> (row % 64)) & 1;
+}
+
+uint64_t OverlapSegments::row(uint32_t index) const {
+
+    if (size_ == rows_size()) {
+        return index;
+    }
+
+    // last word with fewer overlaps before it than index + 1
+    uint64_t word_index = std::upper_bound(ranks_.begin(), ranks_.end(),
+        (uint64_t) index) - ranks_.begin() - 1;
+
+    uint64_t row = word_index * 64;
+    uint64_t rank = ranks_[word_index];
+
+    for (;; ++row) {
+        if (!removed(row) && rank++ == index) {
+            return row;
+        }
+    }
+}
+
+MappedOverlap OverlapSegments::overlap_at(uint64_t row) const {
+
+    uint32_t segment = std::upper_bound(begins_.begin(), begins_.end(), row) -
+        begins_.begin() - 1;
+    uint64_t segment_row = row - begins_[segment];
+
+    return columnar_[segment] ? MappedOverlap(&columns_[segment], segment_row) :
+        MappedOverlap(mappings_[segment]->object(segment_row));
+}
+
+const OverlapColumns* OverlapSegments::columns() const {
+    return mappings_.size() == 1 && columnar_[0] && size_ == rows_size() ?
+        &columns_[0] : nullptr;
+}
+
+MappedRead::MappedRead(const char* bytes)
+        : bytes_(bytes) {
+
+    uint32_t ptr = sizeof(DepotObjectType);
+
+    std::memcpy(&id_, bytes + ptr, sizeof(id_));
+    ptr += sizeof(id_);
+
+    std::memcpy(&name_length_, bytes + ptr, sizeof(name_length_));
+    ptr += sizeof(name_length_);
+    name_ = bytes + ptr;
+    ptr += name_length_;
+
+    std::memcpy(&length_, bytes + ptr, sizeof(length_));
+    ptr += sizeof(length_);
+    sequence_ = bytes + ptr;
+    ptr += length_;
+
+    // see Read::serialize
+    uint32_t field_size;
+    std::memcpy(&field_size, bytes + ptr, sizeof(field_size));
+    ptr += sizeof(field_size);
+
+    quality_ = "";
+    quality_length_ = 0;
+    quality_binned_ = (field_size & Read::kBinnedQualityFlag) != 0;
+
+    if (field_size > 1) {
+        quality_ = bytes + ptr;
+        quality_length_ = field_size & ~Read::kBinnedQualityFlag;
+        ptr += quality_length_;
+    }
+
+    coverage_ = bytes + ptr;
+}
+
+std::string MappedRead::quality() const {
+
+    if (!quality_binned_) {
+        return std::string(quality_, quality_length_);
+    }
+
+    std::string dst;
+    decodeBinnedQualities(dst, quality_, quality_length_);
+
+    return dst;
+}
+
+double MappedRead::coverage() const {
+
+    double coverage;
+    std::memcpy(&coverage, coverage_, sizeof(coverage));
+
+    return coverage;
+}
+
+Read* MappedRead::materialize() const {
+    return Read::deserialize(bytes_);
+}
+
+Overlap* MappedOverlap::materialize(const ReadSet& reads) const {
+
+    if (columns_ == nullptr) {
+        return Overlap::deserialize(bytes_, reads);
+    }
+
+    auto overlap = new Overlap();
+    materialize(overlap, reads);
+
+    return overlap;
+}
+
+void MappedOverlap::materialize(Overlap* overlap, const ReadSet& reads) const {
+
+    if (columns_ == nullptr) {
+        auto stored = Overlap::deserialize(bytes_, reads);
+        *overlap = *stored;
+        delete stored;
+        return;
+    }
+
+    ASSERT(a() < reads.size(), "Depot", "Missing read %u!", a());
+    ASSERT(b() < reads.size(), "Depot", "Missing read %u!", b());
+
+    overlap->read_a_ = reads[a()];
+    overlap->a_hang_ = a_hang();
+    overlap->read_b_ = reads[b()];
+    overlap->b_hang_ = b_hang();
+    overlap->is_innie_ = is_innie();
+    overlap->is_dovetail_ = is_dovetail();
+    overlap->a_lo_ = a_lo();
+    overlap->a_hi_ = a_hi();
+    overlap->b_lo_ = b_lo();
+    overlap->b_hi_ = b_hi();
+    overlap->err_rate_ = err_rate();
+    overlap->orig_err_rate_ = orig_err_rate();
+    overlap->confirmations_ = confirmations();
+}
+
+MappedDepot::MappedDepot(const std::string& path)
+        : overlap_tombstones_(nullptr), overlap_segments_() {
+
+    ASSERT(pathExists(path.c_str()) == 0, "Depot", "Missing depot folder %s!",
+        path.c_str());
+
+    std::string path_ = path + "/read_data.bin";
+    openAndShareLockFile(&read_data_, path_.c_str());
+
+    path_ = path + "/read_index.bin";
+    openAndShareLockFile(&read_index_, path_.c_str());
+
+    path_ = path + "/overlap_data.bin";
+    openAndShareLockFile(&overlap_data_, path_.c_str());
+
+    path_ = path + "/overlap_index.bin";
+    openAndShareLockFile(&overlap_index_, path_.c_str());
+
+    // older depots have no deletion bitmap
+    path_ = path + "/overlap_tombstones.bin";
+    if (pathExists(path_.c_str()) == 0) {
+        openAndShareLockFile(&overlap_tombstones_, path_.c_str());
+    }
+
+    overlap_adjacencies_.push_back(fopenIfExists(overlapAdjacencyPath(path, 0).c_str()));
+    overlap_zones_.push_back(fopenIfExists(overlapZonesPath(path, 0).c_str()));
+
+    for (uint32_t i = 1; ; ++i) {
+        path_ = overlapSegmentPath(path, i);
+        if (pathExists(path_.c_str()) != 0) {
+            break;
+        }
+        overlap_segments_.push_back(fopenWrapper(path_.c_str(), "rb"));
+        overlap_adjacencies_.push_back(fopenIfExists(overlapAdjacencyPath(path, i).c_str()));
+        overlap_zones_.push_back(fopenIfExists(overlapZonesPath(path, i).c_str()));
+    }
+
+    reads_ = new DepotMapping(read_data_, read_index_);
+    overlaps_ = new OverlapSegments(overlap_data_, overlap_index_, overlap_segments_,
+        overlap_tombstones_, overlap_adjacencies_, overlap_zones_);
+
+    if (reads_->blocked()) {
+        read_blocks_.reset(new ReadBlock[reads_->blocks_size()]);
+        read_block_flags_.reset(new std::once_flag[reads_->blocks_size()]);
+    }
+}
+
+MappedRead MappedDepot::read(uint32_t index) const {
+
+    if (!reads_->blocked()) {
+        return MappedRead(reads_->object(index));
+    }
+
+    uint32_t block = reads_->block_of(index);
+    std::call_once(read_block_flags_[block], [this, block]() {
+        reads_->decode_block(read_blocks_[block], block); });
+
+    return MappedRead(read_blocks_[block].record(index - reads_->block_begin(block)));
+}
+
+MappedDepot::~MappedDepot() {
+
+    delete overlaps_;
+    delete reads_;
+
+    unlockAndCloseFile(read_data_);
+    unlockAndCloseFile(read_index_);
+    unlockAndCloseFile(overlap_data_);
+    unlockAndCloseFile(overlap_index_);
+
+    if (overlap_tombstones_ != nullptr) {
+        unlockAndCloseFile(overlap_tombstones_);
+    }
+    for (const auto& it: overlap_segments_) {
+        fclose(it);
+    }
+    for (const auto& it: overlap_adjacencies_) {
+        if (it != nullptr) {
+            fclose(it);
+        }
+    }
+    for (const auto& it: overlap_zones_) {
+        if (it != nullptr) {
+            fclose(it);
+        }
+    }
+}
+
+std::string shardPath(const std::string& path, uint32_t index) {
+    return path + "/shard_" + std::to_string(index);
+}
+
+std::string shardManifestPath(const std::string& path) {
+    return path + "/shard_manifest.bin";
+}
+
+ShardedDepot::ShardedDepot(const std::string& path, bool read_only)
+        : path_(path), read_only_(read_only), reads_size_(0), shards_(), depots_() {
+
+    auto manifest_path = shardManifestPath(path);
+
+    if (pathExists(manifest_path.c_str()) != 0) {
+        ASSERT(!read_only, "Depot", "Missing shard manifest in %s!", path.c_str());
+        createFolder(path.c_str());
+        return;
+    }
+
+    auto file = fopenWrapper(manifest_path.c_str(), "rb");
+
+    uint32_t header[2];
+    freadWrapper(header, sizeof(*header), 2, file);
+    ASSERT(header[0] == kMagic && header[1] == kVersion, "Depot",
+        "Invalid shard manifest in %s!", path.c_str());
+
+    uint64_t sizes[2];
+    freadWrapper(sizes, sizeof(*sizes), 2, file);
+
+    reads_size_ = sizes[1];
+    shards_.resize(sizes[0]);
+    freadWrapper(shards_.data(), sizeof(DepotShard), shards_.size(), file);
+
+    fclose(file);
+
+    depots_.resize(shards_.size(), nullptr);
+}
+
+ShardedDepot::~ShardedDepot() {
+    close_shards();
+}
+
+void ShardedDepot::close_shards() {
+    for (const auto& it: depots_) {
+        delete it;
+    }
+    depots_.clear();
+}
+
+void ShardedDepot::store(const ReadSet& reads, const OverlapSet& overlaps,
+    uint32_t shards_size) {
+
+    ASSERT(!read_only_, "Depot", "Unable to store to read-only depot!");
+    ASSERT(shards_size > 0 && shards_size <= reads.size(), "Depot",
+        "Invalid number of shards %u!", shards_size);
+
+    uint64_t bases = 0;
+    for (uint32_t i = 0; i < reads.size(); ++i) {
+        ASSERT(reads[i] != nullptr && reads[i]->id() == i, "Depot",
+            "Read %u is not stored at the index of its identifier!", i);
+        bases += reads[i]->length();
+    }
+
+    // ranges with about the same number of bases, none of them empty
+    std::vector<uint64_t> begins(shards_size + 1, reads.size());
+    begins[0] = 0;
+
+    uint64_t prefix = 0;
+    for (uint32_t i = 0, k = 1; i < reads.size() && k < shards_size; ++i) {
+        while (k < shards_size && prefix >= bases * k / shards_size) {
+            begins[k++] = i;
+        }
+        prefix += reads[i]->length();
+    }
+    for (uint32_t k = 1; k < shards_size; ++k) {
+        begins[k] = std::max(begins[k], begins[k - 1] + 1);
+    }
+    for (uint32_t k = shards_size - 1; k > 0; --k) {
+        begins[k] = std::min(begins[k], begins[k + 1] - 1);
+    }
+
+    close_shards();
+    reads_size_ = reads.size();
+    shards_.assign(shards_size, DepotShard());
+
+    std::vector<ReadSet> shard_reads(shards_size);
+    for (uint32_t k = 0; k < shards_size; ++k) {
+        shards_[k].reads_begin = begins[k];
+        shards_[k].reads_end = begins[k + 1];
+        shard_reads[k].assign(reads.begin() + begins[k], reads.begin() + begins[k + 1]);
+    }
+
+    std::vector<OverlapSet> shard_overlaps(shards_size);
+    std::vector<std::vector<uint32_t>> boundary_reads(shards_size);
+
+    for (const auto& it: overlaps) {
+        uint32_t a = shard_of(it->a());
+        uint32_t b = shard_of(it->b());
+
+        shard_overlaps[a].push_back(it);
+        if (a == b) {
+            continue;
+        }
+        shard_overlaps[b].push_back(it);
+
+        boundary_reads[a].push_back(it->b());
+        boundary_reads[b].push_back(it->a());
+        ++shards_[a].boundary_overlaps;
+        ++shards_[b].boundary_overlaps;
+    }
+
+    for (uint32_t k = 0; k < shards_size; ++k) {
+        auto& ids = boundary_reads[k];
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        for (const auto& id: ids) {
+            shard_reads[k].push_back(reads[id]);
+        }
+        shards_[k].boundary_reads = ids.size();
+        shards_[k].overlaps = shard_overlaps[k].size();
+
+        Depot depot(shardPath(path_, k));
+        depot.store_reads(shard_reads[k]);
+        // overlap files of shards without overlaps stay empty
+        if (!shard_overlaps[k].empty()) {
+            depot.store_overlaps(shard_overlaps[k]);
+        }
+    }
+
+    auto manifest_path = shardManifestPath(path_);
+    auto file = fopenWrapper(manifest_path.c_str(), "wb");
+
+    uint32_t header[2] = { kMagic, kVersion };
+    uint64_t sizes[2] = { shards_.size(), reads_size_ };
+    fwriteWrapper(header, sizeof(*header), 2, file);
+    fwriteWrapper(sizes, sizeof(*sizes), 2, file);
+    fwriteWrapper(shards_.data(), sizeof(DepotShard), shards_.size(), file);
+
+    fclose(file);
+
+    depots_.resize(shards_.size(), nullptr);
+}
+
+void ShardedDepot::load_shard(uint32_t index, ReadSet& dst_reads,
+    OverlapSet& dst_overlaps) {
+
+    ASSERT(dst_reads.empty(), "Depot", "Reads of a shard need an empty read set!");
+
+    auto& depot = shard(index);
+
+    ReadSet loaded;
+    depot.load_reads(loaded);
+
+    dst_reads.resize(reads_size_, nullptr);
+    for (const auto& it: loaded) {
+        dst_reads[it->id()] = it;
+    }
+
+    if (shards_[index].overlaps != 0) {
+        depot.load_overlaps(dst_overlaps, dst_reads);
+    }
+}
+
+Depot& ShardedDepot::shard(uint32_t index) {
+
+    ASSERT(index < shards_.size(), "Depot", "Missing shard %u!", index);
+
+    if (depots_[index] == nullptr) {
+        depots_[index] = new Depot(shardPath(path_, index), read_only_);
+    }
+
+    return *depots_[index];
+}
+
+uint32_t ShardedDepot::shard_of(uint32_t id) const {
+
+    ASSERT(id < reads_size_, "Depot", "Missing read %u!", id);
+
+    return std::upper_bound(shards_.begin(), shards_.end(), id,
+        [](uint32_t id_, const DepotShard& shard) { return id_ < shard.reads_end; }) -
+        shards_.begin();
+}
+
+uint32_t ShardedDepot::owner(const Overlap& overlap) const {
+    return shard_of(std::min(overlap.a(), overlap.b()));
+}
+
+void ShardedDepot::remove_overlaps(uint32_t index, const OverlapSet& loaded,
+    const std::vector<uint32_t>& indices) {
+
+    for (const auto& it: indices) {
+        ASSERT(it < loaded.size(), "Depot", "Overlap index %u out of range!", it);
+        ASSERT(owns(index, *loaded[it]), "Depot",
+            "Overlap %u is owned by shard %u, not shard %u!", it, owner(*loaded[it]), index);
+    }
+
+    if (!indices.empty()) {
+        shard(index).remove_overlaps(indices);
+    }
+}
+
+uint64_t ShardedDepot::reconcile() {
+
+    ASSERT(!read_only_, "Depot", "Unable to reconcile read-only depot!");
+
+    using OverlapKey = std::tuple<uint32_t, uint32_t, int32_t, int32_t, bool>;
+    auto key = [](const Overlap* overlap) -> OverlapKey {
+        return std::make_tuple(overlap->a(), overlap->b(), overlap->a_hang(),
+            overlap->b_hang(), overlap->is_innie());
+    };
+
+    // boundary overlaps kept by their owner, counted per key
+    std::vector<std::map<OverlapKey, uint32_t>> kept(shards_.size());
+
+    for (uint32_t k = 0; k < shards_.size(); ++k) {
+        ReadSet reads;
+        OverlapSet overlaps;
+        load_shard(k, reads, overlaps);
+
+        for (const auto& it: overlaps) {
+            if (shard_of(it->a()) != shard_of(it->b()) && owns(k, *it)) {
+                ++kept[k][key(it)];
+            }
+        }
+
+        for (const auto& it: overlaps) delete it;
+        for (const auto& it: reads) delete it;
+    }
+
+    uint64_t removed_size = 0;
+
+    for (uint32_t k = 0; k < shards_.size(); ++k) {
+        ReadSet reads;
+        OverlapSet overlaps;
+        load_shard(k, reads, overlaps);
+
+        std::vector<uint32_t> removed;
+        for (uint32_t i = 0; i < overlaps.size(); ++i) {
+            if (owns(k, *overlaps[i])) {
+                continue;
+            }
+            auto& counts = kept[owner(*overlaps[i])];
+            auto it = counts.find(key(overlaps[i]));
+            if (it == counts.end() || it->second == 0) {
+                removed.push_back(i);
+            } else {
+                --it->second;
+            }
+        }
+
+        if (!removed.empty()) {
+            shard(k).remove_overlaps(removed);
+        }
+        removed_size += removed.size();
+
+        for (const auto& it: overlaps) delete it;
+        for (const auto& it: reads) delete it;
+    }
+
+    // all shards were loaded twice
+    releasePool();
+
+    return removed_size;
 }
@@ -10,22 +10,39 @@
 #pragma once
 
 #include "Read.hpp"
+#include "ReadStore.hpp"
 #include "Overlap.hpp"
+#include "ReadBlockCodec.hpp"
 #include "CommonHeaders.hpp"
 
+class ReadBatchReader;
+class OverlapSegments;
+struct OverlapPredicate;
+
 /*!
  * @brief Depot class
+ * @details Overlaps can be updated without rewriting the depot: removed
+ * overlaps are marked in a deletion bitmap and new overlaps are appended as
+ * segments, loaders skip removed overlaps until compact_overlaps is called.
+ * Indices of overlaps always refer to overlaps which are not removed.
+ * Depots opened read-only take shared file locks, so any number of
+ * processes can read a depot at once, and their loaders can be called from
+ * several threads without waiting for each other.
  */
 class Depot {
 public:
 
     /*!
      * @brief Depot constructor
-     * @details Creates a Depot object from a path to the wanted folder
+     * @details Creates a Depot object from a path to the wanted folder, the
+     * depot files are locked exclusively unless the depot is opened
+     * read-only (the depot has to exist then and methods which change it
+     * are not allowed)
      *
      * @param [in] path path to a folder
+     * @param [in] read_only true if the depot is only read
      */
-    Depot(const std::string& path);
+    Depot(const std::string& path, bool read_only = false);
 
     /*!
      * @brief Depot destructor
@@ -34,16 +51,56 @@ public:
 
     /*!
      * @brief Method for storing Read objects
-     * @details Stores Read objects to a binary file in the depot folder
+     * @details Stores Read objects to a binary file in the depot folder in
+     * independently compressed blocks (see ReadBlockCodec.hpp)
      *
      * @param [in] src set of Read object pointers
      */
     void store_reads(const ReadSet& src);
 
+    /*!
+     * @brief Method for storing reads kept in a ReadStore
+     * @details Stores reads to a binary file in the depot folder in
+     * independently compressed blocks (see ReadBlockCodec.hpp) indexed by a
+     * kReadBlocksMagic index (see DepotMapping)
+     *
+     * @param [in] src ReadStore object
+     */
+    void store_reads(const ReadStore& src);
+
+    /*!
+     * @brief Method for storing reads from a batch reader
+     * @details Stores all reads yielded by src, only two batches are kept in
+     * memory at once and each batch is written while the next one is parsed
+     *
+     * @param [in] src ReadBatchReader object
+     */
+    void store_reads(ReadBatchReader& src);
+
+    /*!
+     * @brief Method for appending Read objects
+     * @details Appends Read objects to the reads already stored in the
+     * depot folder (identifiers are not changed), reads appended to depots
+     * with uncompressed reads stay uncompressed
+     *
+     * @param [in] src set of Read object pointers
+     */
+    void append_reads(const ReadSet& src);
+
+    /*!
+     * @brief Method for appending reads kept in a ReadStore
+     * @details Appends reads to the reads already stored in the depot folder
+     * (identifiers are not changed)
+     *
+     * @param [in] src ReadStore object
+     */
+    void append_reads(const ReadStore& src);
+
     /*!
      * @bried Method for loading a single Read object stored beforehand
      * @details Loads a Read object from a binary file in the depot folder
-     * determined by the given index
+     * determined by the given index, only the block holding the read is
+     * decompressed
      *
      * @param [in] index index of the wanted Read object
      * @return Read object pointer
@@ -52,7 +109,8 @@ public:
 
     /*!
      * @brief Method for loading the set of Read objects stored beforehand
-     * @details Loads Read objects from a binary file in the depot folder
+     * @details Loads Read objects from a binary file in the depot folder,
+     * blocks are decompressed in parallel
      *
      * @param [out] dst set of Read object pointers
      */
@@ -71,14 +129,90 @@ public:
      */
     void load_reads(ReadSet& dst, uint32_t begin, uint32_t length);
 
+    /*!
+     * @brief Method for loading the set of reads stored beforehand
+     * @details Loads reads from a binary file in the depot folder into a
+     * ReadStore without creating Read objects
+     *
+     * @param [out] dst ReadStore object
+     */
+    void load_reads(ReadStore& dst);
+
+    /*!
+     * @brief Method for loading an incomplete set of reads stored beforehand
+     * @details Loads the given number of reads from a binary file in
+     * the depot folder starting from the given index into a ReadStore
+     *
+     * @param [out] dst ReadStore object
+     * @param [in] begin index of first read
+     * @param [in] length length of reads to be loaded (if length goes
+     * out of range, function returns all reads from the beginning index
+     * to the last read available)
+     */
+    void load_reads(ReadStore& dst, uint32_t begin, uint32_t length);
+
+    /*!
+     * @brief Method for streaming the reads stored beforehand
+     * @details Passes stored reads to callback in batches of at most
+     * batch_size reads together with the index of the first read of the
+     * batch; the same ReadStore is cleared and refilled for each batch so
+     * memory does not grow with the number of reads. The callback must not
+     * call other methods of the depot.
+     *
+     * @param [in] batch_size maximal number of reads in a batch
+     * @param [in] callback function called for each batch
+     */
+    void scan_reads(uint32_t batch_size,
+        const std::function<void(const ReadStore&, uint32_t)>& callback);
+
     /*!
      * @brief Method for storing Overlap objects
      * @details Stores overlap objects to a binary file in the depot folder
+     * in the fixed width columnar format (see OverlapColumns) together with
+     * their adjacency index (see OverlapAdjacency) and zone map (see
+     * OverlapZones), depots with overlaps in
+     * the older format are converted and all segments and removed overlaps
+     * are dropped
      *
      * @param [in] src set of Overlap object pointers
      */
     void store_overlaps(const OverlapSet& src);
 
+    /*!
+     * @brief Method for appending Overlap objects
+     * @details Appends overlap objects as a new segment in the fixed width
+     * columnar format, stored overlaps are not rewritten
+     *
+     * @param [in] src set of Overlap object pointers
+     */
+    void append_overlaps(const OverlapSet& src);
+
+    /*!
+     * @brief Method for overlap removal
+     * @details Marks overlaps as removed in the deletion bitmap
+     *
+     * @param [in] indices indices of overlaps as loaded by load_overlaps
+     */
+    void remove_overlaps(const std::vector<uint32_t>& indices);
+
+    /*!
+     * @brief Method for updating stored overlaps
+     * @details Overlaps of loaded which are not in src are removed and
+     * overlaps of src which are not in loaded (compared by address) are
+     * appended as a new segment
+     *
+     * @param [in] loaded set of all overlaps as loaded by load_overlaps
+     * @param [in] src set of Overlap object pointers which should be kept
+     */
+    void update_overlaps(const OverlapSet& loaded, const OverlapSet& src);
+
+    /*!
+     * @brief Method for overlap compaction
+     * @details Rewrites all overlaps which are not removed to the overlap
+     * data file and drops the segments and the deletion bitmap
+     */
+    void compact_overlaps();
+
     /*!
      * @bried Method for loading a single Overlap object stored beforehand
      * @details Loads a Overlap object from a binary file in the depot folder
@@ -105,7 +239,8 @@ public:
      * the depot folder starting from the given index
      *
      * @param [out] dst set of Overlap object pointers
-     * @param [in] begin index of first Overlap object
+     * @param [in] begin index of first Overlap object (nothing is loaded if
+     * it equals the number of overlaps)
      * @param [in] length length of Overlap objects to be loaded (if length goes
      * out of range, function returns all objects from the beginning index
      * to the last object available)
@@ -114,19 +249,973 @@ public:
     void load_overlaps(OverlapSet& dst, uint32_t begin, uint32_t length,
         const ReadSet& reads);
 
+    /*!
+     * @brief Method for loading overlaps of given reads
+     * @details Loads Overlap objects which contain any of the given reads
+     * (each once, in the order of load_overlaps), only the needed overlaps
+     * are read if the adjacency index is stored
+     *
+     * @param [out] dst set of Overlap object pointers
+     * @param [in] ids read identifiers
+     * @param [in] reads vector of Read objects needed to reconstruct Overlap
+     * objects (only the reads of loaded overlaps have to be set)
+     */
+    void load_overlaps_for_reads(OverlapSet& dst, const std::vector<uint32_t>& ids,
+        const ReadSet& reads);
+
+    /*!
+     * @brief Method for streaming the overlaps stored beforehand
+     * @details Passes overlaps which are not removed to callback in batches
+     * of at most batch_size overlaps together with the index of the first
+     * overlap of the batch (see remove_overlaps). The Overlap objects of a
+     * batch are overwritten by the next batch and deleted afterwards (their
+     * slabs are returned to the system, see releasePool), so they must not
+     * be kept by the callback. The callback must not call
+     * other methods of the depot.
+     *
+     * @param [in] batch_size maximal number of overlaps in a batch
+     * @param [in] reads vector of Read objects needed to reconstruct Overlap objects
+     * @param [in] callback function called for each batch
+     */
+    void scan_overlaps(uint32_t batch_size, const ReadSet& reads,
+        const std::function<void(const OverlapSet&, uint32_t)>& callback);
+
+    /*!
+     * @brief Method for overlap selection
+     * @details Appends indices of overlaps which match the predicate to dst
+     * in increasing order without creating Overlap objects; zones of
+     * overlaps which can not match are skipped and zones whose overlaps
+     * all match are taken as a whole (see OverlapZones)
+     *
+     * @param [out] dst vector of overlap indices
+     * @param [in] reads vector of Read objects (their lengths are needed
+     * for covered percentages)
+     * @param [in] predicate overlap predicate
+     */
+    void select_overlaps(std::vector<uint32_t>& dst, const ReadSet& reads,
+        const OverlapPredicate& predicate);
+
+    /*!
+     * @brief Method for loading overlaps which match a predicate
+     * @details Loads Overlap objects selected with select_overlaps in the
+     * order of load_overlaps
+     *
+     * @param [out] dst set of Overlap object pointers
+     * @param [in] reads vector of Read objects needed to reconstruct Overlap objects
+     * @param [in] predicate overlap predicate
+     */
+    void load_overlaps(OverlapSet& dst, const ReadSet& reads,
+        const OverlapPredicate& predicate);
+
+    /*!
+     * @brief Method for loading overlap error rates
+     * @details Appends error rates of all overlaps to dst in the order of
+     * load_overlaps without creating Overlap objects
+     *
+     * @param [out] dst vector of error rates
+     */
+    void load_overlap_err_rates(std::vector<double>& dst);
+
 private:
 
     template<typename T>
-    void store(const std::vector<T*>& src, FILE* data, FILE* index);
+    void write_reads(const T& src, bool truncate);
 
     template<typename T>
+    void append_read_blocks(const T& src);
+
+    template<typename T>
+    void append_objects(const T& src, FILE* data, FILE* index);
+
+    template<typename T, typename F>
     void load(std::vector<T*>& dst, uint32_t begin, uint32_t length,
-        FILE* data, FILE* index);
+        FILE* data, FILE* index, F create);
+
+    void load_bytes(uint32_t begin, uint32_t length, FILE* data, FILE* index,
+        const std::function<void(const char*)>& callback);
+
+    void store_overlap_segment(FILE* dst, uint32_t segment, const OverlapSet& src);
+
+    template<typename F>
+    void store_overlap_columns(FILE* dst, uint64_t size, F overlap);
+
+    template<typename T, typename F>
+    void store_column(FILE* dst, uint64_t size, F value);
+
+    template<typename F>
+    void store_overlap_adjacency(uint32_t segment, uint64_t size, F overlap);
+
+    template<typename F>
+    void store_overlap_zones(uint32_t segment, uint64_t size, F zone);
+
+    OverlapSegments* map_overlaps(std::vector<FILE*>& files);
+
+    void unmap_overlaps(OverlapSegments* overlaps, std::vector<FILE*>& files);
+
+    void remove_overlap_segments();
+
+    // locks mutex_ unless the depot is read-only
+    std::unique_lock<std::mutex> read_lock();
+
+    void check_writable() const;
 
     std::mutex mutex_;
 
+    std::string depot_path_;
+    bool read_only_;
+
     FILE* read_data_;
     FILE* read_index_;
     FILE* overlap_data_;
     FILE* overlap_index_;
+    FILE* overlap_tombstones_;
+};
+
+/*!
+ * @brief DepotMapping class
+ * @details Memory mapped data and index file of one object type; the index
+ * holds the number of objects followed by their offsets in the data file
+ * (the index may be missing if the data file has its own layout).
+ * Reads are stored in compressed blocks instead, their index holds
+ * kReadBlocksMagic, the number of reads and the number of blocks followed
+ * by the index of the first read and the offset of each block (and of the
+ * end of the last one).
+ */
+class DepotMapping {
+public:
+
+    // larger than any object count of the older index format
+    static constexpr uint64_t kReadBlocksMagic = (uint64_t) 0x4b4c4152 << 32 | 1;
+
+    DepotMapping(FILE* data, FILE* index);
+
+    ~DepotMapping();
+
+    uint32_t size() const {
+        return size_;
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t data_length() const {
+        return data_length_;
+    }
+
+    /*!
+     * @brief Getter for a serialized object
+     * @details Not available if objects are stored in blocks.
+     *
+     * @param [in] index index of the object
+     * @return bytes the object was serialized to
+     */
+    const char* object(uint32_t index) const {
+        return data_ + offsets_[index] + sizeof(uint32_t);
+    }
+
+    bool blocked() const {
+        return blocks_ != nullptr;
+    }
+
+    uint32_t blocks_size() const {
+        return blocks_size_;
+    }
+
+    /*!
+     * @brief Getter for the block holding an object
+     *
+     * @param [in] index index of the object
+     * @return index of the block
+     */
+    uint32_t block_of(uint32_t index) const;
+
+    /*!
+     * @brief Getter for the index of the first object of a block
+     */
+    uint32_t block_begin(uint32_t block) const {
+        return blocks_[2 * block];
+    }
+
+    /*!
+     * @brief Getter for the offset of a block in the data file
+     * @details Block blocks_size() is the end of the last block.
+     */
+    uint64_t block_offset(uint32_t block) const {
+        return blocks_[2 * block + 1];
+    }
+
+    /*!
+     * @brief Getter for the offset of an object in the data file
+     * @details Not available if objects are stored in blocks, object size()
+     * is the end of the last object.
+     */
+    uint64_t object_offset(uint32_t index) const {
+        return offsets_[index];
+    }
+
+    /*!
+     * @brief Method for block decompression
+     *
+     * @param [out] dst decoded block
+     * @param [in] block index of the block
+     */
+    void decode_block(ReadBlock& dst, uint32_t block) const;
+
+private:
+
+    DepotMapping(const DepotMapping&) = delete;
+    const DepotMapping& operator=(const DepotMapping&) = delete;
+
+    const char* data_;
+    size_t data_length_;
+    const char* index_;
+    size_t index_length_;
+    const uint64_t* offsets_;
+    uint32_t size_;
+    const uint64_t* blocks_;
+    uint32_t blocks_size_;
+};
+
+/*!
+ * @brief OverlapColumns struct
+ * @details Overlaps stored in the fixed width depot format, the overlap data
+ * file holds a 16 byte header (magic, version and number of overlaps) and
+ * one array per field in the order below, so overlap i is found without
+ * an index file and a scan over a few fields touches only their pages.
+ * Older depots store variable length serialized overlaps with a separate
+ * offset file, which can still be read.
+ */
+struct OverlapColumns {
+
+    static constexpr uint32_t kMagic = 0x564f4152; // "RAOV"
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kHeaderSize = 16;
+
+    // bits of flags
+    static constexpr uint8_t kInnie = 1;
+    static constexpr uint8_t kDovetail = 2;
+
+    /*!
+     * @brief Method for column mapping
+     * @details Sets the column pointers into data
+     *
+     * @param [in] data overlap data file contents
+     * @param [in] length length of data
+     * @return false if data is not in the fixed width format
+     */
+    bool map(const char* data, size_t length);
+
+    uint64_t size;
+
+    const double* err_rate;
+    const double* orig_err_rate;
+    const uint32_t* a;
+    const uint32_t* b;
+    const int32_t* a_hang;
+    const int32_t* b_hang;
+    const uint32_t* a_lo;
+    const uint32_t* a_hi;
+    const uint32_t* b_lo;
+    const uint32_t* b_hi;
+    const uint32_t* confirmations;
+    const uint8_t* flags;
+};
+
+/*!
+ * @brief OverlapAdjacency struct
+ * @details Index of overlaps by read identifier stored next to each overlap
+ * segment in compressed sparse row form: a 32 byte header (magic, version,
+ * number of reads, number of overlaps and number of entries), the offset
+ * of each read's entries (and of the end of the last one) and the rows of
+ * overlaps containing the read in increasing order.
+ */
+struct OverlapAdjacency {
+
+    static constexpr uint32_t kMagic = 0x4a414152; // "RAAJ"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kHeaderSize = 32;
+
+    /*!
+     * @brief Method for index mapping
+     * @details Sets the array pointers into data
+     *
+     * @param [in] data adjacency file contents
+     * @param [in] length length of data
+     * @param [in] overlaps_size number of overlaps in the indexed segment
+     * @return false if data is not a valid index of overlaps_size overlaps
+     */
+    bool map(const char* data, size_t length, uint64_t overlaps_size);
+
+    uint64_t reads_size;
+    uint64_t size;
+
+    const uint64_t* offsets;
+    const uint32_t* rows;
+};
+
+/*!
+ * @brief OverlapZone struct
+ * @details Bounds of error rates, lengths (see Overlap::length) and covered
+ * percentages (the smaller one of both reads, see Overlap::covered_percentage)
+ * of consecutive overlaps
+ */
+struct OverlapZone {
+    double min_err_rate;
+    double max_err_rate;
+    double min_covered;
+    double max_covered;
+    uint32_t min_length;
+    uint32_t max_length;
+};
+
+/*!
+ * @brief OverlapZones struct
+ * @details Zone map stored next to each overlap segment: a 32 byte header
+ * (magic, version, number of overlaps, number of overlaps in a zone and
+ * number of zones) followed by an OverlapZone for each kZoneSize
+ * consecutive overlaps.
+ */
+struct OverlapZones {
+
+    static constexpr uint32_t kMagic = 0x4d5a4152; // "RAZM"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kHeaderSize = 32;
+    static constexpr uint32_t kZoneSize = 4096;
+
+    /*!
+     * @brief Method for zone map mapping
+     * @details Sets the zone pointer into data
+     *
+     * @param [in] data zone map file contents
+     * @param [in] length length of data
+     * @param [in] overlaps_size number of overlaps in the segment
+     * @return false if data is not a valid zone map of overlaps_size overlaps
+     */
+    bool map(const char* data, size_t length, uint64_t overlaps_size);
+
+    uint64_t size;
+    uint64_t zone_size;
+
+    const OverlapZone* zones;
+};
+
+/*!
+ * @brief OverlapPredicate struct
+ * @details Matches overlaps with min_err_rate <= error rate < max_err_rate,
+ * min_length <= length <= max_length and a covered percentage of both reads
+ * of at least min_covered (see OverlapZone), all overlaps match by default
+ */
+struct OverlapPredicate {
+
+    bool matches(double err_rate, uint32_t length, double covered) const {
+        return err_rate >= min_err_rate && err_rate < max_err_rate &&
+            length >= min_length && length <= max_length && covered >= min_covered;
+    }
+
+    /*!
+     * @brief Method for zone pruning
+     * @return false if no overlap of the zone matches
+     */
+    bool may_match(const OverlapZone& zone) const {
+        return zone.max_err_rate >= min_err_rate && zone.min_err_rate < max_err_rate &&
+            zone.max_length >= min_length && zone.min_length <= max_length &&
+            zone.max_covered >= min_covered;
+    }
+
+    /*!
+     * @brief Method for zone selection
+     * @return true if all overlaps of the zone match
+     */
+    bool all_match(const OverlapZone& zone) const {
+        return zone.min_err_rate >= min_err_rate && zone.max_err_rate < max_err_rate &&
+            zone.min_length >= min_length && zone.max_length <= max_length &&
+            zone.min_covered >= min_covered;
+    }
+
+    double min_err_rate = -std::numeric_limits<double>::infinity();
+    double max_err_rate = std::numeric_limits<double>::infinity();
+    uint32_t min_length = 0;
+    uint32_t max_length = std::numeric_limits<uint32_t>::max();
+    double min_covered = -std::numeric_limits<double>::infinity();
+};
+
+/*!
+ * @brief MappedRead class
+ * @details Read-only view of a read stored in a memory mapped depot
+ */
+class MappedRead {
+public:
+
+    MappedRead(const char* bytes);
+
+    uint32_t id() const {
+        return id_;
+    }
+
+    /*!
+     * @brief Getter for name
+     * @return name (not null terminated, see name_length)
+     */
+    const char* name() const {
+        return name_;
+    }
+
+    uint32_t name_length() const {
+        return name_length_;
+    }
+
+    /*!
+     * @brief Getter for sequence
+     * @return sequence (not null terminated, see length)
+     */
+    const char* sequence() const {
+        return sequence_;
+    }
+
+    uint32_t length() const {
+        return length_;
+    }
+
+    /*!
+     * @brief Getter for quality
+     * @details Binned qualities are decoded on access.
+     * @return quality
+     */
+    std::string quality() const;
+
+    double coverage() const;
+
+    /*!
+     * @brief Method for Read object creation
+     * @return new Read object which equals the stored read
+     */
+    Read* materialize() const;
+
+private:
+
+    const char* bytes_;
+    uint32_t id_;
+    const char* name_;
+    uint32_t name_length_;
+    const char* sequence_;
+    uint32_t length_;
+    const char* quality_;
+    uint32_t quality_length_;
+    bool quality_binned_;
+    const char* coverage_;
+};
+
+/*!
+ * @brief MappedOverlap class
+ * @details Read-only view of an overlap stored in a memory mapped depot,
+ * fields are read from the columns or from the serialized object (older
+ * depots) on access
+ */
+class MappedOverlap {
+public:
+
+    MappedOverlap(const char* bytes)
+            : bytes_(bytes), columns_(nullptr), index_(0) {
+    }
+
+    MappedOverlap(const OverlapColumns* columns, uint32_t index)
+            : bytes_(nullptr), columns_(columns), index_(index) {
+    }
+
+    uint32_t a() const {
+        return columns_ ? columns_->a[index_] : field<uint32_t>(kA);
+    }
+
+    uint32_t b() const {
+        return columns_ ? columns_->b[index_] : field<uint32_t>(kB);
+    }
+
+    int32_t a_hang() const {
+        return columns_ ? columns_->a_hang[index_] : field<int32_t>(kAHang);
+    }
+
+    int32_t b_hang() const {
+        return columns_ ? columns_->b_hang[index_] : field<int32_t>(kBHang);
+    }
+
+    bool is_innie() const {
+        return columns_ ? (columns_->flags[index_] & OverlapColumns::kInnie) != 0 :
+            field<bool>(kInnie);
+    }
+
+    bool is_dovetail() const {
+        return columns_ ? (columns_->flags[index_] & OverlapColumns::kDovetail) != 0 :
+            field<bool>(kDovetail);
+    }
+
+    uint32_t a_lo() const {
+        return columns_ ? columns_->a_lo[index_] : field<uint32_t>(kALo);
+    }
+
+    uint32_t a_hi() const {
+        return columns_ ? columns_->a_hi[index_] : field<uint32_t>(kAHi);
+    }
+
+    uint32_t b_lo() const {
+        return columns_ ? columns_->b_lo[index_] : field<uint32_t>(kBLo);
+    }
+
+    uint32_t b_hi() const {
+        return columns_ ? columns_->b_hi[index_] : field<uint32_t>(kBHi);
+    }
+
+    double err_rate() const {
+        return columns_ ? columns_->err_rate[index_] : field<double>(kErrRate);
+    }
+
+    double orig_err_rate() const {
+        return columns_ ? columns_->orig_err_rate[index_] : field<double>(kOrigErrRate);
+    }
+
+    uint32_t confirmations() const {
+        return columns_ ? columns_->confirmations[index_] : field<uint32_t>(kConfirmations);
+    }
+
+    /*!
+     * @brief Method for Overlap object creation
+     *
+     * @param [in] reads vector of Read objects indexed by identifiers
+     * @return new Overlap object which equals the stored overlap
+     */
+    Overlap* materialize(const ReadSet& reads) const;
+
+    /*!
+     * @brief Method for Overlap object reuse
+     * @details Overwrites dst with the stored overlap
+     *
+     * @param [out] dst Overlap object pointer
+     * @param [in] reads vector of Read objects indexed by identifiers
+     */
+    void materialize(Overlap* dst, const ReadSet& reads) const;
+
+private:
+
+    // offsets of fields as written by Overlap::serialize
+    static constexpr uint32_t kA = sizeof(DepotObjectType);
+    static constexpr uint32_t kAHang = kA + 4;
+    static constexpr uint32_t kB = kAHang + 4;
+    static constexpr uint32_t kBHang = kB + 4;
+    static constexpr uint32_t kInnie = kBHang + 4;
+    static constexpr uint32_t kDovetail = kInnie + sizeof(bool);
+    static constexpr uint32_t kALo = kDovetail + sizeof(bool);
+    static constexpr uint32_t kAHi = kALo + 4;
+    static constexpr uint32_t kBLo = kAHi + 4;
+    static constexpr uint32_t kBHi = kBLo + 4;
+    static constexpr uint32_t kErrRate = kBHi + 4;
+    static constexpr uint32_t kOrigErrRate = kErrRate + sizeof(double);
+    static constexpr uint32_t kConfirmations = kOrigErrRate + sizeof(double);
+
+    template<typename T>
+    T field(uint32_t offset) const {
+        T value;
+        std::memcpy(&value, bytes_ + offset, sizeof(T));
+        return value;
+    }
+
+    const char* bytes_;
+    const OverlapColumns* columns_;
+    uint32_t index_;
+};
+
+/*!
+ * @brief OverlapSegments class
+ * @details Memory mapped overlaps of a depot: the overlap data file (in
+ * either format) followed by the appended segment files and the deletion
+ * bitmap over the rows of all segments. Overlaps which are not removed are
+ * numbered in segment order and found with a rank table of the bitmap.
+ */
+class OverlapSegments {
+public:
+
+    /*!
+     * @brief OverlapSegments constructor
+     *
+     * @param [in] data overlap data file
+     * @param [in] index overlap index file (used by the older format)
+     * @param [in] segments appended segment files
+     * @param [in] tombstones deletion bitmap file (or nullptr)
+     * @param [in] adjacencies adjacency index file of each segment (or
+     * nullptr, the segment is scanned then)
+     * @param [in] zones zone map file of each segment (or nullptr, all
+     * overlaps of the segment are checked then)
+     */
+    OverlapSegments(FILE* data, FILE* index, const std::vector<FILE*>& segments,
+        FILE* tombstones, const std::vector<FILE*>& adjacencies,
+        const std::vector<FILE*>& zones);
+
+    ~OverlapSegments();
+
+    /*!
+     * @brief Getter for the number of overlaps which are not removed
+     */
+    uint32_t size() const {
+        return size_;
+    }
+
+    /*!
+     * @brief Getter for the number of rows of all segments
+     */
+    uint64_t rows_size() const {
+        return begins_.back();
+    }
+
+    /*!
+     * @brief Getter for removed rows
+     *
+     * @param [in] row row in all segments
+     * @return true if the overlap in row is removed
+     */
+    bool removed(uint64_t row) const;
+
+    /*!
+     * @brief Getter for the row of an overlap
+     *
+     * @param [in] index index of an overlap which is not removed
+     * @return row in all segments
+     */
+    uint64_t row(uint32_t index) const;
+
+    /*!
+     * @brief Getter for the overlap in a row
+     *
+     * @param [in] row row in all segments
+     * @return overlap view
+     */
+    MappedOverlap overlap_at(uint64_t row) const;
+
+    MappedOverlap overlap(uint32_t index) const {
+        return overlap_at(row(index));
+    }
+
+    /*!
+     * @brief Getter for the index of an overlap
+     *
+     * @param [in] row row in all segments which is not removed
+     * @return index of the overlap
+     */
+    uint32_t index(uint64_t row) const;
+
+    /*!
+     * @brief Method for overlap lookup by read
+     * @details Appends indices of overlaps which contain the read to dst in
+     * increasing order
+     *
+     * @param [in] id read identifier
+     * @param [out] dst vector of overlap indices
+     */
+    void read_overlaps(uint32_t id, std::vector<uint32_t>& dst) const;
+
+    /*!
+     * @brief Getter for mapped memory of overlaps
+     * @details Appends the ranges of mapped files which hold overlaps
+     * [begin, end) to dst (one range per column and segment).
+     *
+     * @param [in] begin index of the first overlap
+     * @param [in] end index after the last overlap
+     * @param [out] dst vector of ranges
+     */
+    void mapped_ranges(uint32_t begin, uint32_t end,
+        std::vector<std::pair<const char*, const char*>>& dst) const;
+
+    /*!
+     * @brief Getter for overlap columns
+     * @return overlap columns or nullptr if overlaps are not stored in a
+     * single segment in the fixed width format without removed overlaps
+     */
+    const OverlapColumns* columns() const;
+
+    /*!
+     * @brief Method for overlap selection
+     * @details Appends indices of overlaps which match the predicate to dst
+     * in increasing order (see Depot::select_overlaps)
+     *
+     * @param [in] predicate overlap predicate
+     * @param [in] reads vector of Read objects indexed by identifiers
+     * @param [out] dst vector of overlap indices
+     */
+    void select(const OverlapPredicate& predicate, const ReadSet& reads,
+        std::vector<uint32_t>& dst) const;
+
+    /*!
+     * @brief Getter for the zone of a row
+     *
+     * @param [in] row row in all segments
+     * @param [out] dst bounds of the zone holding the row
+     * @return false if the segment of the row has no zone map
+     */
+    bool zone(uint64_t row, OverlapZone& dst) const;
+
+private:
+
+    void select_rows(const OverlapPredicate& predicate, const ReadSet& reads,
+        uint64_t begin, uint64_t end, std::vector<uint32_t>& dst) const;
+
+    OverlapSegments(const OverlapSegments&) = delete;
+    const OverlapSegments& operator=(const OverlapSegments&) = delete;
+
+    std::vector<DepotMapping*> mappings_;
+    std::vector<OverlapColumns> columns_;
+    std::vector<bool> columnar_;
+    std::vector<DepotMapping*> adjacency_mappings_;
+    std::vector<OverlapAdjacency> adjacencies_;
+    std::vector<bool> indexed_;
+    std::vector<DepotMapping*> zone_mappings_;
+    std::vector<OverlapZones> zones_;
+    std::vector<bool> zoned_;
+    // first row of each segment and the number of all rows
+    std::vector<uint64_t> begins_;
+
+    const char* tombstones_;
+    size_t tombstones_length_;
+    // number of overlaps which are not removed before each bitmap word
+    std::vector<uint64_t> ranks_;
+    uint32_t size_;
+};
+
+/*!
+ * @brief MappedDepot class
+ * @details Read-only depot which memory maps the depot files and returns
+ * views of stored reads and overlaps instead of creating objects, so opening
+ * a depot costs (almost) nothing and pages are shared through the page cache
+ * between processes. Files are locked with a shared lock, so any number of
+ * MappedDepot objects can be opened while Depot objects (which need an
+ * exclusive lock) can not. Read blocks are decompressed once on first access.
+ * Views are valid while the MappedDepot exists.
+ */
+class MappedDepot {
+public:
+
+    /*!
+     * @brief MappedDepot constructor
+     *
+     * @param [in] path path to an existing depot folder
+     */
+    MappedDepot(const std::string& path);
+
+    /*!
+     * @brief MappedDepot destructor
+     */
+    ~MappedDepot();
+
+    uint32_t reads_size() const {
+        return reads_->size();
+    }
+
+    uint32_t overlaps_size() const {
+        return overlaps_->size();
+    }
+
+    MappedRead read(uint32_t index) const;
+
+    MappedOverlap overlap(uint32_t index) const {
+        return overlaps_->overlap(index);
+    }
+
+    /*!
+     * @brief Getter for overlap columns
+     * @return overlap columns or nullptr if overlaps are stored in the older
+     * format, in several segments or some are removed
+     */
+    const OverlapColumns* overlap_columns() const {
+        return overlaps_->columns();
+    }
+
+    /*!
+     * @brief Method for overlap lookup by read
+     * @details Appends indices of overlaps which contain the read to dst in
+     * increasing order
+     *
+     * @param [in] id read identifier
+     * @param [out] dst vector of overlap indices
+     */
+    void read_overlaps(uint32_t id, std::vector<uint32_t>& dst) const {
+        overlaps_->read_overlaps(id, dst);
+    }
+
+private:
+
+    MappedDepot(const MappedDepot&) = delete;
+    const MappedDepot& operator=(const MappedDepot&) = delete;
+
+    FILE* read_data_;
+    FILE* read_index_;
+    FILE* overlap_data_;
+    FILE* overlap_index_;
+    FILE* overlap_tombstones_;
+    std::vector<FILE*> overlap_segments_;
+    std::vector<FILE*> overlap_adjacencies_;
+    std::vector<FILE*> overlap_zones_;
+
+    DepotMapping* reads_;
+    OverlapSegments* overlaps_;
+
+    std::unique_ptr<ReadBlock[]> read_blocks_;
+    std::unique_ptr<std::once_flag[]> read_block_flags_;
+};
+
+/*!
+ * @brief DepotShard struct
+ * @details Manifest entry of one shard of a ShardedDepot
+ */
+struct DepotShard {
+    // identifiers of reads owned by the shard are in [reads_begin, reads_end)
+    uint64_t reads_begin;
+    uint64_t reads_end;
+    // reads of other shards which share an overlap with a read of the shard
+    uint64_t boundary_reads;
+    uint64_t overlaps;
+    // overlaps which contain a read of another shard
+    uint64_t boundary_overlaps;
+};
+
+/*!
+ * @brief ShardedDepot class
+ * @details Reads and overlaps partitioned by read identifier ranges into
+ * shards, each of them a Depot in the folder shard_<k>, so that shards
+ * can be loaded and updated by separate processes (or machines) without
+ * touching each other. A shard holds its own reads followed by its
+ * boundary reads and all overlaps which contain one of its own reads in
+ * their original order; boundary overlaps (between reads of two shards)
+ * are therefore stored in both shards, the shard of the smaller read
+ * identifier is their owner (see owner). Only the owner may remove a
+ * boundary overlap (see remove_overlaps), the copy in the other shard is
+ * dropped by reconcile once no shard is updated anymore. The manifest
+ * file shard_manifest.bin holds
+ * kMagic, kVersion, the number of shards and reads followed by a
+ * DepotShard for each shard.
+ */
+class ShardedDepot {
+public:
+
+    static const uint32_t kMagic = 0x48534152; // "RASH"
+    static const uint32_t kVersion = 1;
+
+    /*!
+     * @brief ShardedDepot constructor
+     * @details Reads the manifest of the sharded depot if it exists, shards
+     * are opened (and locked) on first use
+     *
+     * @param [in] path path to a folder
+     * @param [in] read_only true if shards are only read (the sharded
+     * depot has to exist then)
+     */
+    ShardedDepot(const std::string& path, bool read_only = false);
+
+    /*!
+     * @brief ShardedDepot destructor
+     */
+    ~ShardedDepot();
+
+    /*!
+     * @brief Method for storing reads and overlaps in shards
+     * @details Splits read identifiers into shards_size ranges with about
+     * the same number of bases and stores each shard and the manifest
+     *
+     * @param [in] reads set of Read object pointers (each read at the index
+     * of its identifier)
+     * @param [in] overlaps set of Overlap object pointers
+     * @param [in] shards_size number of shards
+     */
+    void store(const ReadSet& reads, const OverlapSet& overlaps, uint32_t shards_size);
+
+    /*!
+     * @brief Method for loading a shard
+     * @details Loads reads and boundary reads of the shard into dst_reads
+     * at the index of their identifier (other reads are set to nullptr)
+     * and all overlaps of the shard, overlap indices are the ones of
+     * shard(index)
+     *
+     * @param [in] index index of the shard
+     * @param [out] dst_reads set of Read object pointers
+     * @param [out] dst_overlaps set of Overlap object pointers
+     */
+    void load_shard(uint32_t index, ReadSet& dst_reads, OverlapSet& dst_overlaps);
+
+    /*!
+     * @brief Getter for the depot of a shard
+     * @details Opens the depot of the shard on first call, overlaps loaded
+     * with load_shard should be removed with remove_overlaps so that
+     * boundary overlaps are only removed by their owner
+     *
+     * @param [in] index index of the shard
+     * @return Depot object of the shard
+     */
+    Depot& shard(uint32_t index);
+
+    /*!
+     * @brief Method for shard lookup
+     *
+     * @param [in] id read identifier
+     * @return index of the shard which owns the read
+     */
+    uint32_t shard_of(uint32_t id) const;
+
+    /*!
+     * @brief Method for overlap ownership lookup
+     *
+     * @param [in] overlap Overlap object
+     * @return index of the shard which owns the overlap (the shard of its
+     * smaller read identifier)
+     */
+    uint32_t owner(const Overlap& overlap) const;
+
+    bool owns(uint32_t index, const Overlap& overlap) const {
+        return owner(overlap) == index;
+    }
+
+    /*!
+     * @brief Method for overlap removal
+     * @details Marks overlaps of a shard as removed, all of them have to be
+     * owned by the shard; copies of removed boundary overlaps in other
+     * shards are kept until reconcile
+     *
+     * @param [in] index index of the shard
+     * @param [in] loaded set of all overlaps as loaded by load_shard
+     * @param [in] indices indices of overlaps in loaded
+     */
+    void remove_overlaps(uint32_t index, const OverlapSet& loaded,
+        const std::vector<uint32_t>& indices);
+
+    /*!
+     * @brief Method for boundary overlap reconciliation
+     * @details Removes copies of boundary overlaps which were removed by
+     * their owner from the other shard, shards must not be updated by other
+     * processes meanwhile. Memory of the loaded shards is returned to the
+     * system afterwards (see releasePool).
+     *
+     * @return number of removed copies
+     */
+    uint64_t reconcile();
+
+    uint32_t size() const {
+        return shards_.size();
+    }
+
+    uint32_t reads_size() const {
+        return reads_size_;
+    }
+
+    const DepotShard& manifest(uint32_t index) const {
+        return shards_[index];
+    }
+
+private:
+
+    ShardedDepot(const ShardedDepot&) = delete;
+    const ShardedDepot& operator=(const ShardedDepot&) = delete;
+
+    void close_shards();
+
+    std::string path_;
+    bool read_only_;
+
+    uint64_t reads_size_;
+    std::vector<DepotShard> shards_;
+    std::vector<Depot*> depots_;
 };
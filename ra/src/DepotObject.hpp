@@ -10,6 +10,7 @@
 #pragma once
 
 #include "CommonHeaders.hpp"
+#include "ObjectPool.hpp"
 
 enum class DepotObjectType {
     kRead,
@@ -19,6 +20,8 @@ enum class DepotObjectType {
 
 /*!
  * @brief DepotObject class
+ * @details Reads and overlaps are allocated from an object pool (see
+ * ObjectPool.hpp) as they are created and deleted one by one in large numbers.
  */
 class DepotObject {
 public:
@@ -28,6 +31,14 @@ public:
      */
     virtual ~DepotObject() {};
 
+    static void* operator new(size_t size) {
+        return poolAllocate(size);
+    }
+
+    static void operator delete(void* ptr, size_t size) {
+        poolDeallocate(ptr, size);
+    }
+
     /*!
      * @brief Method for object serialization
      * @details Serializes the object to a char array
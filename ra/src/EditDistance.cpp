@@ -8,56 +8,18 @@
  */
 
 #include "EditDistance.hpp"
+#include "NucleotideCodec.hpp"
 
 #include "../vendor/edlib/edlib.h"
 
-static unsigned char toUnsignedChar(char c) {
-
-    unsigned char r;
-
-    switch(c) {
-        case 'A':
-            r = 0;
-            break;
-        case 'T':
-            r = 1;
-            break;
-        case 'G':
-            r = 2;
-            break;
-        case 'C':
-            r = 3;
-            break;
-        default:
-            r = 4;
-            break;
-    }
-
-    return r;
-}
-
-extern int editDistance(const std::string& queryStr, const std::string& targetStr) {
+// edlib codes for A, C, G, T and any other symbol
+static const unsigned char kEdlibCodes[] = { 0, 3, 2, 1, 4 };
 
-    if (queryStr.size() == 0) return targetStr.size();
-    if (targetStr.size() == 0) return queryStr.size();
-
-    unsigned char* query = new unsigned char[queryStr.size()];
-    int queryLength = queryStr.size();
-
-    for (int i = 0; i < queryLength; ++i) {
-        query[i] = toUnsignedChar(queryStr[i]);
-    }
-
-    unsigned char* target = new unsigned char[targetStr.size()];
-    int targetLength = targetStr.size();
-
-    for (int i = 0; i < targetLength; ++i) {
-        target[i] = toUnsignedChar(targetStr[i]);
-    }
+static int32_t calculateEditDistance(const unsigned char* query, int queryLength,
+    const unsigned char* target, int targetLength, int mode, int* query_best_end) {
 
     int alphabetLength = 5;
     int k = -1;
-    int mode = EDLIB_MODE_NW;
     bool findStartLocations = false;
     bool findAlignment = false;
     int score = 0;
@@ -71,57 +33,79 @@ extern int editDistance(const std::string& queryStr, const std::string& targetSt
         k, mode, findStartLocations, findAlignment, &score, &endLocations,
         &startLocations, &numLocations, &alignemnt, &alignmentLength);
 
+    if (query_best_end != nullptr) {
+        assert(numLocations > 0);
+        *query_best_end = endLocations[0] + 1; // we like [lo, hi>
+    }
+
     free(alignemnt);
     free(startLocations);
     free(endLocations);
 
+    return score;
+}
+
+extern int editDistance(const std::string& queryStr, const std::string& targetStr) {
+
+    if (queryStr.size() == 0) return targetStr.size();
+    if (targetStr.size() == 0) return queryStr.size();
+
+    unsigned char* query = new unsigned char[queryStr.size()];
+    int queryLength = queryStr.size();
+
+    encodeSequence(query, queryStr.data(), queryLength, kEdlibCodes);
+
+    unsigned char* target = new unsigned char[targetStr.size()];
+    int targetLength = targetStr.size();
+
+    encodeSequence(target, targetStr.data(), targetLength, kEdlibCodes);
+
+    int score = calculateEditDistance(query, queryLength, target, targetLength,
+        EDLIB_MODE_NW, nullptr);
+
     delete[] target;
     delete[] query;
 
     return score;
 }
 
-extern int32_t editDistanceSHW(const std::string& queryStr, int query_lo, const std::string& targetStr, int target_lo, int* query_best_end) {
-    int queryLength = queryStr.size() - query_lo;
-    int targetLength = targetStr.size() - target_lo;
+extern int32_t editDistance(const SequenceView& queryView, const SequenceView& targetView) {
 
-    if (queryLength == 0) return 0;
-    if (targetLength == 0) return queryLength;
+    if (queryView.length() == 0) return targetView.length();
+    if (targetView.length() == 0) return queryView.length();
 
+    int queryLength = queryView.length();
     unsigned char* query = new unsigned char[queryLength];
+    queryView.encode(query, kEdlibCodes);
 
-    for (int i = 0; i < queryLength; ++i) {
-        query[i] = toUnsignedChar(queryStr[i + query_lo]);
-    }
-
+    int targetLength = targetView.length();
     unsigned char* target = new unsigned char[targetLength];
+    targetView.encode(target, kEdlibCodes);
 
-    for (int i = 0; i < targetLength; ++i) {
-        target[i] = toUnsignedChar(targetStr[i + target_lo]);
-    }
+    int score = calculateEditDistance(query, queryLength, target, targetLength,
+        EDLIB_MODE_NW, nullptr);
 
-    int alphabetLength = 5;
-    int k = -1;
-    int mode = EDLIB_MODE_SHW;
-    bool findStartLocations = false;
-    bool findAlignment = false;
-    int score = 0;
-    int* endLocations = nullptr; // dummy
-    int* startLocations = nullptr; // dummy
-    int numLocations = 0; // dummy;
-    unsigned char* alignemnt = nullptr; // dummy
-    int alignmentLength = 0; // dummy;
+    delete[] target;
+    delete[] query;
 
-    edlibCalcEditDistance(query, queryLength, target, targetLength, alphabetLength,
-        k, mode, findStartLocations, findAlignment, &score, &endLocations,
-        &startLocations, &numLocations, &alignemnt, &alignmentLength);
+    return score;
+}
 
-    assert(numLocations > 0);
-    *query_best_end = endLocations[0] + 1; // we like [lo, hi>
+extern int32_t editDistanceSHW(const SequenceView& queryView, int query_lo, const SequenceView& targetView, int target_lo, int* query_best_end) {
+    int queryLength = queryView.length() - query_lo;
+    int targetLength = targetView.length() - target_lo;
 
-    free(alignemnt);
-    free(startLocations);
-    free(endLocations);
+    if (queryLength == 0) return 0;
+    if (targetLength == 0) return queryLength;
+
+    unsigned char* query = new unsigned char[queryLength];
+    queryView.subview(query_lo).encode(query, kEdlibCodes);
+
+    unsigned char* target = new unsigned char[targetLength];
+    targetView.subview(target_lo).encode(target, kEdlibCodes);
+
+    int score = calculateEditDistance(query, queryLength, target, targetLength,
+        EDLIB_MODE_SHW, query_best_end);
 
     delete[] target;
     delete[] query;
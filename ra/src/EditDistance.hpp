@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "PackedSequence.hpp"
 #include "CommonHeaders.hpp"
 
 /*!
@@ -22,4 +23,27 @@
  */
 extern int32_t editDistance(const std::string& query, const std::string& target);
 
-extern int32_t editDistanceSHW(const std::string& query, int query_lo, const std::string& target, int target_lo, int* query_best_end);
+/*!
+ * @brief Edit distance wrapper
+ * @details Method returns the edit distance between two sequence views.
+ * Bases are encoded straight from the packed representation.
+ *
+ * @param [in] query sequence view
+ * @param [in] target sequence view
+ * @return edit distance
+ */
+extern int32_t editDistance(const SequenceView& query, const SequenceView& target);
+
+/*!
+ * @brief Semi-global edit distance wrapper
+ * @details Method returns the edit distance between query[query_lo..] and
+ * target[target_lo..] where gaps at query end are not penalised.
+ *
+ * @param [in] query sequence view
+ * @param [in] query_lo query start position
+ * @param [in] target sequence view
+ * @param [in] target_lo target start position
+ * @param [out] query_best_end end position of the best alignment ([lo, hi>)
+ * @return edit distance
+ */
+extern int32_t editDistanceSHW(const SequenceView& query, int query_lo, const SequenceView& target, int target_lo, int* query_best_end);
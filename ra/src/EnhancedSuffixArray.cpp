@@ -14,57 +14,251 @@
 
 #define MAX_SIZE 2147483645U
 
-static int getChar(int i, const unsigned char* s, int csize) {
-    if (csize == sizeof(int)) return ((int*) s)[i];
-    return ((unsigned char*) s)[i];
-}
+// serialized 64-bit arrays start with this instead of a 32-bit length
+#define WIDE_MARKER -1
+
+// suffix array entries whose preceding characters are looked up in parallel at once
+#define INDUCE_BLOCK_SIZE 1048576
+
+template<typename I, typename F>
+static void parallelFor(I length, int threadLen, F function) {
 
-static void getBuckets(std::vector<int>& buckets, const unsigned char* s, int n, int csize, int end) {
+    threadLen = std::max<I>(1, std::min<I>(threadLen, length));
 
-    for (int i = 0; i < (int) buckets.size(); ++i) {
-        buckets[i] = 0;
+    if (threadLen == 1) {
+        function(0, length);
+        return;
     }
 
-    for (int i = 0; i < n; ++i) {
-        ++buckets[getChar(i, s, csize)];
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadLen; ++i) {
+        threads.emplace_back(function, (I) ((int64_t) length * i / threadLen),
+            (I) ((int64_t) length * (i + 1) / threadLen));
     }
 
-    int sum = 0;
-    for (int i = 0; i < (int) buckets.size(); ++i) {
-        sum += buckets[i];
-        buckets[i] = (end == 1) ? sum : sum - buckets[i];
+    for (auto& it : threads) {
+        it.join();
     }
 }
 
-static void induceL(std::vector<int>& suftab, std::vector<int>& buckets, const unsigned char* s, int n,
-    int csize, std::vector<bool>& t) {
+template<typename C, typename I>
+static void countChars(std::vector<I>& counts, const C* s, I n, int threadLen) {
+
+    std::fill(counts.begin(), counts.end(), 0);
+
+    // histograms per thread pay off only for small alphabets
+    if (threadLen == 1 || (int64_t) counts.size() * threadLen > n) {
+        for (I i = 0; i < n; ++i) {
+            ++counts[s[i]];
+        }
+        return;
+    }
+
+    std::vector<std::vector<I>> partial(threadLen);
+
+    parallelFor(threadLen, threadLen, [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            partial[k].resize(counts.size(), 0);
+
+            I e = (int64_t) n * (k + 1) / threadLen;
+            for (I i = (int64_t) n * k / threadLen; i < e; ++i) {
+                ++partial[k][s[i]];
+            }
+        }
+    });
+
+    for (const auto& it : partial) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += it[i];
+        }
+    }
+}
 
-    getBuckets(buckets, s, n, csize, 0);
+template<typename I>
+static void getBuckets(std::vector<I>& buckets, const std::vector<I>& counts, int end) {
 
-    for (int i = 0; i < n; ++i) {
-        int j = suftab[i] - 1;
-        if (j >= 0 && !t[j]) suftab[buckets[getChar(j, s, csize)]++] = j;
+    I sum = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        sum += counts[i];
+        buckets[i] = (end == 1) ? sum : sum - counts[i];
     }
 }
 
-static void induceS(std::vector<int>& suftab, std::vector<int>& buckets, const unsigned char* s, int n,
-    int csize, std::vector<bool>& t) {
+// returns the character preceding the suffix if the preceding suffix is of the given type
+template<typename C, typename I>
+static I precedingChar(I suffix, const C* s, const std::vector<bool>& t, bool type) {
+    return (suffix > 0 && t[suffix - 1] == type) ? (I) s[suffix - 1] : -1;
+}
 
-    getBuckets(buckets, s, n, csize, 1);
+// The sequential scan of induced sorting spends most of its time on random
+// accesses to characters and types preceding the scanned suffixes. They are
+// looked up in parallel for a block of entries ahead of the scan, entries
+// which the scan changes inside the block are looked up again.
+template<typename C, typename I>
+static void induce(I* suftab, std::vector<I>& buckets, const C* s, I n,
+    const std::vector<bool>& t, bool type, int threadLen) {
+
+    auto induceSuffix = [&](I i, I c) {
+        if (c == -1) return;
+        if (type) {
+            suftab[--buckets[c]] = suftab[i] - 1;
+        } else {
+            suftab[buckets[c]++] = suftab[i] - 1;
+        }
+    };
 
-    for (int i = n - 1; i >= 0; --i) {
-        int j = suftab[i] - 1;
-        if (j >= 0 && t[j]) suftab[--buckets[getChar(j, s, csize)]] = j;
+    if (threadLen == 1) {
+        if (type) {
+            for (I i = n - 1; i >= 0; --i) induceSuffix(i, precedingChar(suftab[i], s, t, type));
+        } else {
+            for (I i = 0; i < n; ++i) induceSuffix(i, precedingChar(suftab[i], s, t, type));
+        }
+        return;
+    }
+
+    I blockSize = std::min<I>(n, INDUCE_BLOCK_SIZE);
+    std::vector<I> suffixes(blockSize), chars(blockSize);
+
+    for (I b = 0; b < n; b += blockSize) {
+
+        I begin = type ? std::max<I>(0, n - b - blockSize) : b;
+        I end = type ? n - b : std::min(n, b + blockSize);
+
+        parallelFor(end - begin, threadLen, [&](I lo, I hi) {
+            for (I i = lo; i < hi; ++i) {
+                suffixes[i] = suftab[begin + i];
+                chars[i] = precedingChar(suffixes[i], s, t, type);
+            }
+        });
+
+        auto charAt = [&](I i) {
+            return suftab[i] == suffixes[i - begin] ? chars[i - begin] :
+                precedingChar(suftab[i], s, t, type);
+        };
+
+        if (type) {
+            for (I i = end - 1; i >= begin; --i) induceSuffix(i, charAt(i));
+        } else {
+            for (I i = begin; i < end; ++i) induceSuffix(i, charAt(i));
+        }
     }
 }
 
-static bool isLMS(int i, std::vector<bool>& t) {
+template<typename I>
+static bool isLMS(I i, std::vector<bool>& t) {
     return i > 0 && t[i] && !t[i - 1];
 }
 
-EnhancedSuffixArray::EnhancedSuffixArray(const std::string& str) {
+// SA-IS algorithm which is based on induced sorting (article [1], complexity: O(n)),
+// characters are of type C so their width is known at compile time
+template<typename C, typename I>
+void createSuffixArray(I* suftab, const C* s, I n, I alphabetSize, int threadLen) {
+
+    // S-type = true, L-type = false
+    std::vector<bool> t(n);
+    t[n - 1] = true;
+    t[n - 2] = false;
+
+    for (I i = n - 3; i >= 0; --i) {
+        t[i] = (s[i] < s[i + 1] || (s[i] == s[i + 1] && t[i + 1])) ? true : false;
+    }
+
+    std::vector<I> counts(alphabetSize);
+    countChars(counts, s, n, threadLen);
+
+    std::vector<I> buckets(alphabetSize);
+    getBuckets(buckets, counts, 1);
+
+    for (I i = 0; i < n; ++i) suftab[i] = -1;
+    for (I i = 1; i < n; ++i) {
+        if (isLMS(i, t)) suftab[--buckets[s[i]]] = i;
+    }
+
+    getBuckets(buckets, counts, 0);
+    induce(suftab, buckets, s, n, t, false, threadLen);
+    getBuckets(buckets, counts, 1);
+    induce(suftab, buckets, s, n, t, true, threadLen);
+
+    std::vector<I>().swap(counts);
+    std::vector<I>().swap(buckets);
+
+    I n1 = 0;
+    for (I i = 0; i < n; ++i) {
+        if (isLMS(suftab[i], t)) suftab[n1++] = suftab[i];
+    }
+
+    for (I i = n1; i < n; ++i) suftab[i] = -1;
+
+    I name = 0, prev = -1;
+    for (I i = 0; i < n1; ++i) {
+
+        I pos = suftab[i];
+        bool diff = false;
+
+        for (I d = 0; d < n; ++d) {
+            if (prev == -1 || s[pos + d] != s[prev + d] || t[pos + d] != t[prev + d]) {
+
+                diff = true;
+                break;
+
+            } else if (d > 0 && (isLMS(pos + d, t) || isLMS(prev + d, t))) {
+                break;
+            }
+        }
+
+        if (diff) {
+            ++name;
+            prev = pos;
+        }
+
+        pos = (pos % 2 == 0) ? pos / 2 : (pos - 1) / 2;
+        suftab[n1 + pos] = name - 1;
+    }
+
+    for (I i = n - 1, j = n - 1; i >= n1; --i) {
+        if (suftab[i] >= 0) suftab[j--] = suftab[i];
+    }
+
+    I* s1 = &suftab[n - n1];
+
+    if (name < n1) {
+        createSuffixArray(suftab, (const I*) s1, n1, name, threadLen);
+    } else {
+        for (I i = 0; i < n1; ++i) suftab[s1[i]] = i;
+    }
+
+    counts.resize(alphabetSize);
+    buckets.resize(alphabetSize);
+
+    for (I i = 1, j = 0; i < n; ++i) {
+        if (isLMS(i, t)) s1[j++] = i;
+    }
+
+    countChars(counts, s, n, threadLen);
+    getBuckets(buckets, counts, 1);
+
+    for (I i = 0; i < n1; ++i) suftab[i] = s1[suftab[i]];
+    for (I i = n1; i < n; ++i) suftab[i] = -1;
+
+    for (I i = n1 - 1; i >= 0; --i) {
+        I j = suftab[i];
+        suftab[i] = -1;
+        suftab[--buckets[s[j]]] = j;
+    }
+
+    getBuckets(buckets, counts, 0);
+    induce(suftab, buckets, s, n, t, false, threadLen);
+    getBuckets(buckets, counts, 1);
+    induce(suftab, buckets, s, n, t, true, threadLen);
+}
+
+template<typename I>
+EnhancedSuffixArray<I>::EnhancedSuffixArray(const std::string& str, int threadLen) {
 
-    ASSERT(str.size() <= MAX_SIZE, "ESA", "invalid input string length");
+    ASSERT(sizeof(I) > sizeof(int32_t) || str.size() <= MAX_SIZE, "ESA",
+        "invalid input string length");
+    ASSERT(threadLen > 0, "ESA", "invalid thread number");
 
     Timer timer;
     timer.start();
@@ -76,15 +270,17 @@ EnhancedSuffixArray::EnhancedSuffixArray(const std::string& str) {
     n_ = str_.size();
     suftab_.resize(n_);
 
-    createSuffixArray((unsigned char*) &str_[0], n_, sizeof(unsigned char));
-    createLongestCommonPrefixTable();
+    createSuffixArray<unsigned char, I>(suftab_.data(), (const unsigned char*) &str_[0], n_,
+        256, threadLen);
+    createLongestCommonPrefixTable(threadLen);
     createChildTable();
 
     timer.stop();
     timer.print("ESA", "construction");
 }
 
-void EnhancedSuffixArray::intervalSubInterval(int* s, int* e, int i, int j, char c) const {
+template<typename I>
+void EnhancedSuffixArray<I>::intervalSubInterval(I* s, I* e, I i, I j, char c) const {
 
     if (i > j) {
         *s = -1;
@@ -92,7 +288,7 @@ void EnhancedSuffixArray::intervalSubInterval(int* s, int* e, int i, int j, char
         return;
     }
 
-    int i1 = (i < childtab_[i] && childtab_[i] <= j) ? childtab_[i] : childtab_[j];
+    I i1 = (i < childtab_[i] && childtab_[i] <= j) ? childtab_[i] : childtab_[j];
 
     if (str_[suftab_[i] + lcptab_[i1]] == c) {
         *s = i; *e = i1 - 1;
@@ -101,7 +297,7 @@ void EnhancedSuffixArray::intervalSubInterval(int* s, int* e, int i, int j, char
 
     // .nextlIndex if not .down nor .up
     while (childtab_[i1] != -1 && i1 < n_ && !(lcptab_[childtab_[i1]] > lcptab_[i1] || lcptab_[i1] > lcptab_[i1 + 1])) {
-        int i2 = childtab_[i1];
+        I i2 = childtab_[i1];
         if (str_[suftab_[i1] + lcptab_[i2]] == c) {
             *s = i1; *e = i2 - 1;
             return;
@@ -118,16 +314,18 @@ void EnhancedSuffixArray::intervalSubInterval(int* s, int* e, int i, int j, char
     *e = -1;
 }
 
-int EnhancedSuffixArray::intervalLcpLen(int i, int j) const {
+template<typename I>
+I EnhancedSuffixArray<I>::intervalLcpLen(I i, I j) const {
     return lcptab_[childtab_[(i < childtab_[i] && childtab_[i] <= j) ? i : j]];
 }
 
-size_t EnhancedSuffixArray::sizeInBytes() const {
+template<typename I>
+size_t EnhancedSuffixArray<I>::sizeInBytes() const {
 
     size_t bytesLen = 0;
-    size_t size = sizeof(int);
+    size_t size = sizeof(I);
 
-    bytesLen += size; // n_
+    bytesLen += sizeof(I) == sizeof(int32_t) ? size : sizeof(int32_t) + size; // n_
     bytesLen += n_; // str_
     bytesLen += (size_t) n_ * size; // suftab_
     bytesLen += (size_t) n_ * size; // lcptab_
@@ -136,14 +334,21 @@ size_t EnhancedSuffixArray::sizeInBytes() const {
     return bytesLen;
 }
 
-void EnhancedSuffixArray::serialize(char** bytes, size_t* bytesLen) const {
+template<typename I>
+void EnhancedSuffixArray<I>::serialize(char** bytes, size_t* bytesLen) const {
 
     *bytesLen = sizeInBytes();
     *bytes = new char[*bytesLen];
 
-    size_t size = sizeof(int);
+    size_t size = sizeof(I);
     size_t ptr = 0;
 
+    if (sizeof(I) != sizeof(int32_t)) {
+        int32_t marker = WIDE_MARKER;
+        std::memcpy(*bytes + ptr, &marker, sizeof(int32_t));
+        ptr += sizeof(int32_t);
+    }
+
     std::memcpy(*bytes+ ptr, &n_, size);
     ptr += size;
 
@@ -159,12 +364,16 @@ void EnhancedSuffixArray::serialize(char** bytes, size_t* bytesLen) const {
     std::memcpy(*bytes + ptr, &childtab_[0], n_ * size);
 }
 
-EnhancedSuffixArray* EnhancedSuffixArray::deserialize(const char* bytes) {
+template<typename I>
+EnhancedSuffixArray<I>* EnhancedSuffixArray<I>::deserialize(const char* bytes) {
+
+    ASSERT(isWideEnhancedSuffixArray(bytes) == (sizeof(I) != sizeof(int32_t)), "ESA",
+        "invalid index width of serialized object");
 
     EnhancedSuffixArray* esa = new EnhancedSuffixArray();
 
-    size_t size = sizeof(int);
-    size_t ptr = 0;
+    size_t size = sizeof(I);
+    size_t ptr = sizeof(I) == sizeof(int32_t) ? 0 : sizeof(int32_t);
 
     std::memcpy(&esa->n_, bytes + ptr, size);
     ptr += size;
@@ -188,140 +397,66 @@ EnhancedSuffixArray* EnhancedSuffixArray::deserialize(const char* bytes) {
     return esa;
 }
 
-void EnhancedSuffixArray::print() const {
+bool isWideEnhancedSuffixArray(const char* bytes) {
 
-    printf("  Idx Suftab LcpTab ChildTab Suffix\n");
+    int32_t marker;
+    std::memcpy(&marker, bytes, sizeof(int32_t));
 
-    for (int i = 0; i < n_; ++i) {
-        printf("%5d %6d %6d %8d %-s\n", i, suftab_[i], lcptab_[i], childtab_[i],
-            str_.substr(suftab_[i], n_ - suftab_[i]).c_str());
-    }
+    return marker == WIDE_MARKER;
 }
 
-void EnhancedSuffixArray::createSuffixArray(const unsigned char* s, int n, int csize, int alphabetSize) {
-
-    // S-type = true, L-type = false
-    std::vector<bool> t(n);
-    t[n - 1] = true;
-    t[n - 2] = false;
-
-    for (int i = n - 3; i >= 0; --i) {
-        t[i] = (getChar(i, s, csize) < getChar(i + 1, s, csize) ||
-            (getChar(i, s, csize) == getChar(i + 1, s, csize) && t[i + 1])) ? true : false;
-    }
-
-    std::vector<int> buckets(alphabetSize);
-    getBuckets(buckets, s, n, csize, 1);
-
-    for (int i = 0; i < n; ++i) suftab_[i] = -1;
-    for (int i = 1; i < n; ++i) {
-        if (isLMS(i, t)) suftab_[--buckets[getChar(i, s, csize)]] = i;
-    }
-
-    induceL(suftab_, buckets, s, n, csize, t);
-    induceS(suftab_, buckets, s, n, csize, t);
-
-    std::vector<int>().swap(buckets);
-
-    int n1 = 0;
-    for (int i = 0; i < n; ++i) {
-        if (isLMS(suftab_[i], t)) suftab_[n1++] = suftab_[i];
-    }
-
-    for (int i = n1; i < n; ++i) suftab_[i] = -1;
-
-    int name = 0, prev = -1;
-    for (int i = 0; i < n1; ++i) {
-
-        int pos = suftab_[i];
-        bool diff = false;
-
-        for (int d = 0; d < n; ++d) {
-            if (prev == -1 || getChar(pos + d, s, csize) != getChar(prev + d, s, csize) ||
-                t[pos + d] != t[prev + d]) {
+template<typename I>
+void EnhancedSuffixArray<I>::print() const {
 
-                diff = true;
-                break;
-
-            } else if (d > 0 && (isLMS(pos + d, t) || isLMS(prev + d, t))) {
-                break;
-            }
-        }
-
-        if (diff) {
-            ++name;
-            prev = pos;
-        }
-
-        pos = (pos % 2 == 0) ? pos / 2 : (pos - 1) / 2;
-        suftab_[n1 + pos] = name - 1;
-    }
-
-    for (int i = n - 1, j = n - 1; i >= n1; --i) {
-        if (suftab_[i] >= 0) suftab_[j--] = suftab_[i];
-    }
-
-    int* s1 = &suftab_[n - n1];
-
-    if (name < n1) {
-        createSuffixArray((unsigned char*) s1, n1, sizeof(int), name);
-    } else {
-        for (int i = 0; i < n1; ++i) suftab_[s1[i]] = i;
-    }
-
-    buckets.resize(alphabetSize);
-
-    for (int i = 1, j = 0; i < n; ++i) {
-        if (isLMS(i, t)) s1[j++] = i;
-    }
-
-    getBuckets(buckets, s, n, csize, 1);
-
-    for (int i = 0; i < n1; ++i) suftab_[i] = s1[suftab_[i]];
-    for (int i = n1; i < n; ++i) suftab_[i] = -1;
+    printf("  Idx Suftab LcpTab ChildTab Suffix\n");
 
-    for (int i = n1 - 1; i >= 0; --i) {
-        int j = suftab_[i];
-        suftab_[i] = -1;
-        suftab_[--buckets[getChar(j, s, csize)]] = j;
+    for (I i = 0; i < n_; ++i) {
+        printf("%5lld %6lld %6lld %8lld %-s\n", (long long) i, (long long) suftab_[i],
+            (long long) lcptab_[i], (long long) childtab_[i],
+            str_.substr(suftab_[i], n_ - suftab_[i]).c_str());
     }
-
-    induceL(suftab_, buckets, s, n, csize, t);
-    induceS(suftab_, buckets, s, n, csize, t);
 }
 
-void EnhancedSuffixArray::createLongestCommonPrefixTable() {
+template<typename I>
+void EnhancedSuffixArray<I>::createLongestCommonPrefixTable(int threadLen) {
 
     lcptab_.resize(n_, 0);
 
-    std::vector<int> rank(n_);
-    for (int i = 0; i < n_; ++i) rank[suftab_[i]] = i;
+    std::vector<I> rank(n_);
+    parallelFor(n_, threadLen, [&](I begin, I end) {
+        for (I i = begin; i < end; ++i) rank[suftab_[i]] = i;
+    });
+
+    // each range of text positions starts with h = 0, so ranges are independent
+    parallelFor(n_, threadLen, [&](I begin, I end) {
 
-    int h = 0;
+        I h = 0;
 
-    for (int i = 0; i < n_; ++i) {
-        if (rank[i] > 0) {
-            int j = suftab_[rank[i] - 1];
+        for (I i = begin; i < end; ++i) {
+            if (rank[i] > 0) {
+                I j = suftab_[rank[i] - 1];
 
-            while (str_[i + h] == str_[j + h]) ++h;
+                while (str_[i + h] == str_[j + h]) ++h;
 
-            lcptab_[rank[i]] = h;
-            if (h > 0) --h;
+                lcptab_[rank[i]] = h;
+                if (h > 0) --h;
+            }
         }
-    }
+    });
 }
 
-void EnhancedSuffixArray::createChildTable() {
+template<typename I>
+void EnhancedSuffixArray<I>::createChildTable() {
 
     childtab_.resize(n_, -1);
 
-    // childTable = .up + .down + .nextlIndex (which can be stored in 4B)
+    // childTable = .up + .down + .nextlIndex (which can be stored in one index)
     // 1. Construction of .up and .down
-    std::stack<int> st;
-    int lastIndex = -1;
+    std::stack<I> st;
+    I lastIndex = -1;
 
     st.push(0);
-    for (int i = 1; i < n_; ++i) {
+    for (I i = 1; i < n_; ++i) {
         while (lcptab_[i] < lcptab_[st.top()]) {
             lastIndex = st.top();
             st.pop();
@@ -341,10 +476,10 @@ void EnhancedSuffixArray::createChildTable() {
     }
 
     // 2. Construciton of .nextlIndex
-    std::stack<int>().swap(st);
+    std::stack<I>().swap(st);
 
     st.push(0);
-    for (int i = 1; i < n_; ++i) {
+    for (I i = 1; i < n_; ++i) {
         while (lcptab_[i] < lcptab_[st.top()]) st.pop();
 
         if (lcptab_[i] == lcptab_[st.top()]) {
@@ -356,3 +491,11 @@ void EnhancedSuffixArray::createChildTable() {
         st.push(i);
     }
 }
+
+template class EnhancedSuffixArray<int32_t>;
+template class EnhancedSuffixArray<int64_t>;
+
+template void createSuffixArray<unsigned char, int32_t>(int32_t*, const unsigned char*, int32_t,
+    int32_t, int);
+template void createSuffixArray<unsigned char, int64_t>(int64_t*, const unsigned char*, int64_t,
+    int64_t, int);
@@ -23,8 +23,11 @@
  * @brief EnhancedSuffixArray class
  * @details Enhaced suffix array = suffix array + longest common prefix table +
  * child table (+ other tables which are not needed here). Class is used mostly
- * for pattern search.
+ * for pattern search. Tables are stored with index type I which is either
+ * int32_t (strings shorter than 2GB) or int64_t (any string, with twice the
+ * memory for tables).
  */
+template<typename I>
 class EnhancedSuffixArray {
 public:
 
@@ -32,10 +35,13 @@ public:
      * @brief EnhancedSuffixArray constructor
      * @details Creates an EnhancedSuffixArray object from a given string which include
      * construction of the suffix array, longest common prefix table and child table.
+     * The suffix array and the longest common prefix table are created with threadLen
+     * threads.
      *
-     * @param [in] str string with size less than 2GB
+     * @param [in] str string (with size less than 2GB for 32-bit indices)
+     * @param [in] threadLen number of threads
      */
-    EnhancedSuffixArray(const std::string& str);
+    EnhancedSuffixArray(const std::string& str, int threadLen = 1);
 
     /*!
      * @brief EnhancedSuffixArray destructor
@@ -46,7 +52,7 @@ public:
      * @brief Getter for stored sequence length
      * @return length
      */
-    int getLength() const {
+    I getLength() const {
         return n_;
     }
 
@@ -65,7 +71,7 @@ public:
      * @param [in] i position in suffix array
      * @return i-th suffix start position
      */
-    int getSuffix(int i) const {
+    I getSuffix(I i) const {
         ASSERT(i >= 0 && i < n_, "ESA", "index out of range");
         return suftab_[i];
     }
@@ -82,7 +88,7 @@ public:
      * @param [in] j interval end position
      * @param [in] c character
      */
-    void intervalSubInterval(int* s, int* e, int i, int j, char c) const;
+    void intervalSubInterval(I* s, I* e, I i, I j, char c) const;
 
     /*!
      * @brief Method for interval longest common prefix length retrieval
@@ -93,7 +99,7 @@ public:
      * @param [in] j interval end position
      * @return logest common prefix length
      */
-    int intervalLcpLen(int i, int j) const;
+    I intervalLcpLen(I i, I j) const;
 
     /*!
      * @brief Method for object size retrieval
@@ -114,7 +120,8 @@ public:
 
     /*!
      * @brief Method for object deserialization
-     * @details Method deserializes the object from a byte buffer.
+     * @details Method deserializes the object from a byte buffer (which has
+     * to hold an object with the same index type, see isWideEnhancedSuffixArray).
      *
      * @param [in] bytes byte buffer
      * @return EnhancedSuffixArray object
@@ -128,8 +135,6 @@ public:
      */
     void print() const;
 
-    friend class ReadIndex;
-
 private:
 
     /*!
@@ -138,26 +143,15 @@ private:
      */
     EnhancedSuffixArray() {};
 
-    /*!
-     * @brief Method for suffix array creation
-     * @details Called by the EnhacedSuffixArray public constructor to create the
-     * suffix array with the SA-IS algorithm which is based on induced sorting
-     * (article [1], complexity: O(n)).
-     *
-     * @param [in] s pointer to suffix array
-     * @param [in] n length of suffix array
-     * @param [in] csize size of elements in suffix array
-     * @param [in] alphabetSize number of different elements in input string
-     */
-    void createSuffixArray(const unsigned char* s, int n, int csize, int alphabetSize = 256);
-
     /*!
      * @brief Method for longest common prefix table creation
      * @details Called by the EnhacedSuffixArray public constructor to create the
-     * longest common prefix table from informatin in suffix array.
-     * (article [2], complexity: O(n))
+     * longest common prefix table from informatin in suffix array, ranges of
+     * text positions are processed in parallel (article [2], complexity: O(n))
+     *
+     * @param [in] threadLen number of threads
      */
-    void createLongestCommonPrefixTable();
+    void createLongestCommonPrefixTable(int threadLen);
 
     /*!
      * @brief Method for child table creation
@@ -167,9 +161,34 @@ private:
      */
     void createChildTable();
 
-    int n_;
+    I n_;
     std::string str_;
-    std::vector<int> suftab_;
-    std::vector<int> lcptab_;
-    std::vector<int> childtab_;
+    std::vector<I> suftab_;
+    std::vector<I> lcptab_;
+    std::vector<I> childtab_;
 };
+
+/*!
+ * @brief Method for serialized object inspection
+ * @details Serialized objects with 64-bit indices start with a marker
+ * instead of their 32-bit length.
+ *
+ * @param [in] bytes byte buffer with a serialized EnhancedSuffixArray object
+ * @return true if the object has 64-bit indices
+ */
+bool isWideEnhancedSuffixArray(const char* bytes);
+
+/*!
+ * @brief Method for suffix array construction
+ * @details Sorts all suffixes of s with SA-IS (article [1], complexity: O(n)). The last
+ * character of s has to be the unique smallest one and the character before it has to be
+ * greater than it. Characters are counted and induced with threadLen threads.
+ *
+ * @param [out] suftab suffix array of length n
+ * @param [in] s string of characters smaller than alphabetSize
+ * @param [in] n length of s
+ * @param [in] alphabetSize number of different characters
+ * @param [in] threadLen number of threads
+ */
+template<typename C, typename I>
+void createSuffixArray(I* suftab, const C* s, I n, I alphabetSize, int threadLen);
@@ -0,0 +1,262 @@
+/*!
+ * @file FmIndex.cpp
+ *
+ * @brief FmIndex class source file
+ */
+
+#include "FmIndex.hpp"
+#include "EnhancedSuffixArray.hpp"
+
+#define SENTINEL 0
+#define DELIMITER 1
+
+#define BLOCK_SIZE 256
+#define SUPERBLOCK_SIZE 65536
+
+// characters of a word of the transform which equal encoded character c
+static inline uint64_t matchWord(const uint64_t* planes, int planesLen, int c) {
+
+    uint64_t word = ~0ULL;
+
+    for (int p = 0; p < planesLen; ++p) {
+        word &= ((c >> p) & 1) ? planes[p] : ~planes[p];
+    }
+
+    return word;
+}
+
+FmIndex::FmIndex(const std::string& str, char delimiter, int threadLen) {
+
+    ASSERT(str.empty() || str[0] == delimiter, "FM", "invalid input string");
+    ASSERT(threadLen > 0, "FM", "invalid thread number");
+
+    Timer timer;
+    timer.start();
+
+    std::vector<bool> present(256, false);
+    for (const auto& c : str) {
+        present[(unsigned char) c] = true;
+    }
+
+    codes_.assign(256, 0);
+    codes_[(unsigned char) delimiter] = DELIMITER;
+
+    sigma_ = 2;
+    for (int c = 0; c < 256; ++c) {
+        if (present[c] && c != (unsigned char) delimiter) {
+            ASSERT(sigma_ < 256, "FM", "invalid alphabet size");
+            codes_[c] = sigma_++;
+        }
+    }
+
+    planes_ = 1;
+    while ((1 << planes_) < sigma_) ++planes_;
+
+    n_ = str.size() + 2;
+
+    std::vector<unsigned char> s(n_);
+    for (int64_t i = 0; i < n_ - 2; ++i) {
+        s[i] = codes_[(unsigned char) str[i]];
+    }
+    s[n_ - 2] = DELIMITER;
+    s[n_ - 1] = SENTINEL;
+
+    if (n_ <= std::numeric_limits<int32_t>::max()) {
+        std::vector<int32_t> suftab(n_);
+        createSuffixArray<unsigned char, int32_t>(suftab.data(), s.data(), n_, sigma_, threadLen);
+        createTransform(suftab.data(), s.data());
+    } else {
+        std::vector<int64_t> suftab(n_);
+        createSuffixArray<unsigned char, int64_t>(suftab.data(), s.data(), n_, sigma_, threadLen);
+        createTransform(suftab.data(), s.data());
+    }
+
+    timer.stop();
+    timer.print("FM", "construction");
+}
+
+void FmIndex::intervalExtension(int64_t* s, int64_t* e, int64_t i, int64_t j, char c) const {
+
+    *s = -1;
+    *e = -1;
+
+    int code = codes_[(unsigned char) c];
+
+    if (code == SENTINEL || i > j) return;
+
+    int64_t b = counts_[code] + rank(code, i);
+    int64_t d = counts_[code] + rank(code, j + 1) - 1;
+
+    if (b > d) return;
+
+    *s = b;
+    *e = d;
+}
+
+size_t FmIndex::sizeInBytes() const {
+
+    size_t bytesLen = 0;
+
+    bytesLen += sizeof(int64_t); // n_
+    bytesLen += sizeof(int); // sigma_
+    bytesLen += sizeof(int); // planes_
+    bytesLen += codes_.size();
+    bytesLen += counts_.size() * sizeof(int64_t);
+    bytesLen += bits_.size() * sizeof(uint64_t);
+    bytesLen += superblocks_.size() * sizeof(uint64_t);
+    bytesLen += blocks_.size() * sizeof(uint16_t);
+    bytesLen += identifiers_.size() * sizeof(int32_t);
+
+    return bytesLen;
+}
+
+void FmIndex::serialize(char** bytes, size_t* bytesLen) const {
+
+    *bytesLen = sizeInBytes();
+    *bytes = new char[*bytesLen];
+
+    size_t ptr = 0;
+
+    std::memcpy(*bytes + ptr, &n_, sizeof(int64_t));
+    ptr += sizeof(int64_t);
+
+    std::memcpy(*bytes + ptr, &sigma_, sizeof(int));
+    ptr += sizeof(int);
+
+    std::memcpy(*bytes + ptr, &planes_, sizeof(int));
+    ptr += sizeof(int);
+
+    std::memcpy(*bytes + ptr, &codes_[0], codes_.size());
+    ptr += codes_.size();
+
+    std::memcpy(*bytes + ptr, &counts_[0], counts_.size() * sizeof(int64_t));
+    ptr += counts_.size() * sizeof(int64_t);
+
+    std::memcpy(*bytes + ptr, &bits_[0], bits_.size() * sizeof(uint64_t));
+    ptr += bits_.size() * sizeof(uint64_t);
+
+    std::memcpy(*bytes + ptr, &superblocks_[0], superblocks_.size() * sizeof(uint64_t));
+    ptr += superblocks_.size() * sizeof(uint64_t);
+
+    std::memcpy(*bytes + ptr, &blocks_[0], blocks_.size() * sizeof(uint16_t));
+    ptr += blocks_.size() * sizeof(uint16_t);
+
+    std::memcpy(*bytes + ptr, &identifiers_[0], identifiers_.size() * sizeof(int32_t));
+}
+
+FmIndex* FmIndex::deserialize(const char* bytes) {
+
+    FmIndex* fm = new FmIndex();
+
+    size_t ptr = 0;
+
+    std::memcpy(&fm->n_, bytes + ptr, sizeof(int64_t));
+    ptr += sizeof(int64_t);
+
+    std::memcpy(&fm->sigma_, bytes + ptr, sizeof(int));
+    ptr += sizeof(int);
+
+    std::memcpy(&fm->planes_, bytes + ptr, sizeof(int));
+    ptr += sizeof(int);
+
+    fm->codes_.resize(256);
+    std::memcpy(&fm->codes_[0], bytes + ptr, fm->codes_.size());
+    ptr += fm->codes_.size();
+
+    fm->counts_.resize(fm->sigma_ + 1);
+    std::memcpy(&fm->counts_[0], bytes + ptr, fm->counts_.size() * sizeof(int64_t));
+    ptr += fm->counts_.size() * sizeof(int64_t);
+
+    fm->bits_.resize(((fm->n_ + 63) / 64) * fm->planes_);
+    std::memcpy(&fm->bits_[0], bytes + ptr, fm->bits_.size() * sizeof(uint64_t));
+    ptr += fm->bits_.size() * sizeof(uint64_t);
+
+    fm->superblocks_.resize((fm->n_ / SUPERBLOCK_SIZE + 1) * fm->sigma_);
+    std::memcpy(&fm->superblocks_[0], bytes + ptr, fm->superblocks_.size() * sizeof(uint64_t));
+    ptr += fm->superblocks_.size() * sizeof(uint64_t);
+
+    fm->blocks_.resize((fm->n_ / BLOCK_SIZE + 1) * fm->sigma_);
+    std::memcpy(&fm->blocks_[0], bytes + ptr, fm->blocks_.size() * sizeof(uint16_t));
+    ptr += fm->blocks_.size() * sizeof(uint16_t);
+
+    fm->identifiers_.resize(fm->counts_[DELIMITER + 1] - fm->counts_[DELIMITER]);
+    std::memcpy(&fm->identifiers_[0], bytes + ptr, fm->identifiers_.size() * sizeof(int32_t));
+
+    return fm;
+}
+
+template<typename I>
+void FmIndex::createTransform(const I* suftab, const unsigned char* s) {
+
+    counts_.assign(sigma_ + 1, 0);
+
+    for (int64_t i = 0; i < n_; ++i) {
+        ++counts_[s[i] + 1];
+    }
+    for (int c = 1; c <= sigma_; ++c) {
+        counts_[c] += counts_[c - 1];
+    }
+
+    // string identifiers of delimiter rows, the closing delimiter is not followed by a string
+    std::vector<int64_t> delimiters;
+    for (int64_t i = 0; i < n_; ++i) {
+        if (s[i] == DELIMITER) delimiters.push_back(i);
+    }
+
+    ASSERT(delimiters.size() <= (size_t) std::numeric_limits<int32_t>::max(), "FM",
+        "invalid number of strings");
+
+    identifiers_.resize(delimiters.size());
+
+    for (int64_t i = counts_[DELIMITER]; i < counts_[DELIMITER + 1]; ++i) {
+        int64_t id = std::lower_bound(delimiters.begin(), delimiters.end(), (int64_t) suftab[i]) -
+            delimiters.begin();
+        identifiers_[i - counts_[DELIMITER]] = id == (int64_t) delimiters.size() - 1 ? -1 : id;
+    }
+
+    std::vector<int64_t>().swap(delimiters);
+
+    bits_.assign(((n_ + 63) / 64) * planes_, 0);
+    superblocks_.assign((n_ / SUPERBLOCK_SIZE + 1) * sigma_, 0);
+    blocks_.assign((n_ / BLOCK_SIZE + 1) * sigma_, 0);
+
+    std::vector<uint64_t> totals(sigma_, 0);
+
+    for (int64_t i = 0; i <= n_; ++i) {
+
+        if (i % SUPERBLOCK_SIZE == 0) {
+            std::copy(totals.begin(), totals.end(), superblocks_.begin() + (i / SUPERBLOCK_SIZE) * sigma_);
+        }
+        if (i % BLOCK_SIZE == 0) {
+            const uint64_t* superblock = &superblocks_[(i / SUPERBLOCK_SIZE) * sigma_];
+            for (int c = 0; c < sigma_; ++c) {
+                blocks_[(i / BLOCK_SIZE) * sigma_ + c] = totals[c] - superblock[c];
+            }
+        }
+
+        if (i == n_) break;
+
+        int c = s[suftab[i] > 0 ? suftab[i] - 1 : n_ - 1];
+        ++totals[c];
+
+        for (int p = 0; p < planes_; ++p) {
+            if ((c >> p) & 1) bits_[(i / 64) * planes_ + p] |= 1ULL << (i % 64);
+        }
+    }
+}
+
+int64_t FmIndex::rank(int c, int64_t i) const {
+
+    int64_t r = superblocks_[(i / SUPERBLOCK_SIZE) * sigma_ + c] + blocks_[(i / BLOCK_SIZE) * sigma_ + c];
+
+    for (int64_t w = (i / BLOCK_SIZE) * (BLOCK_SIZE / 64); w < i / 64; ++w) {
+        r += __builtin_popcountll(matchWord(&bits_[w * planes_], planes_, c));
+    }
+
+    if (i % 64 != 0) {
+        r += __builtin_popcountll(matchWord(&bits_[(i / 64) * planes_], planes_, c) &
+            ((1ULL << (i % 64)) - 1));
+    }
+
+    return r;
+}
@@ -0,0 +1,143 @@
+/*!
+ * @file FmIndex.hpp
+ *
+ * @brief FmIndex class header file
+ * @details Header file with declaration of FmIndex class and its methods. \n
+ * Algorithms were rewritten to c++ from following papers: \n
+ *     1. Title: Opportunistic data structures with applications \n
+ *        Authors: Paolo Ferragina, Giovanni Manzini \n
+ */
+
+#pragma once
+
+#include "CommonHeaders.hpp"
+
+/*!
+ * @brief FmIndex class
+ * @details FM-index of a collection of strings, each preceded by a delimiter. Only the
+ * Burrows-Wheeler transform is kept, packed into bit planes of ceil(log2(sigma)) bits
+ * per character, together with character counts every 256 characters (which is below
+ * half a byte per character for nucleotide data). Rows which start with a delimiter are
+ * mapped to the index of their string so no suffix array samples are needed.
+ */
+class FmIndex {
+public:
+
+    /*!
+     * @brief FmIndex constructor
+     * @details Creates an FmIndex object from a concatenation of strings where each string
+     * is preceded by the delimiter. A closing delimiter and a sentinel are appended, the
+     * suffix array is created with threadLen threads and discarded after the transform,
+     * so construction still needs 4 (or 8) bytes per character for a moment.
+     *
+     * @param [in] str concatenated strings
+     * @param [in] delimiter character preceding each string
+     * @param [in] threadLen number of threads
+     */
+    FmIndex(const std::string& str, char delimiter, int threadLen = 1);
+
+    /*!
+     * @brief FmIndex destructor
+     */
+    ~FmIndex() {}
+
+    /*!
+     * @brief Getter for number of rows
+     * @return length of transformed string
+     */
+    int64_t getLength() const {
+        return n_;
+    }
+
+    /*!
+     * @brief Method for interval extension
+     * @details Method returns the interval (s, e) of rows which start with c followed
+     * by the common prefix of rows in interval [i, j] (complexity: O(1)).
+     * If no such interval exists then (s, e) = (-1, -1).
+     *
+     * @param [out] s interval start row
+     * @param [out] e interval end row
+     * @param [in] i interval start row
+     * @param [in] j interval end row
+     * @param [in] c character
+     */
+    void intervalExtension(int64_t* s, int64_t* e, int64_t i, int64_t j, char c) const;
+
+    /*!
+     * @brief Getter for string identifiers
+     * @details Rows which start with the delimiter are mapped to the index of the string
+     * which follows the delimiter (the closing delimiter is mapped to -1).
+     *
+     * @param [in] i row which starts with the delimiter
+     * @return string identifier
+     */
+    int32_t getIdentifier(int64_t i) const {
+        return identifiers_[i - counts_[1]];
+    }
+
+    /*!
+     * @brief Method for object size retrieval
+     * @details Method returns the objects size in bytes needed for serialization.
+     *
+     * @return size in bytes
+     */
+    size_t sizeInBytes() const;
+
+    /*!
+     * @brief Method for object serialization
+     * @details Method serializes the object to a byte buffer.
+     *
+     * @param [out] bytes byte buffer
+     * @param [out] bytesLen output byte guffer length
+     */
+    void serialize(char** bytes, size_t* bytesLen) const;
+
+    /*!
+     * @brief Method for object deserialization
+     * @details Method deserializes the object from a byte buffer.
+     *
+     * @param [in] bytes byte buffer
+     * @return FmIndex object
+     */
+    static FmIndex* deserialize(const char* bytes);
+
+private:
+
+    /*!
+     * @brief Private FmIndex constructor
+     * @details Creates an empty FmIndex object needed for deserialize method.
+     */
+    FmIndex() {};
+
+    /*!
+     * @brief Method for transform creation
+     * @details Called by the FmIndex public constructor to create the packed transform,
+     * its character counts and string identifiers from the encoded string.
+     *
+     * @param [in] suftab suffix array of the encoded string
+     * @param [in] s encoded string
+     */
+    template<typename I>
+    void createTransform(const I* suftab, const unsigned char* s);
+
+    /*!
+     * @brief Method for rank retrieval
+     * @details Method returns the number of occurences of encoded character c in the
+     * first i characters of the transform.
+     *
+     * @param [in] c encoded character
+     * @param [in] i prefix length
+     * @return number of occurences
+     */
+    int64_t rank(int c, int64_t i) const;
+
+    int64_t n_;
+    int sigma_;
+    int planes_;
+    std::vector<unsigned char> codes_; // 0 for characters not in the string
+    std::vector<int64_t> counts_; // number of smaller characters
+    std::vector<uint64_t> bits_; // bit planes interleaved per 64 characters
+    std::vector<uint64_t> superblocks_; // character counts every 65536 characters
+    std::vector<uint16_t> blocks_; // character counts every 256 characters in a superblock
+    std::vector<int32_t> identifiers_;
+};
@@ -383,7 +383,7 @@ namespace Graph {
   const string Graph::extract_sequence(Node* n) const {
     if (n->type() == Node::Type::Read) {
       bool rc = n->used_end() == Node::Side::Begin;
-      return rc ? reads_.at(n->object_id())->reverse_complement() : reads_.at(n->object_id())->sequence();
+      return (rc ? reads_.at(n->object_id())->reverse_complement() : reads_.at(n->object_id())->sequence()).str();
     } else {
       return extract_sequence(unitigs_[n->object_id()]);
     }
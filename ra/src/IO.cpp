@@ -7,11 +7,10 @@
  * @date Apr 21, 2015
  */
 
-#include "IO.hpp"
-
-#include "../vendor/afgreader/reader.h"
+#include <sys/mman.h>
 
-#define BUFFER_SIZE 4096
+#include "IO.hpp"
+#include "CompressedInput.hpp"
 
 static FILE* fileSafeOpen(const char* path, const char* mode) {
     FILE* f = fopen(path, mode);
@@ -19,240 +18,1014 @@ static FILE* fileSafeOpen(const char* path, const char* mode) {
     return f;
 }
 
-void readFastaReads(ReadSet& reads, const char* path) {
+// read fields point into a memory mapped file or a decompressed buffer
+struct ReadRecord {
+    const char* name;
+    uint32_t name_length;
+    const char* sequence;
+    uint32_t sequence_length;
+    const char* quality;
+    uint32_t quality_length;
+};
 
-    Timer timer;
-    timer.start();
+// finds the first record which starts at or after ptr
+using RecordStart = const char*(*)(const char*, const char*, const char*);
+// parses the record starting at ptr and returns the start of the next one
+using RecordParser = const char*(*)(ReadRecord&, const char*, const char*, const char*);
 
-    FILE* f = fileSafeOpen(path, "r");
+struct RecordFormat {
+    RecordStart start;
+    RecordParser parse;
+};
 
-    std::string name;
-    std::string sequence;
+static const char* mapReadsFile(const char* path, size_t* length) {
 
-    char* buffer = new char[BUFFER_SIZE];
+    const char* data = mapFile(path, length);
+    ASSERT(data != nullptr, "IO", "empty file %s", path);
 
-    bool isName = false;
-    bool createRead = false;
+    return data;
+}
 
-    int idx = 0;
+static const char* nextLine(const char* ptr, const char* end) {
+    const char* newline = (const char*) memchr(ptr, '\n', end - ptr);
+    return newline == nullptr ? end : newline + 1;
+}
 
-    while (!feof(f)) {
+static const char* nextNonEmptyLine(const char* ptr, const char* end) {
 
-        int readLen = fread(buffer, sizeof(char), BUFFER_SIZE, f);
+    ptr = nextLine(ptr, end);
+    while (ptr < end && (*ptr == '\n' || *ptr == '\r')) ++ptr;
 
-        for (int i = 0; i < readLen; ++i) {
+    return ptr;
+}
 
-            if (buffer[i] == '>') {
+// length of line starting at begin without line terminators
+static uint32_t lineLength(const char* begin, const char* end) {
 
-                if (createRead) {
-                    reads.push_back(new Read(idx++, name, sequence, "", 1.0));
-                }
+    if (begin >= end) return 0;
 
-                name.clear();
-                sequence.clear();
+    const char* newline = (const char*) memchr(begin, '\n', end - begin);
+    if (newline == nullptr) newline = end;
+    while (newline > begin && newline[-1] == '\r') --newline;
 
-                createRead = true;
-                isName = true;
+    return newline - begin;
+}
 
-            } else {
-                switch (buffer[i]) {
-                    case '\r':
-                        break;
-                    case '\n':
-                        isName = false;
-                        break;
-                    default:
-                        isName ? name += buffer[i] : sequence += buffer[i];
-                        break;
-                }
-            }
+static const char* findLineStartingWith(char c, const char* ptr, const char* data,
+    const char* end) {
+
+    while (ptr < end) {
+        const char* match = (const char*) memchr(ptr, c, end - ptr);
+        if (match == nullptr) return end;
+        if (match == data || match[-1] == '\n') return match;
+        ptr = match + 1;
+    }
+
+    return end;
+}
+
+static const char* fastaRecordStart(const char* ptr, const char* data,
+    const char* data_end) {
+
+    return findLineStartingWith('>', ptr, data, data_end);
+}
+
+static const char* parseFastaRecord(ReadRecord& dst, const char* ptr,
+    const char* data, const char* data_end) {
+
+    dst.name = ptr + 1;
+    dst.name_length = lineLength(dst.name, data_end);
+
+    // sequence lines are joined by normalization which skips '\n'
+    dst.sequence = nextLine(ptr, data_end);
+    ptr = findLineStartingWith('>', dst.sequence, data, data_end);
+    dst.sequence_length = ptr - dst.sequence;
+
+    dst.quality = "";
+    dst.quality_length = 0;
+
+    return ptr;
+}
+
+// a record starts with a line beginning with '@' which is followed by
+// a sequence line and a '+' line
+static const char* fastqRecordStart(const char* ptr, const char* data,
+    const char* data_end) {
+
+    while (true) {
+        ptr = findLineStartingWith('@', ptr, data, data_end);
+        if (ptr == data_end) break;
+
+        const char* plus = nextNonEmptyLine(nextNonEmptyLine(ptr, data_end), data_end);
+        if (plus < data_end && *plus == '+') break;
+
+        ++ptr;
+    }
+
+    return ptr;
+}
+
+static const char* parseFastqRecord(ReadRecord& dst, const char* ptr,
+    const char* data, const char* data_end) {
+
+    dst.name = ptr + 1;
+    dst.name_length = lineLength(dst.name, data_end);
+
+    dst.sequence = nextNonEmptyLine(ptr, data_end);
+    dst.sequence_length = lineLength(dst.sequence, data_end);
+
+    dst.quality = nextNonEmptyLine(nextNonEmptyLine(dst.sequence, data_end), data_end);
+    dst.quality_length = lineLength(dst.quality, data_end);
+
+    return nextNonEmptyLine(dst.quality, data_end);
+}
+
+static const RecordFormat kFastaFormat = { fastaRecordStart, parseFastaRecord };
+static const RecordFormat kFastqFormat = { fastqRecordStart, parseFastqRecord };
+
+// collects records which start in [begin, end>
+static void findRecords(std::vector<ReadRecord>& dst, const char* begin,
+    const char* end, const char* data, const char* data_end, RecordFormat format) {
+
+    const char* ptr = format.start(begin, data, data_end);
+
+    while (ptr < end) {
+        ReadRecord record;
+        ptr = format.parse(record, ptr, data, data_end);
+        dst.push_back(record);
+    }
+}
+
+// AFG messages span from the "{XXX" line to the matching "}" line, nested
+// messages (e.g. TLE in LAY) are part of their parent
+struct AfgMessage {
+    const char* begin;
+    const char* end;
+};
+
+enum class AfgLineType {
+    kBegin,
+    kEnd,
+    kField
+};
+
+// key is the message type for kBegin lines, values of multi line fields
+// (seq, qlt and com) span all lines up to the terminating "." line
+struct AfgLine {
+    AfgLineType type;
+    const char* key;
+    uint32_t key_length;
+    const char* value;
+    const char* value_end;
+};
+
+static bool afgKeyEquals(const AfgLine& line, const char* key) {
+    return line.key_length == 3 && std::memcmp(line.key, key, 3) == 0;
+}
+
+static const char* parseAfgLine(AfgLine& dst, const char* ptr, const char* end) {
+
+    uint32_t length = lineLength(ptr, end);
+    const char* next = nextLine(ptr, end);
+
+    dst.type = AfgLineType::kField;
+    dst.key = ptr;
+    dst.key_length = 0;
+    dst.value = ptr;
+    dst.value_end = ptr + length;
+
+    if (length != 0 && *ptr == '{') {
+        dst.type = AfgLineType::kBegin;
+        dst.key = ptr + 1;
+        dst.key_length = length - 1;
+        return next;
+    }
+
+    if (length != 0 && *ptr == '}') {
+        dst.type = AfgLineType::kEnd;
+        return next;
+    }
+
+    const char* colon = (const char*) memchr(ptr, ':', length);
+    if (colon == nullptr) return next;
+
+    dst.key_length = colon - ptr;
+    dst.value = colon + 1;
+
+    if (afgKeyEquals(dst, "seq") || afgKeyEquals(dst, "qlt") || afgKeyEquals(dst, "com")) {
+        while (next < end && *next != '.') next = nextLine(next, end);
+        dst.value_end = next;
+        next = nextLine(next, end);
+    }
+
+    return next;
+}
+
+// finds the first message which starts at or after ptr and returns its end,
+// dst is empty if there are no more messages
+static const char* nextAfgMessage(AfgMessage& dst, const char* ptr, const char* end) {
+
+    while (ptr < end && *ptr != '{') ptr = nextLine(ptr, end);
+
+    dst.begin = ptr;
+
+    uint32_t depth = 0;
+    AfgLine line;
+
+    while (ptr < end) {
+        ptr = parseAfgLine(line, ptr, end);
+
+        if (line.type == AfgLineType::kBegin) {
+            ++depth;
+        } else if (line.type == AfgLineType::kEnd && --depth == 0) {
+            break;
         }
     }
 
-    reads.push_back(new Read(idx, name, sequence, "", 1.0));
+    ASSERT(depth == 0, "IO", "unterminated AFG message");
 
-    delete[] buffer;
-    fclose(f);
+    dst.end = ptr;
 
-    timer.stop();
-    timer.print("IO", "fasta input");
+    return ptr;
 }
 
-void readFastqReads(ReadSet& reads, const char* path) {
+static bool isAfgMessage(const AfgMessage& message, const char* type) {
 
-    Timer timer;
-    timer.start();
+    AfgLine line;
+    parseAfgLine(line, message.begin, message.end);
+
+    return afgKeyEquals(line, type);
+}
 
-    ASSERT(fileExists(path), "IO", "cannot open file %s with mode r", path);
+// collects messages of the given type (e.g. "RED"), other ones are skipped
+static void findAfgMessages(std::vector<AfgMessage>& dst, const char* type,
+    const char* data, const char* end) {
 
-    std::ifstream f(path);
-    std::string line;
+    AfgMessage message;
 
-    std::string name;
+    for (const char* ptr = data; ptr < end;) {
+        ptr = nextAfgMessage(message, ptr, end);
+        if (message.begin != message.end && isAfgMessage(message, type)) {
+            dst.push_back(message);
+        }
+    }
+}
+
+// calls parse_line for every line of message with the depth of the message
+// the line belongs to (1 for the message itself)
+template<typename F>
+static void parseAfgMessage(const AfgMessage& message, F parse_line) {
+
+    uint32_t depth = 0;
+    AfgLine line;
+
+    for (const char* ptr = message.begin; ptr < message.end;) {
+        ptr = parseAfgLine(line, ptr, message.end);
+
+        if (line.type == AfgLineType::kBegin) ++depth;
+        parse_line(line, depth);
+        if (line.type == AfgLineType::kEnd) --depth;
+    }
+}
+
+// parses the next integer in [ptr, end> skipping blanks and commas
+static int64_t parseAfgInt(const char*& ptr, const char* end) {
+
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == ',')) ++ptr;
+
+    bool negative = ptr < end && *ptr == '-';
+    if (negative || (ptr < end && *ptr == '+')) ++ptr;
+
+    int64_t value = 0;
+    for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+        value = value * 10 + (*ptr - '0');
+    }
+
+    return negative ? -value : value;
+}
+
+static double parseAfgDouble(const char* ptr, const char* end) {
+
+    char buffer[64];
+    size_t length = std::min<size_t>(end - ptr, sizeof(buffer) - 1);
+    std::memcpy(buffer, ptr, length);
+    buffer[length] = '\0';
+
+    return strtod(buffer, nullptr);
+}
+
+// copies a multi line value without line terminators
+static void joinAfgLines(std::string& dst, const char* ptr, const char* end) {
+
+    dst.clear();
+
+    while (ptr < end) {
+        dst.append(ptr, lineLength(ptr, end));
+        ptr = nextLine(ptr, end);
+    }
+}
+
+// strings are reused between reads so parsing does not allocate per field
+struct AfgReadRecord {
+    uint32_t id;
+    const char* name;
+    uint32_t name_length;
     std::string sequence;
     std::string quality;
+    double coverage;
+};
+
+// name is the eid up to the first blank, the sequence is cut to the clear
+// range
+static void parseAfgRead(AfgReadRecord& dst, const AfgMessage& message) {
+
+    int64_t clr_lo = 0, clr_hi = INT64_MAX;
+
+    dst.id = 0;
+    dst.name = "";
+    dst.name_length = 0;
+    dst.sequence.clear();
+    dst.quality.clear();
+    dst.coverage = 1;
+
+    parseAfgMessage(message, [&](const AfgLine& line, uint32_t depth) {
+
+        if (depth != 1 || line.type != AfgLineType::kField) return;
+
+        const char* ptr = line.value;
+
+        if (afgKeyEquals(line, "iid")) {
+            dst.id = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "eid")) {
+            while (ptr < line.value_end && *ptr != ' ' && *ptr != '\t') ++ptr;
+            dst.name = line.value;
+            dst.name_length = ptr - line.value;
+        } else if (afgKeyEquals(line, "clr")) {
+            clr_lo = parseAfgInt(ptr, line.value_end);
+            clr_hi = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "cvg")) {
+            dst.coverage = parseAfgDouble(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "seq")) {
+            joinAfgLines(dst.sequence, ptr, line.value_end);
+        } else if (afgKeyEquals(line, "qlt")) {
+            joinAfgLines(dst.quality, ptr, line.value_end);
+        }
+    });
 
-    int i = 0;
-    int idx = 0;
+    // same as seq.substr(clr_lo, clr_hi - clr_lo) of the AMOS reader: a
+    // reversed clear range keeps the sequence from clr_lo on and the quality
+    // string is not clipped
+    ASSERT(clr_lo >= 0 && clr_lo <= (int64_t) dst.sequence.size(), "IO",
+        "invalid AFG clear range of read %u", dst.id);
 
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
+    dst.sequence.erase(0, clr_lo);
+    if (clr_hi >= clr_lo) {
+        dst.sequence.erase(std::min<uint64_t>(clr_hi - clr_lo, dst.sequence.size()));
+    }
+}
 
-        switch (i % 4) {
-            case 0:
-                if (i != 0) {
-                    reads.push_back(new Read(idx++, name, sequence, quality, 1.0));
-                }
+static Overlap* createAfgOverlap(const AfgMessage& message, const ReadSet& reads) {
 
-                name = line.substr(1, line.size() - 1);
-                sequence.clear();
-                quality.clear();
-                break;
-            case 1:
-                sequence = line;
-                break;
-            case 3:
-                quality = line;
-                break;
-            default:
-                break;
+    int64_t a = -1, b = -1, a_hang = 0, b_hang = 0;
+    bool innie = false;
+
+    parseAfgMessage(message, [&](const AfgLine& line, uint32_t depth) {
+
+        if (depth != 1 || line.type != AfgLineType::kField) return;
+
+        const char* ptr = line.value;
+
+        if (afgKeyEquals(line, "rds")) {
+            a = parseAfgInt(ptr, line.value_end);
+            b = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "adj")) {
+            innie = ptr < line.value_end && *ptr == 'I';
+        } else if (afgKeyEquals(line, "ahg")) {
+            a_hang = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "bhg")) {
+            b_hang = parseAfgInt(ptr, line.value_end);
+        }
+    });
+
+    ASSERT(a >= 0 && a < (int64_t) reads.size() && b >= 0 && b < (int64_t) reads.size(),
+        "IO", "invalid AFG overlap reads");
+
+    return new Overlap(reads[a], a_hang, reads[b], b_hang, innie);
+}
+
+static Contig* createAfgContig(const AfgMessage& message) {
+
+    auto contig = new Contig();
+
+    bool tile = false;
+    int64_t lo = 0, hi = 0, offset = 0, src = 0;
+
+    parseAfgMessage(message, [&](const AfgLine& line, uint32_t depth) {
+
+        if (depth != 2) return;
+
+        const char* ptr = line.value;
+
+        if (line.type == AfgLineType::kBegin) {
+            tile = afgKeyEquals(line, "TLE");
+            lo = hi = offset = src = 0;
+        } else if (line.type == AfgLineType::kEnd) {
+            if (tile) contig->addPart(ContigPart(src, lo, hi, offset));
+            tile = false;
+        } else if (!tile) {
+            return;
+        } else if (afgKeyEquals(line, "clr")) {
+            lo = parseAfgInt(ptr, line.value_end);
+            hi = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "off")) {
+            offset = parseAfgInt(ptr, line.value_end);
+        } else if (afgKeyEquals(line, "src")) {
+            src = parseAfgInt(ptr, line.value_end);
         }
+    });
+
+    ASSERT(contig->getParts().size() > 0, "IO", "invalid contig data");
+
+    return contig;
+}
+
+// dst[i] is created from messages[i], messages are split between threads
+template<typename T, typename F>
+static void createFromAfgMessages(std::vector<T*>& dst,
+    const std::vector<AfgMessage>& messages, int threadLen, F create) {
+
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
 
-        ++i;
+    size_t begin = dst.size();
+    dst.resize(begin + messages.size());
+
+    threadLen = std::max<size_t>(1, std::min<size_t>(threadLen, messages.size()));
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadLen; ++i) {
+        threads.emplace_back([&, i]() {
+            size_t end = messages.size() * (i + 1) / threadLen;
+            for (size_t j = messages.size() * i / threadLen; j < end; ++j) {
+                dst[begin + j] = create(messages[j]);
+            }
+        });
     }
 
-    reads.push_back(new Read(idx, name, sequence, quality, 1.0));
+    for (auto& it : threads) {
+        it.join();
+    }
+}
 
-    f.close();
+static void threadCreateReads(Read** dst, const std::vector<ReadRecord>& records,
+    uint32_t offset, uint32_t id, QualityMode quality_mode) {
 
-    timer.stop();
-    timer.print("IO", "fastq input");
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        const auto& it = records[i];
+        dst[offset + i] = new Read(id + offset + i, std::string(it.name, it.name_length),
+            std::string(it.sequence, it.sequence_length),
+            quality_mode == QualityMode::kDrop ? std::string() :
+            std::string(it.quality, it.quality_length), 1.0, quality_mode);
+    }
 }
 
-void readAfgReads(ReadSet& reads, const char* path) {
+static void threadCreateReads(ReadStore& dst, const std::vector<ReadRecord>& records,
+    uint32_t offset, uint32_t id, QualityMode quality_mode) {
 
-    Timer timer;
-    timer.start();
+    dst.reserve(records.size(), records.empty() ? 0 :
+        records.back().sequence - records.front().sequence);
 
-    ASSERT(fileExists(path), "IO", "cannot open file %s with mode r", path);
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        const auto& it = records[i];
+        dst.add(id + offset + i, it.name, it.name_length, it.sequence, it.sequence_length,
+            it.quality, it.quality_length, 1.0, true, quality_mode);
+    }
+}
 
-    std::ifstream f(path);
+// AFG reads keep their identifiers
+static void threadCreateReads(Read** dst, const std::vector<AfgMessage>& records,
+    uint32_t offset, uint32_t, QualityMode quality_mode) {
 
-    readAfgReads(reads, f);
+    AfgReadRecord record;
 
-    f.close();
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        parseAfgRead(record, records[i]);
+        if (quality_mode == QualityMode::kDrop) record.quality.clear();
 
-    timer.stop();
-    timer.print("IO", "afg input");
+        dst[offset + i] = new Read(record.id, std::string(record.name, record.name_length),
+            record.sequence, record.quality, record.coverage, quality_mode);
+    }
 }
 
-void readAfgReads(ReadSet& reads, std::istream& input) {
+static void threadCreateReads(ReadStore& dst, const std::vector<AfgMessage>& records,
+    uint32_t, uint32_t, QualityMode quality_mode) {
+
+    dst.reserve(records.size(), records.empty() ? 0 :
+        records.back().end - records.front().begin);
+
+    AfgReadRecord record;
 
-    AMOS::Reader* reader = new AMOS::Reader(input);
+    for (const auto& it : records) {
+        parseAfgRead(record, it);
+        dst.add(record.id, record.name, record.name_length, record.sequence.c_str(),
+            record.sequence.size(), record.quality.c_str(), record.quality.size(),
+            record.coverage, true, quality_mode);
+    }
+}
 
-    while (reader->has_next()) {
+// read identifiers follow the record order starting from id
+template<typename R>
+static void createReads(ReadSet& reads, const std::vector<std::vector<R>>& records,
+    const std::vector<uint32_t>& offsets, uint32_t id, QualityMode quality_mode) {
 
-        Read* read = nullptr;
+    size_t begin = reads.size();
+    reads.resize(begin + offsets.back());
 
-        if (reader->next(&read)) {
-            reads.emplace_back(read);
-        }
+    Read** dst = reads.data() + begin;
+
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            threadCreateReads(dst, records[i], offsets[i], id, quality_mode); });
     }
 
-    delete reader;
+    for (auto& it : threads) {
+        it.join();
+    }
 }
 
-void writeFastaReads(const ReadSet& reads, const char* path) {
+template<typename R>
+static void createReads(ReadStore& reads, const std::vector<std::vector<R>>& records,
+    const std::vector<uint32_t>& offsets, uint32_t id, QualityMode quality_mode) {
+
+    if (records.size() == 1) {
+        threadCreateReads(reads, records.front(), 0, id, quality_mode);
+        return;
+    }
+
+    std::vector<ReadStore> parts(records.size());
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            threadCreateReads(parts[i], records[i], offsets[i], id, quality_mode); });
+    }
+
+    for (auto& it : threads) {
+        it.join();
+    }
+
+    for (auto& it : parts) {
+        reads.append(it);
+        it.clear();
+    }
+}
+
+template<typename R>
+static std::vector<uint32_t> recordOffsets(const std::vector<std::vector<R>>& records) {
+
+    std::vector<uint32_t> offsets(1, 0);
+    for (const auto& it : records) {
+        offsets.push_back(offsets.back() + it.size());
+    }
+
+    return offsets;
+}
+
+// splits records into at most threadLen parts of consecutive records
+template<typename R>
+static std::vector<std::vector<R>> splitRecords(const std::vector<R>& records,
+    int threadLen) {
+
+    uint32_t parts = std::max<size_t>(1, std::min<size_t>(threadLen, records.size()));
+
+    std::vector<std::vector<R>> dst(parts);
+    for (uint32_t i = 0; i < parts; ++i) {
+        dst[i].assign(records.begin() + records.size() * i / parts,
+            records.begin() + records.size() * (i + 1) / parts);
+    }
+
+    return dst;
+}
+
+static void readCompressedReads(ReadSet& reads, const char* path, ReadFormat format,
+    int threadLen, QualityMode quality_mode) {
+
+    ReadBatchReader reader(path, format, 0, 0, threadLen, quality_mode);
+    reader.next_batch(reads);
+}
+
+static void readCompressedReads(ReadStore& reads, const char* path, ReadFormat format,
+    int threadLen, QualityMode quality_mode) {
+
+    ReadBatchReader reader(path, format, 0, 0, threadLen, quality_mode);
+
+    if (reads.empty()) {
+        reader.next_batch(reads);
+    } else {
+        ReadStore batch;
+        reader.next_batch(batch);
+        reads.append(batch);
+    }
+}
+
+template<typename T>
+static void readReads(T& reads, const char* path, RecordFormat format, int threadLen,
+    QualityMode quality_mode) {
+
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
+
+    if (detectCompression(path) != Compression::kNone) {
+        readCompressedReads(reads, path,
+            format.parse == parseFastaRecord ? ReadFormat::kFasta : ReadFormat::kFastq,
+            threadLen, quality_mode);
+        return;
+    }
+
+    size_t length;
+    const char* data = mapReadsFile(path, &length);
+
+    // at least 64KB per thread
+    threadLen = std::max<size_t>(1, std::min<size_t>(threadLen, length >> 16));
+
+    std::vector<std::vector<ReadRecord>> records(threadLen);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadLen; ++i) {
+        threads.emplace_back(findRecords, std::ref(records[i]), data + length * i / threadLen,
+            data + length * (i + 1) / threadLen, data, data + length, format);
+    }
+
+    for (auto& it : threads) {
+        it.join();
+    }
+
+    createReads(reads, records, recordOffsets(records), 0, quality_mode);
+
+    unmapFile(data, length);
+}
+
+void readFastaReads(ReadSet& reads, const char* path, int threadLen) {
 
     Timer timer;
     timer.start();
 
-    std::ofstream file;
+    readReads(reads, path, kFastaFormat, threadLen, QualityMode::kRaw);
 
-    if (path != nullptr) file.open(path, std::ios::out);
+    timer.stop();
+    timer.print("IO", "fasta input");
+}
 
-    std::ostream& out = path == nullptr ? std::cout : file;
+void readFastaReads(ReadStore& reads, const char* path, int threadLen) {
 
-    for (const auto& read : reads) {
-        out << ">" << read->name() << std::endl;
-        out << read->sequence() << std::endl;
-    }
+    Timer timer;
+    timer.start();
 
-    if (path != nullptr) file.close();
+    readReads(reads, path, kFastaFormat, threadLen, QualityMode::kRaw);
 
     timer.stop();
-    timer.print("IO", "fasta output");
+    timer.print("IO", "fasta input");
 }
 
-void writeAfgReads(const ReadSet& reads, const char* path) {
+void readFastqReads(ReadSet& reads, const char* path, int threadLen,
+    QualityMode quality_mode) {
 
     Timer timer;
     timer.start();
 
-    std::ofstream file;
+    readReads(reads, path, kFastqFormat, threadLen, quality_mode);
 
-    if (path != nullptr) file.open(path, std::ios::out);
+    timer.stop();
+    timer.print("IO", "fastq input");
+}
 
-    std::ostream& out = path == nullptr ? std::cout : file;
+void readFastqReads(ReadStore& reads, const char* path, int threadLen,
+    QualityMode quality_mode) {
 
-    for (const auto& read : reads) {
-        out << "{RED" << std::endl;
-        out << "clr:0," << read->length() << std::endl;
-        out << "eid:" << read->name() << std::endl;
-        out << "iid:" << read->id() << std::endl;
-        out << "qlt:" << read->quality() << std::endl;
-        out << "." << std::endl;
-        out << "seq:" << read->sequence() << std::endl;
-        out << "." << std::endl;
-        out << "cvg:" << read->coverage() << std::endl;
-        out << "}" << std::endl;
-    }
+    Timer timer;
+    timer.start();
 
-    if (path != nullptr) file.close();
+    readReads(reads, path, kFastqFormat, threadLen, quality_mode);
 
     timer.stop();
-    timer.print("IO", "afg output");
+    timer.print("IO", "fastq input");
 }
 
-void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, const char* path) {
+static void readAfgReads(ReadSet& reads, const char* data, size_t length,
+    int threadLen) {
+
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
+
+    std::vector<AfgMessage> messages;
+    findAfgMessages(messages, "RED", data, data + length);
+
+    auto records = splitRecords(messages, threadLen);
+    createReads(reads, records, recordOffsets(records), 0, QualityMode::kRaw);
+}
+
+void readAfgReads(ReadSet& reads, const char* path, int threadLen) {
 
     Timer timer;
     timer.start();
 
-    ASSERT(fileExists(path), "IO", "cannot open file %s with mode r", path);
+    size_t length;
+    const char* data = mapFile(path, &length);
 
-    std::ifstream f(path);
-    readAfgOverlaps(overlaps, reads, f);
-    f.close();
+    readAfgReads(reads, data, length, threadLen);
+
+    unmapFile(data, length);
 
     timer.stop();
     timer.print("IO", "afg input");
 }
 
-void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, std::istream& input) {
+void readAfgReads(ReadSet& reads, std::istream& input) {
+
+    std::string data((std::istreambuf_iterator<char>(input)),
+        std::istreambuf_iterator<char>());
+
+    readAfgReads(reads, data.c_str(), data.size(), 1);
+}
+
+//*****************************************************************************
+// ReadBatchReader
+
+ReadBatchReader::ReadBatchReader(const char* path, ReadFormat format,
+    uint32_t batch_reads, uint64_t batch_bytes, int threadLen, QualityMode quality_mode)
+        : format_(format), batch_reads_(batch_reads), batch_bytes_(batch_bytes),
+        threadLen_(threadLen), quality_mode_(quality_mode), id_(0), data_(nullptr), length_(0), ptr_(nullptr),
+        released_(nullptr), input_(nullptr), buffer_(), eof_(false) {
+
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
+
+    if (format == ReadFormat::kAfg) {
+        ASSERT(detectCompression(path) == Compression::kNone, "IO",
+            "compressed AFG input is not supported");
+        data_ = mapReadsFile(path, &length_);
+        ptr_ = data_;
+        released_ = data_;
+    } else if (detectCompression(path) != Compression::kNone) {
+        input_ = CompressedInput::create(path, threadLen);
+        // skip everything before the first record
+        do {
+            refill();
+            ptr_ = record_format().start(data_, data_, data_ + length_);
+        } while (ptr_ == data_ + length_ && !eof_);
+    } else {
+        data_ = mapReadsFile(path, &length_);
+        ptr_ = record_format().start(data_, data_, data_ + length_);
+        released_ = data_;
+    }
+}
+
+ReadBatchReader::~ReadBatchReader() {
+
+    if (input_ != nullptr) {
+        delete input_;
+    } else if (data_ != nullptr) {
+        unmapFile(data_, length_);
+    }
+}
+
+bool ReadBatchReader::next_batch(ReadStore& dst) {
+
+    dst.clear();
+
+    return format_ == ReadFormat::kAfg ? next_afg_batch(dst) : next_parsed_batch(dst);
+}
+
+bool ReadBatchReader::next_batch(ReadSet& dst) {
+    return format_ == ReadFormat::kAfg ? next_afg_batch(dst) : next_parsed_batch(dst);
+}
+
+const RecordFormat& ReadBatchReader::record_format() const {
+    return format_ == ReadFormat::kFasta ? kFastaFormat : kFastqFormat;
+}
+
+bool ReadBatchReader::batch_full(uint32_t reads, uint64_t bytes) const {
+    return (batch_reads_ != 0 && reads >= batch_reads_) ||
+        (batch_bytes_ != 0 && bytes >= batch_bytes_);
+}
+
+template<typename T>
+bool ReadBatchReader::next_parsed_batch(T& dst) {
+
+    uint32_t reads = 0;
+    uint64_t bytes = 0;
+
+    while (true) {
+
+        const char* data_end = data_ + length_;
+        const char* begin = ptr_;
+
+        std::vector<ReadRecord> batch;
+        bool incomplete = false;
 
-    AMOS::Reader* reader = new AMOS::Reader(input);
+        while (ptr_ < data_end && !batch_full(reads + batch.size(), bytes + (ptr_ - begin))) {
+            ReadRecord record;
+            const char* next = record_format().parse(record, ptr_, data_, data_end);
 
-    while (reader->has_next()) {
+            // a record reaching the end of buffered input might be cut
+            if (next == data_end && input_ != nullptr && !eof_) {
+                incomplete = true;
+                break;
+            }
+
+            ptr_ = next;
+            batch.push_back(record);
+        }
+
+        create_reads(dst, batch);
+        reads += batch.size();
+        bytes += ptr_ - begin;
+
+        if (input_ == nullptr || batch_full(reads, bytes) ||
+            (!incomplete && ptr_ < data_end) || !refill()) {
+            break;
+        }
+    }
+
+    if (input_ == nullptr) {
+        release_parsed();
+    }
+
+    return reads != 0;
+}
+
+template<typename T>
+bool ReadBatchReader::next_afg_batch(T& dst) {
 
-        Overlap* overlap = nullptr;
+    const char* data_end = data_ + length_;
+    const char* begin = ptr_;
 
-        if (reader->next(&overlap, reads)) {
-            overlaps.emplace_back(overlap);
+    std::vector<AfgMessage> batch;
+
+    while (ptr_ < data_end && !batch_full(batch.size(), ptr_ - begin)) {
+        AfgMessage message;
+        ptr_ = nextAfgMessage(message, ptr_, data_end);
+
+        if (message.begin != message.end && isAfgMessage(message, "RED")) {
+            batch.push_back(message);
         }
     }
 
-    delete reader;
+    create_reads(dst, batch);
+    release_parsed();
+
+    return !batch.empty();
 }
 
-void write_overlaps(const OverlapSet& overlaps, const std::string path) {
-  write_overlaps(overlaps, path.c_str());
+template<typename T, typename R>
+void ReadBatchReader::create_reads(T& dst, const std::vector<R>& batch) {
+
+    if (batch.empty()) return;
+
+    auto records = splitRecords(batch, threadLen_);
+
+    createReads(dst, records, recordOffsets(records), id_, quality_mode_);
+    id_ += batch.size();
 }
 
-void write_overlaps(const OverlapSet& overlaps, const char* path) {
+void ReadBatchReader::release_parsed() {
 
-    Timer timer;
-    timer.start();
+    // parsed pages are not needed anymore
+    uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    const char* release_end = (const char*) ((uintptr_t) ptr_ & ~(page_size - 1));
+
+    if (release_end > released_) {
+        madvise((void*) released_, release_end - released_, MADV_DONTNEED);
+        released_ = release_end;
+    }
+}
+
+bool ReadBatchReader::refill() {
+
+    if (eof_) return false;
+
+    // unparsed data is moved to the front of the buffer
+    buffer_.erase(buffer_.begin(), buffer_.begin() + (ptr_ - data_));
+
+    if (!input_->read(buffer_)) {
+        eof_ = true;
+    }
+
+    data_ = buffer_.data();
+    length_ = buffer_.size();
+    ptr_ = data_;
+
+    return true;
+}
+
+//*****************************************************************************
+// text output
+
+static void appendUint(std::string& dst, uint64_t value) {
+
+    char buffer[20];
+    int i = 20;
+
+    do {
+        buffer[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    dst.append(buffer + i, 20 - i);
+}
+
+static void appendInt(std::string& dst, int64_t value) {
+
+    if (value < 0) {
+        dst += '-';
+        appendUint(dst, -(uint64_t) value);
+    } else {
+        appendUint(dst, value);
+    }
+}
+
+// same text as printf with %f (fixed) or %g (as std::ostream by default),
+// integral values (e.g. unset error rates) are converted without printf
+static void appendDouble(std::string& dst, double value, bool fixed) {
+
+    if (std::fabs(value) < 1e6 && value == (int64_t) value &&
+        !(value == 0 && std::signbit(value))) {
+        appendInt(dst, (int64_t) value);
+        if (fixed) dst += ".000000";
+        return;
+    }
+
+    char buffer[384];
+    int length = snprintf(buffer, sizeof(buffer), fixed ? "%f" : "%g", value);
+    dst.append(buffer, length);
+}
+
+static void appendSequence(std::string& dst, const SequenceView& sequence) {
+
+    size_t size = dst.size();
+    dst.resize(size + sequence.length());
+    sequence.copy(&dst[size]);
+}
+
+// records are formatted in blocks, threadLen blocks at a time, while the
+// previous blocks are being written; blocks are written in record order
+template<typename T, typename F>
+static void writeText(const T& records, F format,
+    const std::function<void(const std::string&)>& write, int threadLen) {
+
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
+
+    const size_t kBlockSize = 1024;
+    const size_t kRoundSize = kBlockSize * threadLen;
+    const size_t size = records.size();
+
+    auto formatRound = [&](size_t begin, std::vector<std::string>& buffers) {
+
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < threadLen; ++i) {
+            threads.emplace_back([&, i]() {
+                buffers[i].clear();
+                size_t end = std::min(size, begin + (i + 1) * kBlockSize);
+                for (size_t j = begin + i * kBlockSize; j < end; ++j) {
+                    format(buffers[i], records[j]);
+                }
+            });
+        }
+
+        for (auto& it : threads) {
+            it.join();
+        }
+    };
+
+    std::vector<std::string> current(threadLen), next(threadLen);
+
+    if (size != 0) formatRound(0, current);
+
+    for (size_t begin = 0; begin < size; begin += kRoundSize) {
+
+        std::future<void> formatted;
+        if (begin + kRoundSize < size) {
+            formatted = std::async(std::launch::async, formatRound, begin + kRoundSize,
+                std::ref(next));
+        }
+
+        for (const auto& it : current) {
+            if (!it.empty()) write(it);
+        }
+
+        if (formatted.valid()) formatted.get();
+        current.swap(next);
+    }
+}
+
+template<typename T, typename F>
+static void writeText(const T& records, F format, std::ostream& out, int threadLen) {
+    writeText(records, format, [&](const std::string& buffer) {
+        out.write(buffer.data(), buffer.size()); }, threadLen);
+}
+
+template<typename T, typename F>
+static void writeText(const T& records, F format, const char* path, int threadLen) {
 
     std::ofstream file;
 
@@ -260,97 +1033,225 @@ void write_overlaps(const OverlapSet& overlaps, const char* path) {
 
     std::ostream& out = path == nullptr ? std::cout : file;
 
-    for (const auto& overlap : overlaps) {
-      out << *overlap;
-    }
+    writeText(records, format, out, threadLen);
 
     if (path != nullptr) file.close();
+}
+
+struct FastaFormat {
+    template<typename R>
+    void operator()(std::string& dst, const R& read) const {
+        dst += '>';
+        dst += read->name();
+        dst += '\n';
+        appendSequence(dst, read->sequence());
+        dst += '\n';
+    }
+};
+
+struct AfgReadFormat {
+    template<typename R>
+    void operator()(std::string& dst, const R& read) const {
+        dst += "{RED\nclr:0,";
+        appendUint(dst, read->length());
+        dst += "\neid:";
+        dst += read->name();
+        dst += "\niid:";
+        appendUint(dst, read->id());
+        dst += "\nqlt:";
+        dst += read->quality();
+        dst += "\n.\nseq:";
+        appendSequence(dst, read->sequence());
+        dst += "\n.\ncvg:";
+        appendDouble(dst, read->coverage(), false);
+        dst += "\n}\n";
+    }
+};
+
+// same as Overlap::print
+struct OverlapFormat {
+    void operator()(std::string& dst, const Overlap* overlap) const {
+        appendUint(dst, overlap->a());
+        dst += '\t';
+        appendUint(dst, overlap->b());
+        dst += overlap->is_innie() ? "\tI\t" : "\tN\t";
+        appendInt(dst, overlap->is_dovetail() ? overlap->a_hang() : 0);
+        dst += '\t';
+        appendInt(dst, overlap->is_dovetail() ? overlap->b_hang() : 0);
+        dst += '\t';
+        appendDouble(dst, overlap->err_rate(), false);
+        dst += '\t';
+        appendDouble(dst, overlap->orig_err_rate(), false);
+        dst += '\n';
+    }
+};
+
+// fields are printed as signed integers, as with %d
+struct RadumpOverlapFormat {
+    void operator()(std::string& dst, const Overlap* overlap) const {
+        int32_t fields[] = { (int32_t) overlap->a(), (int32_t) overlap->b(), 0,
+            (int32_t) overlap->a_lo(), (int32_t) overlap->a_hi(),
+            (int32_t) overlap->read_a()->length(), (int32_t) overlap->b_lo(),
+            (int32_t) overlap->b_hi(), (int32_t) overlap->read_b()->length() };
+
+        for (int i = 0; i < 9; ++i) {
+            if (i == 2) {
+                dst += overlap->is_innie() ? 'I' : 'N';
+            } else {
+                appendInt(dst, fields[i]);
+            }
+            dst += '\t';
+        }
+
+        appendDouble(dst, overlap->orig_err_rate(), true);
+        dst += '\t';
+        appendDouble(dst, overlap->err_rate(), true);
+        dst += "\t\n";
+    }
+};
+
+struct AfgContigFormat {
+    void operator()(std::string& dst, const Contig* contig) const {
+        dst += "{LAY\n";
+
+        for (const auto& part : contig->getParts()) {
+            dst += "{TLE\nclr:";
+            appendInt(dst, part.clr_lo);
+            dst += ',';
+            appendInt(dst, part.clr_hi);
+            dst += "\noff:";
+            appendInt(dst, part.offset);
+            dst += "\nsrc:";
+            appendInt(dst, part.src);
+            dst += "\nrvc:";
+            appendInt(dst, part.type());
+            dst += "\n}\n";
+        }
+
+        dst += "}\n";
+    }
+};
+
+template<typename T>
+static void writeFastaReadsImpl(const T& reads, const char* path, int threadLen) {
+
+    Timer timer;
+    timer.start();
+
+    writeText(reads, FastaFormat(), path, threadLen);
 
     timer.stop();
-    timer.print("IO", "afg output");
+    timer.print("IO", "fasta output");
 }
 
-void readAfgContigs(std::vector<Contig*>& contigs, const char* path) {
+template<typename T>
+static void writeAfgReadsImpl(const T& reads, const char* path, int threadLen) {
 
     Timer timer;
     timer.start();
 
-    ASSERT(fileExists(path), "IO", "cannot open file %s with mode r", path);
-
-    std::ifstream f(path);
-    std::string line;
-
-    while (std::getline(f, line)) {
-        if (line.empty()) continue;
-
-        if (std::strncmp(line.c_str(), "{LAY", 4) == 0) {
-            // found contig;
-            bool end = true;
-            Contig* contig = new Contig();
-
-            int lo, hi, off, id;
-
-            while (std::getline(f, line)) {
-
-                if (std::strncmp(line.c_str(), "{TLE", 4) == 0) {
-                    end = false;
-                    // skip
-                } else if (sscanf(line.c_str(), "clr:%d, %d", &lo, &hi) == 2) {
-                    // skip
-                } else if (sscanf(line.c_str(), "off:%d", &off) == 1) {
-                    // skip
-                } else if (sscanf(line.c_str(), "src:%d", &id) == 1) {
-                    // skip
-                } else if (std::strncmp(line.c_str(), "}", 1) == 0) {
-                    if (end == true) {
-                        break;
-                    }
-                    end = true;
-                    contig->addPart(ContigPart(id, lo, hi, off));
-                }
-            }
+    writeText(reads, AfgReadFormat(), path, threadLen);
 
-            ASSERT(contig->getParts().size() > 0, "IO", "invalid contig data");
+    timer.stop();
+    timer.print("IO", "afg output");
+}
 
-            contigs.emplace_back(contig);
-        }
-    }
+void writeFastaReads(const ReadSet& reads, const char* path, int threadLen) {
+    writeFastaReadsImpl(reads, path, threadLen);
+}
 
-    f.close();
+void writeFastaReads(const ReadStore& reads, const char* path, int threadLen) {
+    writeFastaReadsImpl(reads, path, threadLen);
+}
+
+void writeAfgReads(const ReadSet& reads, const char* path, int threadLen) {
+    writeAfgReadsImpl(reads, path, threadLen);
+}
+
+void writeAfgReads(const ReadStore& reads, const char* path, int threadLen) {
+    writeAfgReadsImpl(reads, path, threadLen);
+}
+
+void writeAfgReads(const ReadStore& reads, std::ostream& out, int threadLen) {
+    writeText(reads, AfgReadFormat(), out, threadLen);
+}
+
+static void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads,
+    const char* data, size_t length, int threadLen) {
+
+    std::vector<AfgMessage> messages;
+    findAfgMessages(messages, "OVL", data, data + length);
+
+    createFromAfgMessages(overlaps, messages, threadLen, [&](const AfgMessage& message) {
+        return createAfgOverlap(message, reads); });
+}
+
+void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, const char* path,
+    int threadLen) {
+
+    Timer timer;
+    timer.start();
+
+    size_t length;
+    const char* data = mapFile(path, &length);
+
+    readAfgOverlaps(overlaps, reads, data, length, threadLen);
+
+    unmapFile(data, length);
 
     timer.stop();
     timer.print("IO", "afg input");
 }
 
-void writeAfgContigs(const std::vector<Contig*>& contigs, const char* path) {
+void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, std::istream& input) {
+
+    std::string data((std::istreambuf_iterator<char>(input)),
+        std::istreambuf_iterator<char>());
+
+    readAfgOverlaps(overlaps, reads, data.c_str(), data.size(), 1);
+}
+
+void write_overlaps(const OverlapSet& overlaps, const std::string path, int threadLen) {
+  write_overlaps(overlaps, path.c_str(), threadLen);
+}
+
+void write_overlaps(const OverlapSet& overlaps, const char* path, int threadLen) {
 
     Timer timer;
     timer.start();
 
-    std::ofstream file;
+    writeText(overlaps, OverlapFormat(), path, threadLen);
 
-    if (path != nullptr) file.open(path, std::ios::out);
+    timer.stop();
+    timer.print("IO", "afg output");
+}
 
-    std::ostream& out = path == nullptr ? std::cout : file;
+void readAfgContigs(std::vector<Contig*>& contigs, const char* path, int threadLen) {
 
-    for (const auto& contig : contigs) {
+    Timer timer;
+    timer.start();
 
-        out << "{LAY" << std::endl;
+    size_t length;
+    const char* data = mapFile(path, &length);
 
-        for (const auto& part : contig->getParts()) {
+    std::vector<AfgMessage> messages;
+    findAfgMessages(messages, "LAY", data, data + length);
 
-            out << "{TLE" << std::endl;
-            out << "clr:" << part.clr_lo << "," << part.clr_hi << std::endl;
-            out << "off:" << part.offset << std::endl;
-            out << "src:" << part.src << std::endl;
-            out << "rvc:" << part.type() << std::endl;
-            out << "}" << std::endl;
-        }
+    createFromAfgMessages(contigs, messages, threadLen, createAfgContig);
 
-        out << "}" << std::endl;
-    }
+    unmapFile(data, length);
 
-    if (path != nullptr) file.close();
+    timer.stop();
+    timer.print("IO", "afg input");
+}
+
+void writeAfgContigs(const std::vector<Contig*>& contigs, const char* path,
+    int threadLen) {
+
+    Timer timer;
+    timer.start();
+
+    writeText(contigs, AfgContigFormat(), path, threadLen);
 
     timer.stop();
     timer.print("IO", "afg output");
@@ -415,15 +1316,9 @@ FILE* must_fopen(const char* path, const char* mode) {
   return res;
 }
 
-void writeRadumpOverlaps(FILE* dst, OverlapSet& overlaps) {
-  for (auto o : overlaps) {
-    fprintf(stdout, "%d\t%d\t%c\t%d\t%d\t%d\t%d\t%d\t%d\t%f\t%f\t\n",
-        o->a(), o->b(), o->is_innie() ? 'I' : 'N',
-        o->a_lo(), o->a_hi(), o->read_a()->length(),
-        o->b_lo(), o->b_hi(), o->read_b()->length(),
-        o->orig_err_rate(), o->err_rate()
-        );
-  }
+void writeRadumpOverlaps(FILE* dst, const OverlapSet& overlaps, int threadLen) {
+  writeText(overlaps, RadumpOverlapFormat(), [&](const std::string& buffer) {
+      fwrite(buffer.data(), 1, buffer.size(), dst); }, threadLen);
 }
 
 void readRadumpOverlaps(OverlapSet* overlaps, ReadSet& reads, FILE* src) {
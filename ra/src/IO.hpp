@@ -11,39 +11,183 @@
 
 #include "Contig.hpp"
 #include "Read.hpp"
+#include "ReadStore.hpp"
 #include "Overlap.hpp"
 #include "StringGraph.hpp"
 #include "CommonHeaders.hpp"
 
+struct RecordFormat;
+struct ReadRecord;
+class CompressedInput;
+
+/*!
+ * @brief Read input file formats
+ */
+enum class ReadFormat {
+    kFasta,
+    kFastq,
+    kAfg
+};
+
+/*!
+ * @brief ReadBatchReader class
+ * @details Pull based reader which yields reads from a file in batches of
+ * bounded size, so reads can be converted or stored without keeping the
+ * whole dataset in memory. FASTA and FASTQ files are parsed as in
+ * readFastaReads and read identifiers continue across batches, AFG reads
+ * keep their identifiers and are parsed as in readAfgReads. Gzip and BGZF compressed FASTA and FASTQ files are
+ * decompressed while reading (BGZF blocks by threadLen threads), records cut
+ * by the end of decompressed data are completed with the next part of input.
+ */
+class ReadBatchReader {
+public:
+
+    /*!
+     * @brief ReadBatchReader constructor
+     *
+     * @param [in] path path to file where reads are stored
+     * @param [in] format file format
+     * @param [in] batch_reads maximal number of reads in a batch (0 for no limit)
+     * @param [in] batch_bytes approximate maximal number of input bytes in
+     * a batch (0 for no limit)
+     * @param [in] threadLen number of threads used for read creation and
+     * decompression
+     * @param [in] quality_mode keep qualities raw, binned or drop them
+     */
+    ReadBatchReader(const char* path, ReadFormat format, uint32_t batch_reads,
+        uint64_t batch_bytes, int threadLen = 1,
+        QualityMode quality_mode = QualityMode::kRaw);
+
+    /*!
+     * @brief ReadBatchReader destructor
+     */
+    ~ReadBatchReader();
+
+    /*!
+     * @brief Method for batch input
+     * @details Replaces the content of dst with the next batch of reads.
+     *
+     * @param [out] dst ReadStore object
+     * @return false if there are no more reads
+     */
+    bool next_batch(ReadStore& dst);
+
+    /*!
+     * @brief Method for batch input
+     * @details Appends the next batch of reads to dst as Read objects.
+     *
+     * @param [out] dst vector of Read objects pointers
+     * @return false if there are no more reads
+     */
+    bool next_batch(ReadSet& dst);
+
+private:
+
+    ReadBatchReader(const ReadBatchReader&) = delete;
+    const ReadBatchReader& operator=(const ReadBatchReader&) = delete;
+
+    const RecordFormat& record_format() const;
+
+    bool batch_full(uint32_t reads, uint64_t bytes) const;
+
+    template<typename T>
+    bool next_parsed_batch(T& dst);
+
+    template<typename T>
+    bool next_afg_batch(T& dst);
+
+    template<typename T, typename R>
+    void create_reads(T& dst, const std::vector<R>& batch);
+
+    bool refill();
+
+    void release_parsed();
+
+    ReadFormat format_;
+    uint32_t batch_reads_;
+    uint64_t batch_bytes_;
+    int threadLen_;
+    QualityMode quality_mode_;
+    uint32_t id_;
+
+    // uncompressed input is memory mapped, compressed input is parsed from
+    // buffer_ which holds unparsed decompressed data
+    const char* data_;
+    size_t length_;
+    const char* ptr_;
+    const char* released_;
+
+    CompressedInput* input_;
+    std::vector<char> buffer_;
+    bool eof_;
+};
+
 /*!
  * @brief Method for Read input
  * @details Method reads from file in FASTA format and creates
- * Read objects
+ * Read objects. The file is memory mapped and, if more than one thread is
+ * used, split into chunks which are parsed in parallel. Read identifiers
+ * follow the order of reads in file regardless of the number of threads.
+ * Gzip and BGZF compressed files are read through ReadBatchReader and get
+ * the same identifiers as uncompressed ones.
  *
  * @param [out] reads vector of Read objects pointers
  * @param [in] path path to file where the Read objects are stored
+ * @param [in] threadLen number of threads
  */
-void readFastaReads(ReadSet& reads, const char* path);
+void readFastaReads(ReadSet& reads, const char* path, int threadLen = 1);
+
+/*!
+ * @brief Method for Read input
+ * @details Method reads from file in FASTA format and appends reads
+ * to a ReadStore
+ *
+ * @param [out] reads ReadStore object
+ * @param [in] path path to file where the reads are stored
+ * @param [in] threadLen number of threads
+ */
+void readFastaReads(ReadStore& reads, const char* path, int threadLen = 1);
 
 /*!
  * @brief Method for Read input
  * @details Method reads from file in FASTQ format and creates
- * Read objects
+ * Read objects. Parsing is done as in readFastaReads, each record has to
+ * span exactly four (non-empty) lines.
  *
  * @param [out] reads vector of Read objects pointers
  * @param [in] path path to file where the Read objects are stored
+ * @param [in] threadLen number of threads
+ * @param [in] quality_mode keep qualities raw, binned or drop them
+ */
+void readFastqReads(ReadSet& reads, const char* path, int threadLen = 1,
+    QualityMode quality_mode = QualityMode::kRaw);
+
+/*!
+ * @brief Method for Read input
+ * @details Method reads from file in FASTQ format and appends reads
+ * to a ReadStore
+ *
+ * @param [out] reads ReadStore object
+ * @param [in] path path to file where the reads are stored
+ * @param [in] threadLen number of threads
+ * @param [in] quality_mode keep qualities raw, binned or drop them
  */
-void readFastqReads(ReadSet& reads, const char* path);
+void readFastqReads(ReadStore& reads, const char* path, int threadLen = 1,
+    QualityMode quality_mode = QualityMode::kRaw);
 
 /*!
  * @brief Method for Read input
  * @details Method reads from file in AFG format and creates
- * Read objects
+ * Read objects from RED messages. The file is memory mapped, message
+ * boundaries are found in one pass and messages are then parsed by threadLen
+ * threads. Sequences (and qualities of the same length) are cut to the
+ * clear range, names are eids up to the first blank.
  *
  * @param [out] reads vector of Read objects pointers
  * @param [in] path path to file where the Read objects are stored
+ * @param [in] threadLen number of threads
  */
-void readAfgReads(ReadSet& reads, const char* path);
+void readAfgReads(ReadSet& reads, const char* path, int threadLen = 1);
 
 /*!
  * @brief Method for Read input
@@ -57,13 +201,27 @@ void readAfgReads(ReadSet& reads, std::istream& input);
 
 /*!
  * @brief Method for Read output
- * @details Method writes Read objects to file in FASTA format
+ * @details Method writes Read objects to file in FASTA format. Blocks of
+ * reads are formatted by threadLen threads and written in order, so the
+ * output does not depend on the number of threads.
  *
  * @param [in] reads vector of Read objects pointers
  * @param [in] path path to file where the Read objects will be stored
  * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
+ */
+void writeFastaReads(const ReadSet& reads, const char* path, int threadLen = 1);
+
+/*!
+ * @brief Method for Read output
+ * @details Method writes reads kept in a ReadStore to file in FASTA format
+ *
+ * @param [in] reads ReadStore object
+ * @param [in] path path to file where the reads will be stored
+ * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
  */
-void writeFastaReads(const ReadSet& reads, const char* path);
+void writeFastaReads(const ReadStore& reads, const char* path, int threadLen = 1);
 
 /*!
  * @brief Method for Read output
@@ -72,8 +230,30 @@ void writeFastaReads(const ReadSet& reads, const char* path);
  * @param [in] reads vector of Read objects pointers
  * @param [in] path path to file where the Read objects will be store
  * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
+ */
+void writeAfgReads(const ReadSet& reads, const char* path, int threadLen = 1);
+
+/*!
+ * @brief Method for Read output
+ * @details Method writes reads kept in a ReadStore to file in AFG format
+ *
+ * @param [in] reads ReadStore object
+ * @param [in] path path to file where the reads will be stored
+ * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
  */
-void writeAfgReads(const ReadSet& reads, const char* path);
+void writeAfgReads(const ReadStore& reads, const char* path, int threadLen = 1);
+
+/*!
+ * @brief Method for Read output
+ * @details Method writes reads kept in a ReadStore to stream in AFG format
+ *
+ * @param [in] reads ReadStore object
+ * @param [in] out output stream
+ * @param [in] threadLen number of threads used for formatting
+ */
+void writeAfgReads(const ReadStore& reads, std::ostream& out, int threadLen = 1);
 
 /*!
  * @brief Method for Overlap output
@@ -82,8 +262,9 @@ void writeAfgReads(const ReadSet& reads, const char* path);
  *
  * @param [in] output file descriptor
  * @param [in] overlaps vector of Overlap objects pointers
+ * @param [in] threadLen number of threads used for formatting
  */
-void writeRadumpOverlaps(FILE* dst, OverlapSet& overlaps);
+void writeRadumpOverlaps(FILE* dst, const OverlapSet& overlaps, int threadLen = 1);
 
 /*!
  * @brief Method for reading radump Overlaps
@@ -99,12 +280,16 @@ void readRadumpOverlaps(OverlapSet* overlaps, ReadSet& reads, FILE* src);
 /*!
  * @brief Method for Overlap input
  * @details Method reads from file in AFG format and creates
- * Overlap objects
+ * Overlap objects from OVL messages, parsed as in readAfgReads. Read
+ * identifiers are indices in reads.
  *
  * @param [out] overlaps vector of Overlap objects pointers
+ * @param [in] reads vector of Read objects pointers
  * @param [in] path path to file where the Overlap objects are stored
+ * @param [in] threadLen number of threads
  */
-void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, const char* path);
+void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, const char* path,
+    int threadLen = 1);
 
 /*!
  * @brief Method for Overlap input
@@ -123,18 +308,9 @@ void readAfgOverlaps(OverlapSet& overlaps, const ReadSet& reads, std::istream& i
  * @param [in] reads vector of Overlap objects pointers
  * @param [in] path path to file where the Overlap objects will be stored
  * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
  */
-void write_overlaps(const OverlapSet& overlaps, const char* path);
-
-/*!
- * @brief Method for Overlap output
- * @details Method writes Overlap objects to file
- *
- * @param [in] reads vector of Overlap objects pointers
- * @param [in] path path to file where the Overlap objects will be stored
- * (if null, stdout is used)
- */
-void write_overlaps(const OverlapSet& overlaps, const std::string path);
+void write_overlaps(const OverlapSet& overlaps, const char* path, int threadLen = 1);
 
 /*!
  * @brief Method for Overlap output
@@ -143,8 +319,10 @@ void write_overlaps(const OverlapSet& overlaps, const std::string path);
  * @param [in] reads vector of Overlap objects pointers
  * @param [in] path path to file where the Overlap objects will be stored
  * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
  */
-void write_overlaps(const OverlapSet& overlaps, const char* path);
+void write_overlaps(const OverlapSet& overlaps, const std::string path,
+    int threadLen = 1);
 
 /*!
  * @brief Method for reading dovetail overlaps
@@ -158,12 +336,14 @@ void read_dovetail_overlaps(OverlapSet& overlaps, const ReadSet& reads, FILE* fd
 /*!
  * @brief Method for Contig input
  * @details Method reads from file in AFG format and creates
- * Contig objects
+ * Contig objects from LAY messages, parsed as in readAfgReads
  *
  * @param [out] contigs vector of Contig objects pointers
  * @param [in] path path to file where the Contig objects are stored
+ * @param [in] threadLen number of threads
  */
-void readAfgContigs(std::vector<Contig*>& contigs, const char* path);
+void readAfgContigs(std::vector<Contig*>& contigs, const char* path,
+    int threadLen = 1);
 
 /*!
  * @brief Method for Contig output
@@ -172,8 +352,10 @@ void readAfgContigs(std::vector<Contig*>& contigs, const char* path);
  * @param [in] reads vector of Contig objects pointers
  * @param [in] path path to file where the Contig objects will be stored
  * (if null, stdout is used)
+ * @param [in] threadLen number of threads used for formatting
  */
-void writeAfgContigs(const std::vector<Contig*>& contigs, const char* path);
+void writeAfgContigs(const std::vector<Contig*>& contigs, const char* path,
+    int threadLen = 1);
 
 /*!
  * @brief Method check if the given file exists
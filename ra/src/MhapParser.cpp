@@ -1,6 +1,249 @@
 
 #include "MhapParser.hpp"
 
+namespace {
+
+  // overlap fields as expected by the Overlap constructor
+  struct OverlapRecord {
+    const Read* a;
+    uint32_t a_lo;
+    uint32_t a_hi;
+    const Read* b;
+    uint32_t b_lo;
+    uint32_t b_hi;
+    bool b_rc;
+  };
+
+  struct ParserContext {
+    const ReadSet* reads;
+    std::unordered_map<std::string, const Read*> names;
+  };
+
+  // parses the line [ptr, end> and returns false if it is malformed
+  using LineParser = bool(*)(OverlapRecord&, const char*, const char*, const ParserContext&);
+
+  inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  inline const char* skipBlanks(const char* ptr, const char* end) {
+    while (ptr < end && isBlank(*ptr)) ++ptr;
+    return ptr;
+  }
+
+  inline bool parseToken(const char*& ptr, const char* end, const char** token,
+      uint32_t* token_length) {
+
+    ptr = skipBlanks(ptr, end);
+
+    const char* begin = ptr;
+    while (ptr < end && !isBlank(*ptr)) ++ptr;
+
+    *token = begin;
+    *token_length = ptr - begin;
+
+    return ptr != begin;
+  }
+
+  inline bool skipToken(const char*& ptr, const char* end) {
+    const char* token;
+    uint32_t token_length;
+    return parseToken(ptr, end, &token, &token_length);
+  }
+
+  inline bool parseUint(const char*& ptr, const char* end, uint32_t* dst) {
+
+    ptr = skipBlanks(ptr, end);
+
+    const char* begin = ptr;
+    uint64_t value = 0;
+
+    while (ptr < end && *ptr >= '0' && *ptr <= '9' && value <= UINT32_MAX) {
+      value = value * 10 + (*ptr - '0');
+      ++ptr;
+    }
+
+    *dst = value;
+
+    return ptr != begin && value <= UINT32_MAX && (ptr == end || isBlank(*ptr));
+  }
+
+  inline bool parseMhapRead(const char*& ptr, const char* end, const ParserContext& context,
+      const Read** dst) {
+
+    uint32_t id;
+    if (!parseUint(ptr, end, &id) || id == 0 || id > context.reads->size()) return false;
+
+    *dst = (*context.reads)[id - 1];
+    return true;
+  }
+
+  inline bool parsePafRead(const char*& ptr, const char* end, const ParserContext& context,
+      const Read** dst) {
+
+    const char* name;
+    uint32_t name_length;
+    if (!parseToken(ptr, end, &name, &name_length)) return false;
+
+    auto it = context.names.find(std::string(name, name_length));
+    if (it == context.names.end()) return false;
+
+    *dst = it->second;
+    return true;
+  }
+
+  bool parseMhapLine(OverlapRecord& dst, const char* ptr, const char* end,
+      const ParserContext& context) {
+
+    uint32_t a_rc, a_len, b_rc, b_len;
+
+    // jaccard score and shared minmers are not used
+    if (!parseMhapRead(ptr, end, context, &dst.a) || !parseMhapRead(ptr, end, context, &dst.b) ||
+        !skipToken(ptr, end) || !skipToken(ptr, end) ||
+        !parseUint(ptr, end, &a_rc) || !parseUint(ptr, end, &dst.a_lo) ||
+        !parseUint(ptr, end, &dst.a_hi) || !parseUint(ptr, end, &a_len) ||
+        !parseUint(ptr, end, &b_rc) || !parseUint(ptr, end, &dst.b_lo) ||
+        !parseUint(ptr, end, &dst.b_hi) || !parseUint(ptr, end, &b_len) || a_rc != 0) {
+      return false;
+    }
+
+    // update params to fit Overlap
+    dst.a_hi += 1;
+    dst.b_rc = b_rc != 0;
+
+    if (dst.b_rc) {
+      auto tmp = dst.b_lo;
+      dst.b_lo = b_len - (dst.b_hi + 1);
+      dst.b_hi = b_len - tmp;
+    } else {
+      dst.b_hi += 1;
+    }
+
+    return true;
+  }
+
+  bool parsePafLine(OverlapRecord& dst, const char* ptr, const char* end,
+      const ParserContext& context) {
+
+    uint32_t a_len, b_len, b_lo, b_hi;
+    const char* strand;
+    uint32_t strand_length;
+
+    // residue matches, block length, mapping quality and tags are not used
+    if (!parsePafRead(ptr, end, context, &dst.a) || !parseUint(ptr, end, &a_len) ||
+        !parseUint(ptr, end, &dst.a_lo) || !parseUint(ptr, end, &dst.a_hi) ||
+        !parseToken(ptr, end, &strand, &strand_length) || strand_length != 1 ||
+        (*strand != '+' && *strand != '-') ||
+        !parsePafRead(ptr, end, context, &dst.b) || !parseUint(ptr, end, &b_len) ||
+        !parseUint(ptr, end, &b_lo) || !parseUint(ptr, end, &b_hi) || b_hi > b_len) {
+      return false;
+    }
+
+    // target coordinates are on the forward strand, end exclusive
+    dst.b_rc = *strand == '-';
+    dst.b_lo = dst.b_rc ? b_len - b_hi : b_lo;
+    dst.b_hi = dst.b_rc ? b_len - b_lo : b_hi;
+
+    return true;
+  }
+
+  inline const char* nextLine(const char* ptr, const char* end) {
+    const char* newline = (const char*) memchr(ptr, '\n', end - ptr);
+    return newline == nullptr ? end : newline + 1;
+  }
+
+  // first line which starts at or after ptr
+  inline const char* alignToLine(const char* ptr, const char* data, const char* end) {
+    return ptr == data || ptr[-1] == '\n' ? ptr : nextLine(ptr, end);
+  }
+
+  // parses lines which start in [begin, end>
+  void parseLines(std::vector<OverlapRecord>& dst, const char* begin, const char* end,
+      const char* data, const char* data_end, LineParser parse,
+      const ParserContext& context, const char* format) {
+
+    const char* ptr = alignToLine(begin, data, data_end);
+    end = alignToLine(end, data, data_end);
+
+    while (ptr < end) {
+
+      const char* line_end = nextLine(ptr, data_end);
+      const char* line = skipBlanks(ptr, line_end);
+
+      if (line < line_end && *line != '\n') {
+        OverlapRecord record;
+        ASSERT(parse(record, line, line_end - (line_end[-1] == '\n'), context),
+            "MhapParser", "invalid %s line: %.*s", format,
+            (int) (line_end - line - (line_end[-1] == '\n')), line);
+        dst.push_back(record);
+      }
+
+      ptr = line_end;
+    }
+  }
+
+  void createOverlaps(Overlap** dst, const std::vector<OverlapRecord>& records) {
+
+    for (uint32_t i = 0; i < records.size(); ++i) {
+      const auto& it = records[i];
+      dst[i] = new Overlap(it.a, it.a_lo, it.a_hi, false, it.b, it.b_lo, it.b_hi, it.b_rc);
+    }
+  }
+
+  int readOverlaps(OverlapSet& dst, const char* path, int threadLen, LineParser parse,
+      const ParserContext& context, const char* format) {
+
+    ASSERT(threadLen > 0, "MhapParser", "invalid thread number");
+
+    Timer timer;
+    timer.start();
+
+    size_t length;
+    const char* data = mapFile(path, &length);
+
+    // at least 64KB per thread
+    threadLen = std::max<size_t>(1, std::min<size_t>(threadLen, length >> 16));
+
+    std::vector<std::vector<OverlapRecord>> records(threadLen);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadLen; ++i) {
+      threads.emplace_back(parseLines, std::ref(records[i]), data + length * i / threadLen,
+          data + length * (i + 1) / threadLen, data, data + length, parse,
+          std::cref(context), format);
+    }
+
+    for (auto& it : threads) {
+      it.join();
+    }
+
+    unmapFile(data, length);
+
+    // overlaps are created in place, in file order
+    size_t begin = dst.size();
+    std::vector<size_t> offsets(1, begin);
+    for (const auto& it : records) {
+      offsets.push_back(offsets.back() + it.size());
+    }
+
+    dst.resize(offsets.back());
+    threads.clear();
+
+    for (int i = 0; i < threadLen; ++i) {
+      threads.emplace_back(createOverlaps, dst.data() + offsets[i], std::cref(records[i]));
+    }
+
+    for (auto& it : threads) {
+      it.join();
+    }
+
+    timer.stop();
+    timer.print("MhapParser", (std::string(format) + " input").c_str());
+
+    return offsets.back() - begin;
+  }
+}
+
 namespace MHAP {
 
   int read_overlaps(OverlapSet& overlaps, const ReadSet& reads, istream& input) {
@@ -24,6 +267,10 @@ namespace MHAP {
       input >> a_rc >> a_lo >> a_hi >> a_len;
       input >> b_rc >> b_lo >> b_hi >> b_len;
 
+      if (input.fail()) {
+        break;
+      }
+
       // update params to fit Overlap
       a_hi += 1;
       if (b_rc) {
@@ -39,14 +286,34 @@ namespace MHAP {
           reads[b_id - 1], b_lo, b_hi, b_rc
       );
 
-      if (input.fail()) {
-        break;
-      }
-
       overlaps.push_back(overlap);
       read++;
     }
 
     return read;
   }
+
+  int read_overlaps(OverlapSet& dst, const ReadSet& reads, const char* path, int threadLen) {
+
+    ParserContext context;
+    context.reads = &reads;
+
+    return readOverlaps(dst, path, threadLen, parseMhapLine, context, "mhap");
+  }
+}
+
+namespace PAF {
+
+  int read_overlaps(OverlapSet& dst, const ReadSet& reads, const char* path, int threadLen) {
+
+    ParserContext context;
+    context.reads = &reads;
+
+    for (const auto& it : reads) {
+      const auto& name = it->name();
+      context.names.emplace(name.substr(0, name.find_first_of(" \t")), it);
+    }
+
+    return readOverlaps(dst, path, threadLen, parsePafLine, context, "paf");
+  }
 }
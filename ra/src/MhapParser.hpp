@@ -15,6 +15,40 @@ namespace MHAP {
 
   int read_overlaps(OverlapSet& dst, const ReadSet& reads, istream& input);
 
+  /*!
+   * @brief Method for MHAP overlaps input
+   * @details The file is memory mapped and split into line aligned chunks
+   * which are parsed in parallel. Overlaps are appended to dst in file order
+   * regardless of the number of threads.
+   *
+   * @param [out] dst vector of Overlap objects pointers
+   * @param [in] reads reads referenced by (1-based) MHAP identifiers
+   * @param [in] path path to MHAP file
+   * @param [in] threadLen number of threads
+   * @return number of overlaps read
+   */
+  int read_overlaps(OverlapSet& dst, const ReadSet& reads, const char* path,
+      int threadLen = 1);
+
+}
+
+namespace PAF {
+
+  /*!
+   * @brief Method for PAF overlaps input
+   * @details Parses pairwise mapping format (e.g. minimap output) in the same
+   * way as MHAP::read_overlaps. Query and target names are matched against
+   * read names up to the first whitespace, query is read A and target read B.
+   *
+   * @param [out] dst vector of Overlap objects pointers
+   * @param [in] reads reads referenced by names
+   * @param [in] path path to PAF file
+   * @param [in] threadLen number of threads
+   * @return number of overlaps read
+   */
+  int read_overlaps(OverlapSet& dst, const ReadSet& reads, const char* path,
+      int threadLen = 1);
+
 }
 
 #endif
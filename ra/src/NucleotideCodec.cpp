@@ -0,0 +1,348 @@
+/*!
+ * @file NucleotideCodec.cpp
+ *
+ * @brief Nucleotide codec methods source file
+ */
+
+#include "NucleotideCodec.hpp"
+
+#if defined(__SSE2__)
+#define RA_CODEC_X86
+#include <immintrin.h>
+#endif
+
+enum class CodecLevel {
+    kScalar,
+    kSSE2,
+    kAVX2
+};
+
+static CodecLevel detectCodecLevel() {
+#ifdef RA_CODEC_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return CodecLevel::kAVX2;
+    if (__builtin_cpu_supports("sse2")) return CodecLevel::kSSE2;
+#endif
+    return CodecLevel::kScalar;
+}
+
+static CodecLevel codecLevel() {
+    static const CodecLevel level = detectCodecLevel();
+    return level;
+}
+
+//*****************************************************************************
+// scalar
+
+static inline char complementBase(char c) {
+
+    switch (c) {
+        case 'A':
+            return 'T';
+        case 'T':
+            return 'A';
+        case 'C':
+            return 'G';
+        case 'G':
+            return 'C';
+        default:
+            return c;
+    }
+}
+
+static uint32_t normalizeScalar(char* dst, const char* src, uint32_t length) {
+
+    uint32_t j = 0;
+
+    for (uint32_t i = 0; i < length; ++i) {
+        char c = src[i];
+        if (c >= 'a' && c <= 'z') {
+            dst[j++] = c - 'a' + 'A';
+        } else if (c >= 'A' && c <= 'Z') {
+            dst[j++] = c;
+        }
+    }
+
+    return j;
+}
+
+static void reverseComplementScalar(char* dst, const char* src, uint32_t length) {
+
+    for (uint32_t i = 0; i < length; ++i) {
+        dst[i] = complementBase(src[length - 1 - i]);
+    }
+}
+
+static void encodeScalar(unsigned char* dst, const char* src, uint32_t length,
+    const unsigned char* table) {
+
+    for (uint32_t i = 0; i < length; ++i) {
+        switch (src[i]) {
+            case 'A':
+                dst[i] = table[0];
+                break;
+            case 'C':
+                dst[i] = table[1];
+                break;
+            case 'G':
+                dst[i] = table[2];
+                break;
+            case 'T':
+                dst[i] = table[3];
+                break;
+            default:
+                dst[i] = table[4];
+                break;
+        }
+    }
+}
+
+#ifdef RA_CODEC_X86
+
+//*****************************************************************************
+// SSE2
+
+static inline __m128i blendSSE2(__m128i a, __m128i b, __m128i mask) {
+    return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+
+static inline __m128i reverseSSE2(__m128i x) {
+
+    x = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+// A ^ T = 0x15, C ^ G = 0x04
+static inline __m128i complementSSE2(__m128i x) {
+
+    __m128i at = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('A')),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('T')));
+    __m128i cg = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('C')),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('G')));
+
+    x = _mm_xor_si128(x, _mm_and_si128(at, _mm_set1_epi8(0x15)));
+    return _mm_xor_si128(x, _mm_and_si128(cg, _mm_set1_epi8(0x04)));
+}
+
+static uint32_t normalizeSSE2(char* dst, const char* src, uint32_t length) {
+
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i before_a = _mm_set1_epi8('a' - 1);
+    const __m128i after_z = _mm_set1_epi8('z' + 1);
+
+    uint32_t i = 0, j = 0;
+
+    for (; i + 16 <= length; i += 16) {
+
+        __m128i x = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i lower = _mm_or_si128(x, case_bit);
+        __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+            _mm_cmplt_epi8(lower, after_z));
+
+        if (_mm_movemask_epi8(is_letter) == 0xFFFF) {
+            _mm_storeu_si128((__m128i*) (dst + j), _mm_andnot_si128(case_bit, x));
+            j += 16;
+        } else {
+            j += normalizeScalar(dst + j, src + i, 16);
+        }
+    }
+
+    return j + normalizeScalar(dst + j, src + i, length - i);
+}
+
+static void reverseComplementSSE2(char* dst, const char* src, uint32_t length) {
+
+    uint32_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (src + length - i - 16));
+        _mm_storeu_si128((__m128i*) (dst + i), complementSSE2(reverseSSE2(x)));
+    }
+
+    reverseComplementScalar(dst + i, src, length - i);
+}
+
+static void encodeSSE2(unsigned char* dst, const char* src, uint32_t length,
+    const unsigned char* table) {
+
+    const __m128i bases[] = { _mm_set1_epi8('A'), _mm_set1_epi8('C'),
+        _mm_set1_epi8('G'), _mm_set1_epi8('T') };
+    const __m128i codes[] = { _mm_set1_epi8(table[0]), _mm_set1_epi8(table[1]),
+        _mm_set1_epi8(table[2]), _mm_set1_epi8(table[3]) };
+    const __m128i other = _mm_set1_epi8(table[4]);
+
+    uint32_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+
+        __m128i x = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i r = other;
+
+        for (int b = 0; b < 4; ++b) {
+            r = blendSSE2(r, codes[b], _mm_cmpeq_epi8(x, bases[b]));
+        }
+
+        _mm_storeu_si128((__m128i*) (dst + i), r);
+    }
+
+    encodeScalar(dst + i, src + i, length - i, table);
+}
+
+//*****************************************************************************
+// AVX2
+
+#define RA_AVX2 __attribute__((target("avx2")))
+
+RA_AVX2 static inline __m256i reverseAVX2(__m256i x) {
+
+    const __m256i mask = _mm256_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+    x = _mm256_shuffle_epi8(x, mask);
+    return _mm256_permute2x128_si256(x, x, 1);
+}
+
+RA_AVX2 static inline __m256i complementAVX2(__m256i x) {
+
+    __m256i at = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('A')),
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('T')));
+    __m256i cg = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('C')),
+        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('G')));
+
+    x = _mm256_xor_si256(x, _mm256_and_si256(at, _mm256_set1_epi8(0x15)));
+    return _mm256_xor_si256(x, _mm256_and_si256(cg, _mm256_set1_epi8(0x04)));
+}
+
+RA_AVX2 static uint32_t normalizeAVX2(char* dst, const char* src, uint32_t length) {
+
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i before_a = _mm256_set1_epi8('a' - 1);
+    const __m256i after_z = _mm256_set1_epi8('z' + 1);
+
+    uint32_t i = 0, j = 0;
+
+    for (; i + 32 <= length; i += 32) {
+
+        __m256i x = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i lower = _mm256_or_si256(x, case_bit);
+        __m256i is_letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, before_a),
+            _mm256_cmpgt_epi8(after_z, lower));
+
+        if (_mm256_movemask_epi8(is_letter) == -1) {
+            _mm256_storeu_si256((__m256i*) (dst + j), _mm256_andnot_si256(case_bit, x));
+            j += 32;
+        } else {
+            j += normalizeScalar(dst + j, src + i, 32);
+        }
+    }
+
+    return j + normalizeScalar(dst + j, src + i, length - i);
+}
+
+RA_AVX2 static void reverseComplementAVX2(char* dst, const char* src, uint32_t length) {
+
+    uint32_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (src + length - i - 32));
+        _mm256_storeu_si256((__m256i*) (dst + i), complementAVX2(reverseAVX2(x)));
+    }
+
+    reverseComplementScalar(dst + i, src, length - i);
+}
+
+RA_AVX2 static void encodeAVX2(unsigned char* dst, const char* src, uint32_t length,
+    const unsigned char* table) {
+
+    const __m256i bases[] = { _mm256_set1_epi8('A'), _mm256_set1_epi8('C'),
+        _mm256_set1_epi8('G'), _mm256_set1_epi8('T') };
+    const __m256i codes[] = { _mm256_set1_epi8(table[0]), _mm256_set1_epi8(table[1]),
+        _mm256_set1_epi8(table[2]), _mm256_set1_epi8(table[3]) };
+    const __m256i other = _mm256_set1_epi8(table[4]);
+
+    uint32_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+
+        __m256i x = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i r = other;
+
+        for (int b = 0; b < 4; ++b) {
+            r = _mm256_blendv_epi8(r, codes[b], _mm256_cmpeq_epi8(x, bases[b]));
+        }
+
+        _mm256_storeu_si256((__m256i*) (dst + i), r);
+    }
+
+    encodeScalar(dst + i, src + i, length - i, table);
+}
+
+#endif // RA_CODEC_X86
+
+//*****************************************************************************
+// dispatch
+
+uint32_t normalizeSequence(char* dst, const char* src, uint32_t length) {
+
+    switch (codecLevel()) {
+#ifdef RA_CODEC_X86
+        case CodecLevel::kAVX2:
+            return normalizeAVX2(dst, src, length);
+        case CodecLevel::kSSE2:
+            return normalizeSSE2(dst, src, length);
+#endif
+        default:
+            return normalizeScalar(dst, src, length);
+    }
+}
+
+void reverseComplementSequence(char* dst, const char* src, uint32_t length) {
+
+    switch (codecLevel()) {
+#ifdef RA_CODEC_X86
+        case CodecLevel::kAVX2:
+            reverseComplementAVX2(dst, src, length);
+            break;
+        case CodecLevel::kSSE2:
+            reverseComplementSSE2(dst, src, length);
+            break;
+#endif
+        default:
+            reverseComplementScalar(dst, src, length);
+            break;
+    }
+}
+
+void encodeSequence(unsigned char* dst, const char* src, uint32_t length,
+    const unsigned char* table) {
+
+    switch (codecLevel()) {
+#ifdef RA_CODEC_X86
+        case CodecLevel::kAVX2:
+            encodeAVX2(dst, src, length, table);
+            break;
+        case CodecLevel::kSSE2:
+            encodeSSE2(dst, src, length, table);
+            break;
+#endif
+        default:
+            encodeScalar(dst, src, length, table);
+            break;
+    }
+}
+
+const char* nucleotideCodecInstructionSet() {
+
+    switch (codecLevel()) {
+        case CodecLevel::kAVX2:
+            return "avx2";
+        case CodecLevel::kSSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
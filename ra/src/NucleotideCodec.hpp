@@ -0,0 +1,54 @@
+/*!
+ * @file NucleotideCodec.hpp
+ *
+ * @brief Nucleotide codec methods header file
+ * @details Per base kernels used on every read at load time and on every
+ * overlap during widening. SSE2 and AVX2 implementations are chosen at
+ * runtime depending on the processor, with a scalar fallback.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*!
+ * @brief Method for sequence normalization
+ * @details Converts letters to upper case and skips all other characters.
+ * dst may point to src.
+ *
+ * @param [out] dst array of at least length characters
+ * @param [in] src array of characters
+ * @param [in] length length of src
+ * @return number of characters written to dst
+ */
+uint32_t normalizeSequence(char* dst, const char* src, uint32_t length);
+
+/*!
+ * @brief Method for reverse complement construction
+ * @details Writes the reverse complement of src to dst, symbols other than
+ * ACGT are only reversed. dst and src must not overlap.
+ *
+ * @param [out] dst array of at least length characters
+ * @param [in] src array of characters
+ * @param [in] length length of src
+ */
+void reverseComplementSequence(char* dst, const char* src, uint32_t length);
+
+/*!
+ * @brief Method for sequence encoding
+ * @details Maps each character of src to a code, table holds codes for
+ * A, C, G, T and for all other symbols (in that order).
+ *
+ * @param [out] dst array of at least length codes
+ * @param [in] src array of characters
+ * @param [in] length length of src
+ * @param [in] table array of 5 codes
+ */
+void encodeSequence(unsigned char* dst, const char* src, uint32_t length,
+    const unsigned char* table);
+
+/*!
+ * @brief Getter for the instruction set used by the codec
+ * @return "avx2", "sse2" or "scalar"
+ */
+const char* nucleotideCodecInstructionSet();
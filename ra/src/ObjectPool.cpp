@@ -0,0 +1,274 @@
+/*!
+ * @file ObjectPool.cpp
+ *
+ * @brief Object pool methods source file
+ */
+
+#include "ObjectPool.hpp"
+#include "CommonHeaders.hpp"
+
+constexpr size_t kAlignment = 16;
+constexpr size_t kMaxPooledSize = 512;
+constexpr size_t kClassesSize = kMaxPooledSize / kAlignment;
+
+// objects moved between a thread and the shared lists at once
+constexpr uint32_t kBatchSize = 4096;
+
+struct PoolNode {
+    PoolNode* next;
+};
+
+struct PoolBatch {
+    PoolNode* head;
+    uint32_t size;
+};
+
+struct SharedPoolLists {
+    std::mutex mutex;
+    std::vector<PoolBatch> batches[kClassesSize];
+    std::vector<char*> slabs[kClassesSize];
+};
+
+struct ThreadPoolLists {
+    ~ThreadPoolLists();
+
+    PoolNode* heads[kClassesSize] = {};
+    uint32_t sizes[kClassesSize] = {};
+};
+
+// set while the lists of the thread exist
+static thread_local ThreadPoolLists* thread_pool_lists = nullptr;
+static thread_local bool thread_pool_exited = false;
+
+static SharedPoolLists& sharedPoolLists() {
+    // never destroyed as objects can be deleted during program exit
+    static SharedPoolLists* lists = new SharedPoolLists();
+    return *lists;
+}
+
+static ThreadPoolLists* threadPoolLists() {
+
+    if (thread_pool_lists == nullptr && !thread_pool_exited) {
+        static thread_local ThreadPoolLists lists;
+        thread_pool_lists = &lists;
+    }
+
+    return thread_pool_lists;
+}
+
+static void pushPoolBatch(uint32_t size_class, PoolBatch batch) {
+
+    auto& lists = sharedPoolLists();
+    std::unique_lock<std::mutex> lock(lists.mutex);
+
+    lists.batches[size_class].push_back(batch);
+}
+
+static PoolBatch popPoolBatch(uint32_t size_class) {
+
+    auto& lists = sharedPoolLists();
+    {
+        std::unique_lock<std::mutex> lock(lists.mutex);
+
+        auto& batches = lists.batches[size_class];
+        if (!batches.empty()) {
+            auto batch = batches.back();
+            batches.pop_back();
+            return batch;
+        }
+    }
+
+    // new slab is linked in address order so objects are created adjacently
+    size_t object_size = (size_class + 1) * kAlignment;
+    auto slab = static_cast<char*>(::operator new(kBatchSize * object_size));
+    {
+        std::unique_lock<std::mutex> lock(lists.mutex);
+        lists.slabs[size_class].push_back(slab);
+    }
+
+    for (uint32_t i = 0; i < kBatchSize; ++i) {
+        reinterpret_cast<PoolNode*>(slab + i * object_size)->next = i + 1 < kBatchSize ?
+            reinterpret_cast<PoolNode*>(slab + (i + 1) * object_size) : nullptr;
+    }
+
+    return PoolBatch { reinterpret_cast<PoolNode*>(slab), kBatchSize };
+}
+
+// splits at most size nodes from the front of a list
+static PoolBatch splitPoolBatch(PoolNode*& head, uint32_t& head_size, uint32_t size) {
+
+    PoolBatch batch = { head, 0 };
+    PoolNode* last = nullptr;
+
+    while (batch.size < size && head != nullptr) {
+        last = head;
+        head = head->next;
+        ++batch.size;
+    }
+    if (last != nullptr) {
+        last->next = nullptr;
+    }
+
+    head_size -= batch.size;
+    return batch;
+}
+
+ThreadPoolLists::~ThreadPoolLists() {
+
+    for (uint32_t i = 0; i < kClassesSize; ++i) {
+        while (heads[i] != nullptr) {
+            pushPoolBatch(i, splitPoolBatch(heads[i], sizes[i], kBatchSize));
+        }
+    }
+
+    thread_pool_lists = nullptr;
+    thread_pool_exited = true;
+}
+
+void* poolAllocate(size_t size) {
+
+    if (size == 0 || size > kMaxPooledSize) {
+        return ::operator new(size);
+    }
+
+    uint32_t size_class = (size - 1) / kAlignment;
+    auto lists = threadPoolLists();
+
+    if (lists == nullptr) {
+        auto batch = popPoolBatch(size_class);
+        if (batch.size > 1) {
+            pushPoolBatch(size_class, PoolBatch { batch.head->next, batch.size - 1 });
+        }
+        return batch.head;
+    }
+
+    if (lists->heads[size_class] == nullptr) {
+        auto batch = popPoolBatch(size_class);
+        lists->heads[size_class] = batch.head;
+        lists->sizes[size_class] = batch.size;
+    }
+
+    auto node = lists->heads[size_class];
+    lists->heads[size_class] = node->next;
+    --lists->sizes[size_class];
+
+    return node;
+}
+
+void poolDeallocate(void* ptr, size_t size) {
+
+    if (ptr == nullptr) {
+        return;
+    }
+
+    if (size == 0 || size > kMaxPooledSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    uint32_t size_class = (size - 1) / kAlignment;
+    auto node = static_cast<PoolNode*>(ptr);
+    auto lists = threadPoolLists();
+
+    if (lists == nullptr) {
+        node->next = nullptr;
+        pushPoolBatch(size_class, PoolBatch { node, 1 });
+        return;
+    }
+
+    node->next = lists->heads[size_class];
+    lists->heads[size_class] = node;
+
+    // long free lists are handed over to other threads
+    if (++lists->sizes[size_class] == 2 * kBatchSize) {
+        pushPoolBatch(size_class, splitPoolBatch(lists->heads[size_class],
+            lists->sizes[size_class], kBatchSize));
+    }
+}
+
+size_t releasePool() {
+
+    // free objects of the calling thread are handed over first
+    auto thread_lists = threadPoolLists();
+    if (thread_lists != nullptr) {
+        for (uint32_t i = 0; i < kClassesSize; ++i) {
+            while (thread_lists->heads[i] != nullptr) {
+                pushPoolBatch(i, splitPoolBatch(thread_lists->heads[i],
+                    thread_lists->sizes[i], kBatchSize));
+            }
+        }
+    }
+
+    auto& lists = sharedPoolLists();
+    std::unique_lock<std::mutex> lock(lists.mutex);
+
+    size_t released = 0;
+
+    for (uint32_t i = 0; i < kClassesSize; ++i) {
+
+        auto& slabs = lists.slabs[i];
+        auto& batches = lists.batches[i];
+        if (slabs.empty() || batches.empty()) {
+            continue;
+        }
+
+        size_t object_size = (i + 1) * kAlignment;
+        std::sort(slabs.begin(), slabs.end());
+
+        auto slabOf = [&](PoolNode* node) -> uint32_t {
+            return std::upper_bound(slabs.begin(), slabs.end(),
+                reinterpret_cast<char*>(node)) - slabs.begin() - 1;
+        };
+
+        std::vector<uint32_t> free_sizes(slabs.size(), 0);
+        for (const auto& batch: batches) {
+            for (auto node = batch.head; node != nullptr; node = node->next) {
+                ++free_sizes[slabOf(node)];
+            }
+        }
+
+        // free objects of slabs which are not released are linked again in
+        // their previous order
+        std::vector<PoolBatch> kept;
+        PoolBatch current = { nullptr, 0 };
+        PoolNode* tail = nullptr;
+
+        for (const auto& batch: batches) {
+            for (auto node = batch.head; node != nullptr;) {
+                auto next = node->next;
+                if (free_sizes[slabOf(node)] != kBatchSize) {
+                    if (tail == nullptr) {
+                        current.head = node;
+                    } else {
+                        tail->next = node;
+                    }
+                    tail = node;
+                    tail->next = nullptr;
+                    if (++current.size == kBatchSize) {
+                        kept.push_back(current);
+                        current = { nullptr, 0 };
+                        tail = nullptr;
+                    }
+                }
+                node = next;
+            }
+        }
+        if (tail != nullptr) {
+            kept.push_back(current);
+        }
+        batches.swap(kept);
+
+        uint32_t j = 0;
+        for (uint32_t k = 0; k < slabs.size(); ++k) {
+            if (free_sizes[k] == kBatchSize) {
+                ::operator delete(slabs[k]);
+                released += kBatchSize * object_size;
+            } else {
+                slabs[j++] = slabs[k];
+            }
+        }
+        slabs.resize(j);
+    }
+
+    return released;
+}
@@ -0,0 +1,45 @@
+/*!
+ * @file ObjectPool.hpp
+ *
+ * @brief Object pool methods header file
+ * @details Small objects which are created and deleted in large numbers
+ * (reads and overlaps, see DepotObject.hpp) are allocated from slabs of
+ * objects of the same size class instead of one by one. Objects created
+ * together by a thread are adjacent in memory and deleting an object only
+ * puts it on a free list of the deleting thread. Free lists are exchanged
+ * between threads in batches so the shared lists are rarely locked.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/*!
+ * @brief Method for pooled allocation
+ * @details Returns memory for an object of the given size, objects larger
+ * than 512 bytes are allocated with the global operator new.
+ *
+ * @param [in] size size of the object
+ * @return pointer to memory aligned to 16 bytes
+ */
+void* poolAllocate(size_t size);
+
+/*!
+ * @brief Method for pooled deallocation
+ * @details Releases memory returned by poolAllocate, the memory is reused
+ * for new objects and returned to the system only by releasePool.
+ *
+ * @param [in] ptr pointer returned by poolAllocate
+ * @param [in] size size passed to poolAllocate
+ */
+void poolDeallocate(void* ptr, size_t size);
+
+/*!
+ * @brief Method for pool trimming
+ * @details Returns slabs whose objects are all deleted to the system. Meant to
+ * be called after large object sets are deleted, free objects which are still
+ * kept by other running threads keep their slabs.
+ *
+ * @return number of released bytes
+ */
+size_t releasePool();
@@ -89,6 +89,10 @@ uint32_t Overlap::length() const {
 }
 
 std::string Overlap::extract_overlapped_part(uint32_t read_id) const {
+    return overlapped_part(read_id).str();
+}
+
+SequenceView Overlap::overlapped_part(uint32_t read_id) const {
 
     auto a_id = read_a_->id();
 
@@ -97,14 +101,13 @@ std::string Overlap::extract_overlapped_part(uint32_t read_id) const {
 
     if (read_id == a_id) {
         // [lo, hi>
-        return std::string(read_a_->sequence()).substr(a_lo_, a_hi_ - a_lo_);
+        return read_a_->sequence().subview(a_lo_, a_hi_ - a_lo_);
     } else {
         if (is_innie_) {
-            return reverseComplement(std::string(read_b_->sequence())).substr(
-                b_lo_, b_hi_ - b_lo_);
+            return read_b_->reverse_complement().subview(b_lo_, b_hi_ - b_lo_);
         }
 
-        return std::string(read_b_->sequence()).substr(b_lo_, b_hi_ - b_lo_);
+        return read_b_->sequence().subview(b_lo_, b_hi_ - b_lo_);
     }
 }
 
@@ -410,3 +413,18 @@ Overlap* Overlap::deserialize(const char* bytes) {
 
     return overlap;
 }
+
+Overlap* Overlap::deserialize(const char* bytes, const ReadSet& reads) {
+
+    auto overlap = deserialize(bytes);
+
+    auto id = (uint64_t) overlap->read_a_;
+    ASSERT(id < reads.size(), "Overlap", "Missing read %lu!", id);
+    overlap->read_a_ = reads[id];
+
+    id = (uint64_t) overlap->read_b_;
+    ASSERT(id < reads.size(), "Overlap", "Missing read %lu!", id);
+    overlap->read_b_ = reads[id];
+
+    return overlap;
+}
@@ -290,6 +290,15 @@ public:
      */
     std::string extract_overlapped_part(uint32_t read_id) const;
 
+    /*!
+     * @brief Getter for the overlapped part in read given by its id
+     * @details Same as extract_overlapped_part but without copying bases.
+     *
+     * @param [in] read_id identifier of read
+     * @return view of the overlapped part
+     */
+    SequenceView overlapped_part(uint32_t read_id) const;
+
     /*!
      * @brief Operator prints overlap representation
      * @details Operator prints given overlap representation to the given stream
@@ -336,7 +345,19 @@ public:
      */
     static Overlap* deserialize(const char* bytes);
 
+    /*!
+     * @brief Method for object deserialization
+     * @details Deserializes an object stored in a char array and sets its
+     * reads to reads[id] for the stored read identifiers
+     *
+     * @param [in] bytes char array where the object was serialized
+     * @param [in] reads vector of Read objects indexed by identifiers
+     * @return Overlap object pointer
+     */
+    static Overlap* deserialize(const char* bytes, const ReadSet& reads);
+
     friend Depot;
+    friend class MappedOverlap;
 
 protected:
 
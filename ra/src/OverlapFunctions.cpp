@@ -6,7 +6,8 @@
 using std::string;
 
 static void overlapReadsPart(std::vector<Overlap*>& dst, const std::vector<Read*>& reads,
-    int rk, int minOverlapLen, int threadLen, const char* path, const char* ext);
+    int rk, int minOverlapLen, int threadLen, const char* path, const char* ext,
+    ReadIndexType indexType);
 
 static bool compareOverlaps(const Overlap* left, const Overlap* right);
 
@@ -175,15 +176,15 @@ void filterTransitiveOverlaps(std::vector<Overlap*>& dst, const OverlapSet& over
 }
 
 void overlapReads(std::vector<Overlap*>& dst, std::vector<Read*>& reads, int minOverlapLen,
-    int threadLen, const char* path) {
+    int threadLen, const char* path, ReadIndexType indexType) {
 
     Timer timer;
     timer.start();
 
     std::vector<Overlap*> overlaps;
 
-    overlapReadsPart(overlaps, reads, 0, minOverlapLen, threadLen, path, ".nra");
-    overlapReadsPart(overlaps, reads, 1, minOverlapLen, threadLen, path, ".rra");
+    overlapReadsPart(overlaps, reads, 0, minOverlapLen, threadLen, path, ".nra", indexType);
+    overlapReadsPart(overlaps, reads, 1, minOverlapLen, threadLen, path, ".rra", indexType);
 
 #ifdef DEBUG
     fprintf(stderr, "[Overlap][overlaps]: number of overlaps = %zu\n", overlaps.size());
@@ -218,7 +219,8 @@ void overlapReads(std::vector<Overlap*>& dst, std::vector<Read*>& reads, int min
 }
 
 static void overlapReadsPart(std::vector<Overlap*>& dst, const std::vector<Read*>& reads,
-    int rk, int minOverlapLen, int threadLen, const char* path, const char* ext) {
+    int rk, int minOverlapLen, int threadLen, const char* path, const char* ext,
+    ReadIndexType indexType) {
 
     std::string cache = path;
     cache += ext;
@@ -227,11 +229,11 @@ static void overlapReadsPart(std::vector<Overlap*>& dst, const std::vector<Read*
 
     // load if path provided
     if (strlen(path) > 0) {
-      rindex = ReadIndex::load(cache.c_str());
+      rindex = ReadIndex::load(cache.c_str(), indexType);
     }
 
     if (rindex == nullptr) {
-        rindex = new ReadIndex(reads, rk);
+        rindex = new ReadIndex(reads, rk, threadLen, indexType);
 
         // store if path provided
         if (strlen(path) > 0) {
@@ -384,10 +386,8 @@ void stretchSuffixPrefixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   //   o-----> b
   // target = a, query = b
   *new_b_lo = 0;
-  string target = o->read_a()->sequence().substr(0, o->a_lo());
-  string query = o->read_b()->sequence().substr(0, o->b_lo());
-  std::reverse(target.begin(), target.end());
-  std::reverse(query.begin(), query.end());
+  auto target = o->read_a()->sequence().subview(0, o->a_lo()).reversed();
+  auto query = o->read_b()->sequence().subview(0, o->b_lo()).reversed();
 
   int o_edit_distance = editDistanceSHW(query, 0, target, 0, &query_used_bases);
   *new_a_lo = target.length() - query_used_bases;
@@ -411,10 +411,8 @@ void stretchPrefixSuffixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   // ooo--->   b
   // target = b, query = a
   *new_a_lo = 0;
-  string target = o->read_b()->sequence().substr(0, o->b_lo());
-  string query = o->read_a()->sequence().substr(0, o->a_lo());
-  std::reverse(target.begin(), target.end());
-  std::reverse(query.begin(), query.end());
+  auto target = o->read_b()->sequence().subview(0, o->b_lo()).reversed();
+  auto query = o->read_a()->sequence().subview(0, o->a_lo()).reversed();
 
   int o_edit_distance = editDistanceSHW(query, 0, target, 0, &query_used_bases);
   *new_b_lo = target.length() - query_used_bases;
@@ -429,7 +427,7 @@ void stretchPrefixPrefixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   // target = a, query = b
   {
     *new_b_hi = o->read_b()->length();
-    string query = o->read_b()->reverse_complement().substr(o->b_hi());
+    auto query = o->read_b()->reverse_complement().subview(o->b_hi());
     x_edit_distance = editDistanceSHW(query, 0, o->read_a()->sequence(), o->a_hi(), &query_used_bases);
     *new_a_hi = o->a_hi() + query_used_bases;
   }
@@ -439,10 +437,8 @@ void stretchPrefixPrefixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   // target = b, query = a
   {
     *new_a_lo = 0;
-    string target = o->read_b()->reverse_complement().substr(0, o->b_lo());
-    string query = o->read_a()->sequence().substr(0, o->a_lo());
-    std::reverse(target.begin(), target.end());
-    std::reverse(query.begin(), query.end());
+    auto target = o->read_b()->reverse_complement().subview(0, o->b_lo()).reversed();
+    auto query = o->read_a()->sequence().subview(0, o->a_lo()).reversed();
 
     o_edit_distance = editDistanceSHW(query, 0, target, 0, &query_used_bases);
     *new_b_lo = o->b_lo() - query_used_bases;
@@ -458,7 +454,7 @@ void stretchSuffixSuffixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   // target = b, query = a
   {
     *new_a_hi = o->read_a()->length();
-    string target = o->read_b()->reverse_complement().substr(o->b_hi());
+    auto target = o->read_b()->reverse_complement().subview(o->b_hi());
     x_edit_distance = editDistanceSHW(o->read_a()->sequence(), o->a_hi(), target, 0, &query_used_bases);
     *new_b_hi = o->b_hi() + query_used_bases;
   }
@@ -468,10 +464,8 @@ void stretchSuffixSuffixOverlap(const Overlap* o, int* new_a_lo, int* new_a_hi,
   // target = a, query = b
   {
     *new_b_lo = 0;
-    string target = o->read_a()->sequence().substr(0, o->a_lo());
-    string query = o->read_b()->reverse_complement().substr(0, o->b_lo());
-    std::reverse(target.begin(), target.end());
-    std::reverse(query.begin(), query.end());
+    auto target = o->read_a()->sequence().subview(0, o->a_lo()).reversed();
+    auto query = o->read_b()->reverse_complement().subview(0, o->b_lo()).reversed();
 
     o_edit_distance = editDistanceSHW(query, 0, target, 0, &query_used_bases);
     *new_a_lo = o->a_lo() - query_used_bases;
@@ -497,7 +491,7 @@ Overlap* forcedDovetailOverlap(const Overlap* o, bool calc_error_rates) {
     // SHW mode - gaps at query end are not penalised
     int a = tmp.a(), b = tmp.b();
     int added_edit_distance = 0,
-        orig_edit_distance = editDistance(o->extract_overlapped_part(a), o->extract_overlapped_part(b));
+        orig_edit_distance = editDistance(o->overlapped_part(a), o->overlapped_part(b));
 
     int new_a_lo = -1, new_a_hi = -1,
         new_b_lo = -1, new_b_hi = -1;
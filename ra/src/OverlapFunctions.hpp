@@ -3,6 +3,7 @@
 
 #include "Read.hpp"
 #include "Overlap.hpp"
+#include "ReadIndex.hpp"
 #include "CommonHeaders.hpp"
 
 /*!
@@ -42,9 +43,10 @@ void filterTransitiveOverlaps(std::vector<Overlap*>& dst, const std::vector<Over
  * @param [in] threadLen number of threads
  * @param [in] path path to file where the EnhancedSuffixArray objects are cached to speed up
  * future runs on the same data
+ * @param [in] indexType index structure (kFm needs less memory)
  */
 void overlapReads(std::vector<Overlap*>& dst, std::vector<Read*>& reads, int minOverlapLen,
-    int threadLen = 1, const char* cache_path = "");
+    int threadLen = 1, const char* cache_path = "", ReadIndexType indexType = ReadIndexType::kEsa);
 
 std::pair<int, int> calculateForcedHangs(uint32_t a_lo, uint32_t a_hi, uint32_t a_len,
     uint32_t b_lo, uint32_t b_hi, uint32_t b_len);
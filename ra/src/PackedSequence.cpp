@@ -0,0 +1,279 @@
+/*!
+ * @file PackedSequence.cpp
+ *
+ * @brief PackedSequence and SequenceView classes source file
+ */
+
+#include <algorithm>
+
+#include "Utils.hpp"
+#include "NucleotideCodec.hpp"
+#include "PackedSequence.hpp"
+
+static const char kBases[] = { 'A', 'C', 'G', 'T' };
+static const char kComplements[] = { 'T', 'G', 'C', 'A' };
+static const unsigned char kPackCodes[] = { 0, 1, 2, 3, 4 };
+
+static int baseCode(char c) {
+
+    switch (c) {
+        case 'A':
+            return 0;
+        case 'C':
+            return 1;
+        case 'G':
+            return 2;
+        case 'T':
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+static bool exceptionCompare(const SequenceException& e, uint32_t idx) {
+    return e.first < idx;
+}
+
+uint32_t packSequence(std::vector<uint64_t>& words,
+    std::vector<SequenceException>& exceptions, const char* data,
+    uint32_t length, bool normalize) {
+
+    // bases are normalized and encoded in chunks by the vectorized codec
+    const uint32_t kChunkSize = 4096;
+    char buffer[kChunkSize];
+    unsigned char codes[kChunkSize];
+
+    uint32_t packed = 0;
+    uint64_t word = 0;
+
+    for (uint32_t i = 0; i < length; i += kChunkSize) {
+
+        const char* chunk = data + i;
+        uint32_t chunk_length = std::min(kChunkSize, length - i);
+
+        if (normalize) {
+            chunk_length = normalizeSequence(buffer, chunk, chunk_length);
+            chunk = buffer;
+        }
+
+        encodeSequence(codes, chunk, chunk_length, kPackCodes);
+
+        for (uint32_t j = 0; j < chunk_length; ++j) {
+
+            uint64_t code = codes[j];
+            if (code == 4) {
+                exceptions.emplace_back(packed, chunk[j]);
+                code = 0;
+            }
+
+            word |= code << ((packed & 31) << 1);
+
+            if ((++packed & 31) == 0) {
+                words.push_back(word);
+                word = 0;
+            }
+        }
+    }
+
+    if ((packed & 31) != 0) {
+        words.push_back(word);
+    }
+
+    return packed;
+}
+
+//*****************************************************************************
+// PackedSequence
+
+PackedSequence::PackedSequence()
+        : length_(0), words_(), exceptions_() {
+}
+
+PackedSequence::PackedSequence(const char* data, uint32_t length, bool normalize)
+        : length_(0), words_(), exceptions_() {
+
+    reserve(length);
+    length_ = packSequence(words_, exceptions_, data, length, normalize);
+}
+
+void PackedSequence::reserve(uint32_t length) {
+    words_.reserve((length + 31) / 32);
+}
+
+void PackedSequence::push_back(char c) {
+
+    if ((length_ & 31) == 0) {
+        words_.push_back(0);
+    }
+
+    int code = baseCode(c);
+    if (code == -1) {
+        exceptions_.emplace_back(length_, c);
+        code = 0;
+    }
+
+    set_code(length_++, code);
+}
+
+char PackedSequence::at(uint32_t idx) const {
+    return SequenceView(this)[idx];
+}
+
+void PackedSequence::set(uint32_t idx, char c) {
+
+    ASSERT(idx < length_, "PackedSequence", "index out of range");
+
+    auto it = std::lower_bound(exceptions_.begin(), exceptions_.end(), idx,
+        exceptionCompare);
+    bool is_exception = it != exceptions_.end() && it->first == idx;
+
+    int code = baseCode(c);
+    if (code == -1) {
+        if (is_exception) {
+            it->second = c;
+        } else {
+            exceptions_.emplace(it, idx, c);
+        }
+        code = 0;
+    } else if (is_exception) {
+        exceptions_.erase(it);
+    }
+
+    set_code(idx, code);
+}
+
+size_t PackedSequence::size_in_bytes() const {
+    return words_.capacity() * sizeof(uint64_t) +
+        exceptions_.capacity() * sizeof(SequenceException);
+}
+
+//*****************************************************************************
+// SequenceView
+
+SequenceView::SequenceView()
+        : words_(nullptr), exceptions_(nullptr), exceptions_length_(0),
+        begin_(0), length_(0), reversed_(false), complemented_(false) {
+}
+
+SequenceView::SequenceView(const PackedSequence* sequence, bool reverse_complement)
+        : words_(sequence->words_.data()),
+        exceptions_(sequence->exceptions_.data()),
+        exceptions_length_(sequence->exceptions_.size()),
+        begin_(0), length_(sequence->length()),
+        reversed_(reverse_complement), complemented_(reverse_complement) {
+}
+
+SequenceView::SequenceView(const uint64_t* words, uint32_t length,
+    const SequenceException* exceptions, uint32_t exceptions_length,
+    bool reverse_complement)
+        : words_(words), exceptions_(exceptions),
+        exceptions_length_(exceptions_length), begin_(0), length_(length),
+        reversed_(reverse_complement), complemented_(reverse_complement) {
+}
+
+char SequenceView::at(uint32_t idx) const {
+
+    if (exceptions_length_ != 0) {
+        auto end = exceptions_ + exceptions_length_;
+        auto it = std::lower_bound(exceptions_, end, idx, exceptionCompare);
+        if (it != end && it->first == idx) {
+            return it->second;
+        }
+    }
+
+    return kBases[code(idx)];
+}
+
+char SequenceView::operator[](uint32_t idx) const {
+
+    char c = at(reversed_ ? begin_ + length_ - 1 - idx : begin_ + idx);
+
+    if (complemented_) {
+        int code = baseCode(c);
+        if (code != -1) c = kComplements[code];
+    }
+
+    return c;
+}
+
+SequenceView SequenceView::subview(uint32_t pos, uint32_t len) const {
+
+    ASSERT(pos <= length_, "SequenceView", "position out of range");
+
+    SequenceView view(*this);
+    view.length_ = std::min(len, length_ - pos);
+    view.begin_ = reversed_ ? begin_ + length_ - pos - view.length_ : begin_ + pos;
+
+    return view;
+}
+
+SequenceView SequenceView::reversed() const {
+
+    SequenceView view(*this);
+    view.reversed_ = !reversed_;
+
+    return view;
+}
+
+SequenceView SequenceView::reverse_complement() const {
+
+    SequenceView view(*this);
+    view.reversed_ = !reversed_;
+    view.complemented_ = !complemented_;
+
+    return view;
+}
+
+std::string SequenceView::str() const {
+
+    std::string dst(length_, '\0');
+    if (length_ > 0) copy(&dst[0]);
+
+    return dst;
+}
+
+void SequenceView::copy(char* dst) const {
+
+    if (length_ == 0) return;
+
+    const char* bases = complemented_ ? kComplements : kBases;
+
+    for (uint32_t i = 0; i < length_; ++i) {
+        dst[reversed_ ? length_ - 1 - i : i] = bases[code(begin_ + i)];
+    }
+
+    // exceptions are not affected by complementing
+    auto end = exceptions_ + exceptions_length_;
+    auto it = std::lower_bound(exceptions_, end, begin_, exceptionCompare);
+
+    for (; it != end && it->first < begin_ + length_; ++it) {
+        uint32_t i = it->first - begin_;
+        dst[reversed_ ? length_ - 1 - i : i] = it->second;
+    }
+}
+
+void SequenceView::encode(unsigned char* dst, const unsigned char* table) const {
+
+    if (length_ == 0) return;
+
+    unsigned char codes[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        codes[i] = table[complemented_ ? 3 - i : i];
+    }
+
+    for (uint32_t i = 0; i < length_; ++i) {
+        dst[reversed_ ? length_ - 1 - i : i] = codes[code(begin_ + i)];
+    }
+
+    auto end = exceptions_ + exceptions_length_;
+    auto it = std::lower_bound(exceptions_, end, begin_, exceptionCompare);
+
+    for (; it != end && it->first < begin_ + length_; ++it) {
+        uint32_t i = it->first - begin_;
+        dst[reversed_ ? length_ - 1 - i : i] = table[4];
+    }
+}
+
+std::ostream& operator<<(std::ostream& str, const SequenceView& view) {
+    return str << view.str();
+}
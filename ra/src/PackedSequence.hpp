@@ -0,0 +1,323 @@
+/*!
+ * @file PackedSequence.hpp
+ *
+ * @brief PackedSequence and SequenceView classes header file
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using SequenceException = std::pair<uint32_t, char>;
+
+/*!
+ * @brief Method for sequence packing
+ * @details Appends bases from data to words starting at a new word and
+ * appends non-ACGT symbols to exceptions (positions are relative to the
+ * first appended base). If normalize is true, letters are converted to
+ * upper case and all other characters are skipped.
+ *
+ * @param [out] words array of 2-bit packed bases
+ * @param [out] exceptions array of non-ACGT symbols
+ * @param [in] data array of characters
+ * @param [in] length length of the array
+ * @param [in] normalize if true input is normalized
+ * @return number of appended bases
+ */
+uint32_t packSequence(std::vector<uint64_t>& words,
+    std::vector<SequenceException>& exceptions, const char* data,
+    uint32_t length, bool normalize);
+
+/*!
+ * @brief PackedSequence class
+ * @details Stores a nucleotide sequence with 2 bits per base (A = 0, C = 1,
+ * G = 2, T = 3). Symbols other than ACGT (e.g. N) are kept in a sparse
+ * exception list sorted by position, so their number should be small
+ * compared to the sequence length.
+ */
+class PackedSequence {
+public:
+
+    /*!
+     * @brief PackedSequence constructor
+     * @details Creates an empty PackedSequence object.
+     */
+    PackedSequence();
+
+    /*!
+     * @brief PackedSequence constructor
+     * @details Creates a PackedSequence object from an array of characters.
+     *
+     * @param [in] data array of characters
+     * @param [in] length length of the array
+     * @param [in] normalize if true letters are converted to upper case and
+     * other characters are skipped
+     */
+    PackedSequence(const char* data, uint32_t length, bool normalize = false);
+
+    /*!
+     * @brief Getter for length
+     * @return length
+     */
+    uint32_t length() const {
+        return length_;
+    }
+
+    /*!
+     * @brief Method for capacity reservation
+     *
+     * @param [in] length number of bases to reserve space for
+     */
+    void reserve(uint32_t length);
+
+    /*!
+     * @brief Method for appending a base to the end of the sequence
+     *
+     * @param [in] c base
+     */
+    void push_back(char c);
+
+    /*!
+     * @brief Getter for a base
+     *
+     * @param [in] idx position in sequence
+     * @return base at position idx
+     */
+    char at(uint32_t idx) const;
+
+    /*!
+     * @brief Setter for a base
+     *
+     * @param [in] idx position in sequence
+     * @param [in] c new base
+     */
+    void set(uint32_t idx, char c);
+
+    /*!
+     * @brief Method for memory usage retrieval
+     * @return number of bytes allocated for the sequence data
+     */
+    size_t size_in_bytes() const;
+
+    friend class SequenceView;
+
+private:
+
+    uint8_t code(uint32_t idx) const {
+        return (words_[idx >> 5] >> ((idx & 31) << 1)) & 3;
+    }
+
+    void set_code(uint32_t idx, uint8_t code) {
+        uint32_t shift = (idx & 31) << 1;
+        words_[idx >> 5] = (words_[idx >> 5] & ~(3ULL << shift)) | ((uint64_t) code << shift);
+    }
+
+    uint32_t length_;
+    std::vector<uint64_t> words_;
+    std::vector<SequenceException> exceptions_;
+};
+
+/*!
+ * @brief SequenceView class
+ * @details Lightweight read-only window over a PackedSequence which can be
+ * reversed and/or complemented on the fly. Bases are decoded on access, the
+ * underlying PackedSequence must outlive the view.
+ */
+class SequenceView {
+public:
+
+    static const uint32_t npos = -1;
+
+    /*!
+     * @brief SequenceView iterator
+     */
+    class const_iterator {
+    public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef char value_type;
+        typedef int64_t difference_type;
+        typedef const char* pointer;
+        typedef char reference;
+
+        const_iterator(const SequenceView* view, uint32_t idx)
+            : view_(view), idx_(idx) {
+        }
+
+        char operator*() const { return (*view_)[idx_]; }
+        const_iterator& operator++() { ++idx_; return *this; }
+        const_iterator& operator--() { --idx_; return *this; }
+        const_iterator operator++(int) { auto tmp = *this; ++idx_; return tmp; }
+        const_iterator operator--(int) { auto tmp = *this; --idx_; return tmp; }
+        const_iterator& operator+=(difference_type n) { idx_ += n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(view_, idx_ + n); }
+        difference_type operator-(const const_iterator& other) const {
+            return (difference_type) idx_ - (difference_type) other.idx_;
+        }
+        bool operator==(const const_iterator& other) const { return idx_ == other.idx_; }
+        bool operator!=(const const_iterator& other) const { return idx_ != other.idx_; }
+
+    private:
+
+        const SequenceView* view_;
+        uint32_t idx_;
+    };
+
+    /*!
+     * @brief SequenceView constructor
+     * @details Creates an empty SequenceView object.
+     */
+    SequenceView();
+
+    /*!
+     * @brief SequenceView constructor
+     * @details Creates a SequenceView object over the whole sequence.
+     *
+     * @param [in] sequence PackedSequence object pointer
+     * @param [in] reverse_complement if true the view is reverse complemented
+     */
+    SequenceView(const PackedSequence* sequence, bool reverse_complement = false);
+
+    /*!
+     * @brief SequenceView constructor
+     * @details Creates a SequenceView object over raw packed data, words must
+     * start with the first base and exceptions must be sorted by position.
+     *
+     * @param [in] words array of 2-bit packed bases
+     * @param [in] length number of bases
+     * @param [in] exceptions array of non-ACGT symbols
+     * @param [in] exceptions_length number of non-ACGT symbols
+     * @param [in] reverse_complement if true the view is reverse complemented
+     */
+    SequenceView(const uint64_t* words, uint32_t length,
+        const SequenceException* exceptions, uint32_t exceptions_length,
+        bool reverse_complement = false);
+
+    /*!
+     * @brief Getter for length
+     * @return length
+     */
+    uint32_t length() const {
+        return length_;
+    }
+
+    /*!
+     * @brief Getter for length
+     * @return length
+     */
+    uint32_t size() const {
+        return length_;
+    }
+
+    /*!
+     * @brief Method for emptiness check
+     * @return true if the view has no bases
+     */
+    bool empty() const {
+        return length_ == 0;
+    }
+
+    /*!
+     * @brief Getter for a base
+     *
+     * @param [in] idx position in view
+     * @return base at position idx
+     */
+    char operator[](uint32_t idx) const;
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, length_);
+    }
+
+    /*!
+     * @brief Method for view narrowing
+     * @details Behaves like std::string::substr but creates no copy.
+     *
+     * @param [in] pos position of the first base
+     * @param [in] len number of bases (clamped to the end of view)
+     * @return SequenceView of the given range
+     */
+    SequenceView subview(uint32_t pos, uint32_t len = npos) const;
+
+    /*!
+     * @brief Getter for reversed (not complemented) view
+     * @return reversed view
+     */
+    SequenceView reversed() const;
+
+    /*!
+     * @brief Getter for reverse complemented view
+     * @return reverse complemented view
+     */
+    SequenceView reverse_complement() const;
+
+    /*!
+     * @brief Method for substring extraction
+     *
+     * @param [in] pos position of the first base
+     * @param [in] len number of bases (clamped to the end of view)
+     * @return string containing the given range
+     */
+    std::string substr(uint32_t pos, uint32_t len = npos) const {
+        return subview(pos, len).str();
+    }
+
+    /*!
+     * @brief Method for sequence decoding
+     * @return string containing the whole view
+     */
+    std::string str() const;
+
+    operator std::string() const {
+        return str();
+    }
+
+    /*!
+     * @brief Method for sequence decoding
+     * @details Writes length() characters to dst.
+     *
+     * @param [out] dst char array
+     */
+    void copy(char* dst) const;
+
+    /*!
+     * @brief Method for sequence encoding
+     * @details Writes length() codes to dst, table holds codes for A, C, G, T
+     * and for all other symbols (in that order).
+     *
+     * @param [out] dst array of codes
+     * @param [in] table array of 5 codes
+     */
+    void encode(unsigned char* dst, const unsigned char* table) const;
+
+private:
+
+    uint8_t code(uint32_t idx) const {
+        return (words_[idx >> 5] >> ((idx & 31) << 1)) & 3;
+    }
+
+    char at(uint32_t idx) const;
+
+    const uint64_t* words_;
+    const SequenceException* exceptions_;
+    uint32_t exceptions_length_;
+    uint32_t begin_;
+    uint32_t length_;
+    bool reversed_;
+    bool complemented_;
+};
+
+/*!
+ * @brief Operator prints decoded view to the given stream
+ */
+std::ostream& operator<<(std::ostream& str, const SequenceView& view);
@@ -25,16 +25,16 @@ extern std::string consensus(const Contig* contig, const std::vector<Read*>& rea
     }
 
     auto& first = contig->getParts().front();
-    POA::Graph graph(first.type() ? reads[first.src]->reverse_complement() : reads[first.src]->sequence(), "seq0");
+    POA::Graph graph((first.type() ? reads[first.src]->reverse_complement() : reads[first.src]->sequence()).str(), "seq0");
 
     for (int i = 1; i < size; ++i) {
       const auto& curr = contig->getParts()[i];
-      const auto& curr_seq = curr.type() ? reads[curr.src]->reverse_complement() : reads[curr.src]->sequence();
+      std::string curr_seq = (curr.type() ? reads[curr.src]->reverse_complement() : reads[curr.src]->sequence()).str();
       const int offset = std::max((int) (curr.offset - THRESHOLD * curr_seq.length()), (int) (BAND_PERCENTAGE * curr_seq.length()));
 
       Timer t;
       t.start();
-      POA::Alignment aln(const_cast<string&>(curr_seq), graph);
+      POA::Alignment aln(curr_seq, graph);
       aln.align_banded_starting_at(offset, BAND_PERCENTAGE * curr_seq.length());
       t.stop();
       t.print("consensus", "poa");
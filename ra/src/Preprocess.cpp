@@ -58,7 +58,7 @@ static bool correctBase(int i, int suffix, std::string& sequence, int k, int c,
 
 static bool correctRead(Read* read, int k, int c, const ReadIndex* rindex) {
 
-    std::string sequence(read->sequence());
+    std::string sequence = read->sequence().str();
 
     std::vector<int> positions;
     std::vector<char> chars;
@@ -154,7 +154,7 @@ static void learnCutoff(int* c, int k, const std::vector<Read*>& reads, const Re
 
     for (const auto& it : samples) {
 
-        const char* sequence = it->sequence().c_str();
+        std::string sequence = it->sequence().str();
         int nk = it->length() - k + 1;
 
         for (int i = 0; i < nk; ++i) {
@@ -302,7 +302,8 @@ void KmerDistribution::toCountVector(std::vector<int>& dst, int max) const {
     }
 }
 
-bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const char* path) {
+bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const char* path,
+    ReadIndexType indexType) {
 
     Timer timer;
     timer.start();
@@ -310,10 +311,10 @@ bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const
     std::string cache = path;
     cache += ".cra";
 
-    ReadIndex* rindex = ReadIndex::load(cache.c_str());
+    ReadIndex* rindex = ReadIndex::load(cache.c_str(), indexType);
 
     if (rindex == nullptr) {
-        rindex = new ReadIndex(reads, 0);
+        rindex = new ReadIndex(reads, 0, threadLen, indexType);
         rindex->store(cache.c_str());
     }
 
@@ -368,12 +369,13 @@ bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const
     return readsCorrectedTotal == 0 ? false : true;
 }
 
-bool filterReads(std::vector<Read*>& dst, std::vector<Read*>& reads, bool view) {
+bool filterReads(std::vector<Read*>& dst, std::vector<Read*>& reads, bool view,
+    ReadIndexType indexType) {
 
     Timer timer;
     timer.start();
 
-    ReadIndex* rindex = new ReadIndex(reads);
+    ReadIndex* rindex = new ReadIndex(reads, 0, 1, indexType);
 
     std::vector<bool> duplicates(reads.size(), false);
     std::vector<int> equals;
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "Read.hpp"
+#include "ReadIndex.hpp"
 #include "CommonHeaders.hpp"
 
 /*!
@@ -99,8 +100,10 @@ private:
  * @param [in] c threshold for solid k-mers (if -1 it is learned from reads)
  * @param [in] path path to file where the EnhancedSuffixArray objects are cached to speed up
  * future runs on the same data
+ * @param [in] indexType index structure (kFm needs less memory)
  */
-bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const char* path);
+bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const char* path,
+    ReadIndexType indexType = ReadIndexType::kEsa);
 
 /*!
  * @brief Method for duplicate read filtering
@@ -110,5 +113,7 @@ bool correctReads(std::vector<Read*>& reads, int k, int c, int threadLen, const
  * @param [out] dst vector of non duplicate Read object pointers
  * @param [in] reads vector of Read object pointers
  * @param [in] view if true Read objects are not cloned to dst
+ * @param [in] indexType index structure (kFm needs less memory)
  */
-bool filterReads(std::vector<Read*>& dst, std::vector<Read*>& reads, bool view = true);
+bool filterReads(std::vector<Read*>& dst, std::vector<Read*>& reads, bool view = true,
+    ReadIndexType indexType = ReadIndexType::kEsa);
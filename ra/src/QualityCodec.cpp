@@ -0,0 +1,67 @@
+/*!
+ * @file QualityCodec.cpp
+ *
+ * @brief Quality codec methods source file
+ */
+
+#include "QualityCodec.hpp"
+
+static const char kLevels[] = { 0, 6, 15, 22, 27, 33, 37, 40 };
+static const uint32_t kMaxRun = 32;
+
+static uint32_t qualityLevel(char quality) {
+
+    int phred = quality - '!';
+
+    if (phred < 2) return 0;
+    if (phred < 10) return 1;
+    if (phred < 20) return 2;
+    if (phred < 25) return 3;
+    if (phred < 30) return 4;
+    if (phred < 35) return 5;
+    if (phred < 40) return 6;
+    return 7;
+}
+
+char binQuality(char quality) {
+    return '!' + kLevels[qualityLevel(quality)];
+}
+
+uint32_t encodeBinnedQualities(char* dst, const char* src, uint32_t length) {
+
+    uint32_t j = 0;
+
+    for (uint32_t i = 0; i < length;) {
+
+        uint32_t level = qualityLevel(src[i]);
+        uint32_t run = 1;
+
+        while (i + run < length && run < kMaxRun && qualityLevel(src[i + run]) == level) {
+            ++run;
+        }
+
+        dst[j++] = (char) ((level << 5) | (run - 1));
+        i += run;
+    }
+
+    return j;
+}
+
+void decodeBinnedQualities(std::string& dst, const char* src, uint32_t length) {
+
+    for (uint32_t i = 0; i < length; ++i) {
+        unsigned char c = src[i];
+        dst.append((c & 31) + 1, '!' + kLevels[c >> 5]);
+    }
+}
+
+uint32_t binnedQualitiesLength(const char* src, uint32_t length) {
+
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < length; ++i) {
+        total += (((unsigned char) src[i]) & 31) + 1;
+    }
+
+    return total;
+}
@@ -0,0 +1,62 @@
+/*!
+ * @file QualityCodec.hpp
+ *
+ * @brief Quality codec methods header file
+ * @details Qualities (Phred+33) can be kept raw, dropped or binned to eight
+ * levels as done by Illumina (0-1 -> 0, 2-9 -> 6, 10-19 -> 15, 20-24 -> 22,
+ * 25-29 -> 27, 30-34 -> 33, 35-39 -> 37, 40+ -> 40). Binned qualities are
+ * run-length encoded, each byte holding a 3-bit level and a run of up to 32
+ * bases.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/*!
+ * @brief Quality policies used on read input
+ */
+enum class QualityMode {
+    kRaw,
+    kBinned,
+    kDrop
+};
+
+/*!
+ * @brief Method for quality binning
+ *
+ * @param [in] quality Phred+33 quality
+ * @return binned Phred+33 quality
+ */
+char binQuality(char quality);
+
+/*!
+ * @brief Method for binned quality encoding
+ * @details Bins and run-length encodes src, dst needs space for length bytes.
+ *
+ * @param [out] dst array of encoded runs
+ * @param [in] src array of Phred+33 qualities
+ * @param [in] length length of src
+ * @return number of bytes written to dst
+ */
+uint32_t encodeBinnedQualities(char* dst, const char* src, uint32_t length);
+
+/*!
+ * @brief Method for binned quality decoding
+ * @details Appends the binned Phred+33 qualities to dst.
+ *
+ * @param [out] dst string of qualities
+ * @param [in] src array of encoded runs
+ * @param [in] length length of src
+ */
+void decodeBinnedQualities(std::string& dst, const char* src, uint32_t length);
+
+/*!
+ * @brief Getter for decoded length of binned qualities
+ *
+ * @param [in] src array of encoded runs
+ * @param [in] length length of src
+ * @return number of qualities
+ */
+uint32_t binnedQualitiesLength(const char* src, uint32_t length);
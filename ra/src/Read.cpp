@@ -8,87 +8,73 @@
  */
 
 #include "Utils.hpp"
+#include "ReadStore.hpp"
 #include "Read.hpp"
 
-std::vector<char> kCoder = {
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  65,  66,  67,  68,  69,
-    70,  71,  72,  73,  74,  75,  76,  77,  78,  79,
-    80,  81,  82,  83,  84,  85,  86,  87,  88,  89,
-    90,  -1,  -1,  -1,  -1,  -1,  -1,  65,  66,  67,
-    68,  69,  70,  71,  72,  73,  74,  75,  76,  77,
-    78,  79,  80,  81,  82,  83,  84,  85,  86,  87,
-    88,  89,  90,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
-    -1,  -1,  -1,  -1,  -1
-};
-
 DepotObjectType Read::type_ = DepotObjectType::kRead;
 
 Read::Read(uint32_t id, const std::string& name, const std::string& sequence,
-    const std::string& quality, double coverage)
-        : id_(id), name_(name), sequence_(), quality_(quality),
-        coverage_(coverage), reverse_complement_() {
+    const std::string& quality, double coverage, QualityMode quality_mode)
+        : id_(id), name_(name), sequence_(sequence.c_str(), sequence.size(), true),
+        quality_(quality), quality_binned_(false), coverage_(coverage) {
 
     ASSERT(name.size() > 0 && sequence.size() > 0, "Read", "invalid data");
+    ASSERT(sequence_.length() > 0, "Read", "invalid data");
 
-    sequence_.reserve(sequence.size());
-    for (uint32_t i = 0; i < sequence.size(); ++i) {
-        auto c = kCoder[sequence[i]];
-        if (c != -1) {
-            sequence_.push_back(c);
-        }
-    }
+    set_quality_mode(quality_mode);
+}
+
+std::string Read::quality() const {
 
-    create_reverse_complement();
+    if (!quality_binned_) return quality_;
 
-    ASSERT(sequence_.size() > 0, "Read", "invalid data");
+    std::string dst;
+    decodeBinnedQualities(dst, quality_.c_str(), quality_.size());
+
+    return dst;
 }
 
-Read* Read::clone() const {
+void Read::set_quality_mode(QualityMode quality_mode) {
+
+    if (quality_mode == QualityMode::kDrop) {
+        std::string().swap(quality_);
+        quality_binned_ = false;
 
-    Read* copy = new Read(id_, name_, sequence_, quality_, coverage_);
+    } else if (quality_mode == QualityMode::kBinned && !quality_binned_ &&
+        !quality_.empty()) {
 
-    if (!reverse_complement_.empty()) copy->create_reverse_complement();
+        std::string encoded(quality_.size(), '\0');
+        encoded.resize(encodeBinnedQualities(&encoded[0], quality_.c_str(),
+            quality_.size()));
 
-    return copy;
+        quality_ = encoded;
+        quality_binned_ = true;
+    }
 }
 
-void Read::correct_base(uint32_t idx, char c) {
-    sequence_[idx] = c;
+Read* Read::clone() const {
+    return new Read(*this);
 }
 
-void Read::create_reverse_complement() {
-    reverse_complement_ = reverseComplement(sequence_);
+void Read::correct_base(uint32_t idx, char c) {
+    sequence_.set(idx, c);
 }
 
-void Read::serialize(char** bytes, uint32_t* bytes_length) const {
+// binned qualities are serialized run-length encoded
+static void serializeRead(DepotObjectType type, uint32_t id, const char* name,
+    uint32_t name_length, const SequenceView& sequence, const char* quality,
+    uint32_t quality_length, bool quality_binned, double coverage, char** bytes,
+    uint32_t* bytes_length) {
 
     uint32_t uint32_size = sizeof(uint32_t);
 
     *bytes_length =
-        sizeof(type_) +
+        sizeof(type) +
         uint32_size + // id_
-        uint32_size + name_.size() +
-        uint32_size + sequence_.size() +
-        uint32_size + quality_.size() +
-        sizeof(coverage_);
+        uint32_size + name_length +
+        uint32_size + sequence.length() +
+        uint32_size + quality_length +
+        sizeof(coverage);
 
     *bytes = new char[*bytes_length]();
 
@@ -96,45 +82,72 @@ void Read::serialize(char** bytes, uint32_t* bytes_length) const {
     uint32_t ptr = 0;
 
     // type_
-    std::memcpy(*bytes + ptr, &type_, sizeof(type_));
-    ptr += sizeof(type_);
+    std::memcpy(*bytes + ptr, &type, sizeof(type));
+    ptr += sizeof(type);
 
     // id_
-    std::memcpy(*bytes + ptr, &id_, uint32_size);
+    std::memcpy(*bytes + ptr, &id, uint32_size);
     ptr += uint32_size;
 
     // name_
-    field_size = name_.size();
+    field_size = name_length;
     std::memcpy(*bytes + ptr, &field_size, uint32_size);
     ptr += uint32_size;
-    std::memcpy(*bytes + ptr, name_.c_str(), field_size);
+    std::memcpy(*bytes + ptr, name, field_size);
     ptr += field_size;
 
     // sequence_
-    field_size = sequence_.size();
+    field_size = sequence.length();
     std::memcpy(*bytes + ptr, &field_size, uint32_size);
     ptr += uint32_size;
-    std::memcpy(*bytes + ptr, sequence_.c_str(), field_size);
+    sequence.copy(*bytes + ptr);
     ptr += field_size;
 
     // quality_
-    field_size = quality_.size();
+    field_size = quality_binned ? quality_length | Read::kBinnedQualityFlag : quality_length;
     std::memcpy(*bytes + ptr, &field_size, uint32_size);
     ptr += uint32_size;
     if (field_size > 1) {
-        std::memcpy(*bytes + ptr, quality_.c_str(), field_size);
-        ptr += field_size;
+        std::memcpy(*bytes + ptr, quality, quality_length);
+        ptr += quality_length;
     }
 
     // coverage_
-    std::memcpy(*bytes + ptr, &coverage_, sizeof(coverage_));
+    std::memcpy(*bytes + ptr, &coverage, sizeof(coverage));
+}
+
+static const char* deserializeField(const char* bytes, uint32_t* ptr,
+    uint32_t* field_size) {
+
+    std::memcpy(field_size, bytes + *ptr, sizeof(uint32_t));
+    *ptr += sizeof(uint32_t);
+
+    const char* field = bytes + *ptr;
+    *ptr += *field_size;
+
+    return field;
+}
+
+void Read::serialize(char** bytes, uint32_t* bytes_length) const {
+    serializeRead(type_, id_, name_.c_str(), name_.size(), sequence(),
+        quality_.c_str(), quality_.size(), quality_binned_, coverage_, bytes,
+        bytes_length);
+}
+
+void Read::serialize(const ReadView& read, char** bytes, uint32_t* bytes_length) {
+    uint32_t quality_length;
+    bool quality_binned;
+    const char* quality = read.stored_quality(&quality_length, &quality_binned);
+
+    serializeRead(type_, read.id(), read.name(), std::strlen(read.name()),
+        read.sequence(), quality, quality_length, quality_binned, read.coverage(),
+        bytes, bytes_length);
 }
 
 Read* Read::deserialize(const char* bytes) {
 
     auto read = new Read();
 
-    uint32_t uint32_size = sizeof(uint32_t);
     uint32_t field_size;
     uint32_t ptr = 0;
 
@@ -145,25 +158,23 @@ Read* Read::deserialize(const char* bytes) {
     ptr += sizeof(DepotObjectType);
 
     // id_
-    std::memcpy(&read->id_, bytes + ptr, uint32_size);
-    ptr += uint32_size;
+    std::memcpy(&read->id_, bytes + ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
 
     // name_
-    std::memcpy(&field_size, bytes + ptr, uint32_size);
-    ptr += uint32_size;
-    read->name_ = std::string(bytes + ptr, field_size);
-    ptr += field_size;
+    const char* field = deserializeField(bytes, &ptr, &field_size);
+    read->name_ = std::string(field, field_size);
 
     // sequence_
-    std::memcpy(&field_size, bytes + ptr, uint32_size);
-    ptr += uint32_size;
-    read->sequence_ = std::string(bytes + ptr, field_size);
-    ptr += field_size;
+    field = deserializeField(bytes, &ptr, &field_size);
+    read->sequence_ = PackedSequence(field, field_size);
 
     // quality_
-    std::memcpy(&field_size, bytes + ptr, uint32_size);
-    ptr += uint32_size;
+    std::memcpy(&field_size, bytes + ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+    read->quality_binned_ = (field_size & kBinnedQualityFlag) != 0;
     if (field_size > 1) {
+        field_size &= ~kBinnedQualityFlag;
         read->quality_ = std::string(bytes + ptr, field_size);
         ptr += field_size;
     }
@@ -171,7 +182,49 @@ Read* Read::deserialize(const char* bytes) {
     // coverage_
     std::memcpy(&read->coverage_, bytes + ptr, sizeof(read->coverage_));
 
-    read->create_reverse_complement();
-
     return read;
 }
+
+void Read::deserialize(const char* bytes, ReadStore& dst) {
+
+    uint32_t field_size;
+    uint32_t ptr = 0;
+
+    // type_
+    DepotObjectType type;
+    std::memcpy(&type, bytes + ptr, sizeof(DepotObjectType));
+    ASSERT(type == type_, "Read", "Wrong object serialized in bytes array!");
+    ptr += sizeof(DepotObjectType);
+
+    // id_
+    uint32_t id;
+    std::memcpy(&id, bytes + ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+
+    // name_
+    uint32_t name_length;
+    const char* name = deserializeField(bytes, &ptr, &name_length);
+
+    // sequence_
+    uint32_t sequence_length;
+    const char* sequence = deserializeField(bytes, &ptr, &sequence_length);
+
+    // quality_
+    const char* quality = "";
+    uint32_t quality_length = 0;
+    std::memcpy(&field_size, bytes + ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+    bool quality_binned = (field_size & kBinnedQualityFlag) != 0;
+    if (field_size > 1) {
+        quality = bytes + ptr;
+        quality_length = field_size & ~kBinnedQualityFlag;
+        ptr += quality_length;
+    }
+
+    // coverage_
+    double coverage;
+    std::memcpy(&coverage, bytes + ptr, sizeof(coverage));
+
+    dst.add_encoded(id, name, name_length, sequence, sequence_length, quality,
+        quality_length, quality_binned, coverage);
+}
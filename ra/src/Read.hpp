@@ -10,9 +10,13 @@
 #pragma once
 
 #include "DepotObject.hpp"
+#include "PackedSequence.hpp"
+#include "QualityCodec.hpp"
 #include "CommonHeaders.hpp"
 
 class Read;
+class ReadView;
+class ReadStore;
 using ReadSet = std::vector<Read*>;
 
 /*!
@@ -21,8 +25,14 @@ using ReadSet = std::vector<Read*>;
 class Read: public DepotObject {
 public:
 
+    /*!
+     * @brief Read constructor
+     * @details Quality is kept raw, binned (and run-length encoded) or
+     * dropped depending on quality_mode.
+     */
     Read(uint32_t id, const std::string& name, const std::string& sequence,
-        const std::string& quality, double coverage);
+        const std::string& quality, double coverage,
+        QualityMode quality_mode = QualityMode::kRaw);
 
     /*!
      * @brief Read destructor
@@ -47,10 +57,11 @@ public:
 
     /*!
      * @brief Getter for sequence
-     * @return sequence
+     * @details Bases are stored 2-bit packed and decoded on access.
+     * @return sequence view
      */
-    const std::string& sequence() const {
-        return sequence_;
+    SequenceView sequence() const {
+        return SequenceView(&sequence_);
     }
 
     /*!
@@ -58,23 +69,32 @@ public:
      * @return length
      */
     uint32_t length() const {
-        return sequence_.size();
+        return sequence_.length();
     }
 
     /*!
      * @brief Getter for quality
+     * @details Binned qualities are decoded on access.
      * @return quality
      */
-    const std::string& quality() const {
-        return quality_;
-    }
+    std::string quality() const;
+
+    /*!
+     * @brief Setter for quality mode
+     * @details Bins or drops the quality, binned qualities stay binned if
+     * QualityMode::kRaw is set.
+     *
+     * @param [in] quality_mode quality mode
+     */
+    void set_quality_mode(QualityMode quality_mode);
 
     /*!
      * @brief Getter for reverse complement
-     * @return reverse complement
+     * @details Reverse complement is not stored, it is computed on access.
+     * @return reverse complement view
      */
-    const std::string& reverse_complement() const {
-        return reverse_complement_;
+    SequenceView reverse_complement() const {
+        return SequenceView(&sequence_, true);
     }
 
     /*!
@@ -130,9 +150,32 @@ public:
      */
     static Read* deserialize(const char* bytes);
 
-private:
+    /*!
+     * @brief Method for ReadView serialization
+     * @details Serializes a read kept in a ReadStore to a char array in the
+     * same format as Read objects
+     *
+     * @param [in] read ReadView object
+     * @param [out] bytes adress of the char array where the read is serialized
+     * @param [out] bytes_length adress of the variable holding size of the
+     * serialized read
+     */
+    static void serialize(const ReadView& read, char** bytes, uint32_t* bytes_length);
+
+    /*!
+     * @brief Method for deserialization into a ReadStore
+     * @details Deserializes a read stored in a char array and appends it to
+     * the given ReadStore without creating a Read object
+     *
+     * @param [in] bytes char array where the read was serialized
+     * @param [out] dst ReadStore object
+     */
+    static void deserialize(const char* bytes, ReadStore& dst);
 
-    void create_reverse_complement();
+    // set in the serialized quality length if qualities are binned
+    static constexpr uint32_t kBinnedQualityFlag = 1U << 31;
+
+private:
 
     Read() {};
 
@@ -140,18 +183,9 @@ private:
 
     uint32_t id_;
     std::string name_;
-    std::string sequence_;
+    PackedSequence sequence_;
+    // run-length encoded if quality_binned_ is set
     std::string quality_;
+    bool quality_binned_;
     double coverage_;
-    std::string reverse_complement_;
 };
-
-/*!
- * @brief Method for parallel reverse complement construction
- * @details Method constructs reverse complements for each read provided
- * in parralel.
- *
- * @param [in] reads vector of Read objects pointers
- * @param [in] threadLen number of threads
- */
-void createReverseComplements(std::vector<Read*>& reads, int threadLen);
@@ -0,0 +1,473 @@
+/*!
+ * @file ReadBlockCodec.cpp
+ *
+ * @brief Read block codec methods source file
+ */
+
+#include <cstring>
+#include <queue>
+#include <string>
+
+#include "Utils.hpp"
+#include "DepotObject.hpp"
+#include "PackedSequence.hpp"
+#include "Read.hpp"
+#include "ReadBlockCodec.hpp"
+
+static const uint32_t kMaxCodeLength = 12;
+static const uint32_t kAlphabetSize = 256;
+// code lengths are stored as 4-bit values
+static const uint32_t kLengthsSize = kAlphabetSize / 2;
+static const uint32_t kHuffmanHeaderSize = sizeof(uint64_t) + kLengthsSize;
+
+// meta, coverages, names, bases, exceptions and qualities
+static const uint32_t kBlockStreams = 6;
+
+template<typename T>
+static void appendValue(std::vector<char>& dst, T value) {
+    dst.insert(dst.end(), (const char*) &value, (const char*) &value + sizeof(T));
+}
+
+template<typename T>
+static T readValue(const char* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+static void appendVarint(std::vector<char>& dst, uint64_t value) {
+
+    while (value >= 128) {
+        dst.push_back((char) ((value & 127) | 128));
+        value >>= 7;
+    }
+    dst.push_back((char) value);
+}
+
+static uint64_t readVarint(const char* src, uint64_t* ptr, uint64_t length) {
+
+    uint64_t value = 0;
+
+    for (uint32_t shift = 0; ; shift += 7) {
+        ASSERT(*ptr < length && shift < 64, "ReadBlockCodec", "Invalid varint!");
+
+        unsigned char byte = src[(*ptr)++];
+        value |= (uint64_t) (byte & 127) << shift;
+
+        if (byte < 128) {
+            break;
+        }
+    }
+
+    return value;
+}
+
+// code lengths of a Huffman tree, frequencies are flattened until no code
+// is longer than kMaxCodeLength
+static void huffmanLengths(uint8_t* lengths, const uint64_t* frequencies) {
+
+    std::vector<uint64_t> weights(frequencies, frequencies + kAlphabetSize);
+
+    while (true) {
+
+        std::memset(lengths, 0, kAlphabetSize);
+
+        using Node = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+
+        for (uint32_t i = 0; i < kAlphabetSize; ++i) {
+            if (weights[i] != 0) {
+                heap.emplace(weights[i], i);
+            }
+        }
+
+        if (heap.size() < 2) {
+            if (!heap.empty()) {
+                lengths[heap.top().second] = 1;
+            }
+            return;
+        }
+
+        // inner nodes are numbered from kAlphabetSize in order of creation
+        std::vector<uint32_t> parents(2 * kAlphabetSize, 0);
+        uint32_t nodes = kAlphabetSize;
+
+        while (heap.size() > 1) {
+            auto first = heap.top();
+            heap.pop();
+            auto second = heap.top();
+            heap.pop();
+
+            parents[first.second] = nodes;
+            parents[second.second] = nodes;
+            heap.emplace(first.first + second.first, nodes++);
+        }
+
+        std::vector<uint32_t> depths(nodes, 0);
+        for (uint32_t i = nodes - 1; i-- > kAlphabetSize;) {
+            depths[i] = depths[parents[i]] + 1;
+        }
+
+        uint32_t max_length = 0;
+        for (uint32_t i = 0; i < kAlphabetSize; ++i) {
+            if (weights[i] != 0) {
+                lengths[i] = depths[parents[i]] + 1;
+                max_length = std::max<uint32_t>(max_length, lengths[i]);
+            }
+        }
+
+        if (max_length <= kMaxCodeLength) {
+            return;
+        }
+
+        for (auto& it: weights) {
+            if (it != 0) {
+                it = (it >> 1) | 1;
+            }
+        }
+    }
+}
+
+static void canonicalCodes(uint32_t* codes, const uint8_t* lengths) {
+
+    uint32_t counts[kMaxCodeLength + 1] = { 0 };
+    for (uint32_t i = 0; i < kAlphabetSize; ++i) {
+        ++counts[lengths[i]];
+    }
+    counts[0] = 0;
+
+    uint32_t next_codes[kMaxCodeLength + 1] = { 0 };
+    uint32_t code = 0;
+    for (uint32_t i = 1; i <= kMaxCodeLength; ++i) {
+        code = (code + counts[i - 1]) << 1;
+        next_codes[i] = code;
+    }
+
+    for (uint32_t i = 0; i < kAlphabetSize; ++i) {
+        if (lengths[i] != 0) {
+            codes[i] = next_codes[lengths[i]]++;
+        }
+    }
+}
+
+void encodeHuffman(std::vector<char>& dst, const char* src, uint64_t length) {
+
+    uint64_t frequencies[kAlphabetSize] = { 0 };
+    for (uint64_t i = 0; i < length; ++i) {
+        ++frequencies[(unsigned char) src[i]];
+    }
+
+    uint8_t lengths[kAlphabetSize];
+    huffmanLengths(lengths, frequencies);
+
+    uint32_t codes[kAlphabetSize];
+    canonicalCodes(codes, lengths);
+
+    appendValue<uint64_t>(dst, length);
+    for (uint32_t i = 0; i < kAlphabetSize; i += 2) {
+        dst.push_back((char) (lengths[i] | (lengths[i + 1] << 4)));
+    }
+
+    dst.reserve(dst.size() + length / 2);
+
+    // codes are written most significant bit first
+    uint64_t buffer = 0;
+    uint32_t bits = 0;
+
+    for (uint64_t i = 0; i < length; ++i) {
+        unsigned char symbol = src[i];
+        buffer = (buffer << lengths[symbol]) | codes[symbol];
+        bits += lengths[symbol];
+
+        while (bits >= 8) {
+            bits -= 8;
+            dst.push_back((char) (buffer >> bits));
+        }
+    }
+
+    if (bits != 0) {
+        dst.push_back((char) (buffer << (8 - bits)));
+    }
+}
+
+void decodeHuffman(std::vector<char>& dst, const char* src, uint64_t length) {
+
+    ASSERT(length >= kHuffmanHeaderSize, "ReadBlockCodec", "Invalid Huffman stream!");
+
+    uint64_t size = readValue<uint64_t>(src);
+
+    uint8_t lengths[kAlphabetSize];
+    for (uint32_t i = 0; i < kLengthsSize; ++i) {
+        unsigned char byte = src[sizeof(uint64_t) + i];
+        lengths[2 * i] = byte & 15;
+        lengths[2 * i + 1] = byte >> 4;
+    }
+
+    uint32_t codes[kAlphabetSize];
+    canonicalCodes(codes, lengths);
+
+    // each entry holds the symbol and the length of its code
+    std::vector<uint16_t> table(1 << kMaxCodeLength, 0);
+    for (uint32_t i = 0; i < kAlphabetSize; ++i) {
+        if (lengths[i] == 0) {
+            continue;
+        }
+        ASSERT(lengths[i] <= kMaxCodeLength, "ReadBlockCodec", "Invalid code length!");
+
+        uint32_t shift = kMaxCodeLength - lengths[i];
+        uint32_t begin = codes[i] << shift;
+        ASSERT(begin + (1U << shift) <= table.size(), "ReadBlockCodec",
+            "Invalid code lengths!");
+
+        std::fill(table.begin() + begin, table.begin() + begin + (1U << shift),
+            (uint16_t) ((i << 4) | lengths[i]));
+    }
+
+    uint64_t begin = dst.size();
+    dst.resize(begin + size);
+    char* out = dst.data() + begin;
+
+    // the next bits are kept in the upper part of buffer
+    uint64_t buffer = 0;
+    uint32_t bits = 0;
+    uint64_t ptr = kHuffmanHeaderSize;
+
+    for (uint64_t i = 0; i < size; ++i) {
+
+        while (bits <= 56) {
+            uint64_t byte = ptr < length ? (unsigned char) src[ptr] : 0;
+            buffer |= byte << (56 - bits);
+            ++ptr;
+            bits += 8;
+        }
+
+        uint16_t entry = table[buffer >> (64 - kMaxCodeLength)];
+        uint32_t code_length = entry & 15;
+        ASSERT(code_length != 0, "ReadBlockCodec", "Invalid Huffman code!");
+
+        out[i] = (char) (entry >> 4);
+        buffer <<= code_length;
+        bits -= code_length;
+    }
+
+    ASSERT(ptr - bits / 8 <= length, "ReadBlockCodec", "Truncated Huffman stream!");
+}
+
+static void appendStream(std::vector<char>& dst, const std::vector<char>& stream) {
+    appendValue<uint64_t>(dst, stream.size());
+    dst.insert(dst.end(), stream.begin(), stream.end());
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+void encodeReadBlock(std::vector<char>& dst, const std::vector<const char*>& records) {
+
+    std::vector<char> streams[kBlockStreams];
+    auto& meta = streams[0];
+    auto& coverages = streams[1];
+
+    std::string names;
+    std::string bases;
+    std::string qualities;
+
+    uint64_t raw_size = 0;
+    uint32_t previous_id = 0;
+    std::string previous_name;
+
+    for (const auto& it: records) {
+
+        // see Read::serialize
+        uint32_t ptr = 0;
+
+        DepotObjectType type = readValue<DepotObjectType>(it + ptr);
+        ASSERT(type == DepotObjectType::kRead, "ReadBlockCodec",
+            "Wrong object serialized in bytes array!");
+        ptr += sizeof(DepotObjectType);
+
+        uint32_t id = readValue<uint32_t>(it + ptr);
+        ptr += sizeof(uint32_t);
+
+        uint32_t name_length = readValue<uint32_t>(it + ptr);
+        ptr += sizeof(uint32_t);
+        const char* name = it + ptr;
+        ptr += name_length;
+
+        uint32_t sequence_length = readValue<uint32_t>(it + ptr);
+        ptr += sizeof(uint32_t);
+        const char* sequence = it + ptr;
+        ptr += sequence_length;
+
+        uint32_t field_size = readValue<uint32_t>(it + ptr);
+        ptr += sizeof(uint32_t);
+        uint32_t quality_length = field_size & ~Read::kBinnedQualityFlag;
+        if (field_size > 1) {
+            qualities.append(it + ptr, quality_length);
+            ptr += quality_length;
+        }
+
+        coverages.insert(coverages.end(), it + ptr, it + ptr + sizeof(double));
+        ptr += sizeof(double);
+
+        // names are front coded against the previous name
+        uint32_t prefix = 0;
+        while (prefix < name_length && prefix < previous_name.size() &&
+            name[prefix] == previous_name[prefix]) {
+            ++prefix;
+        }
+
+        appendVarint(meta, zigzag((int64_t) id - previous_id));
+        appendVarint(meta, prefix);
+        appendVarint(meta, name_length - prefix);
+        appendVarint(meta, sequence_length);
+        appendVarint(meta, ((uint64_t) quality_length << 1) |
+            ((field_size & Read::kBinnedQualityFlag) != 0));
+
+        names.append(name + prefix, name_length - prefix);
+        bases.append(sequence, sequence_length);
+
+        previous_id = id;
+        previous_name.assign(name, name_length);
+        raw_size += ptr;
+    }
+
+    encodeHuffman(streams[2], names.data(), names.size());
+
+    std::vector<uint64_t> words;
+    std::vector<SequenceException> exceptions;
+    packSequence(words, exceptions, bases.data(), bases.size(), false);
+
+    streams[3].assign((const char*) words.data(),
+        (const char*) (words.data() + words.size()));
+
+    uint32_t previous_position = 0;
+    for (const auto& it: exceptions) {
+        appendVarint(streams[4], it.first - previous_position);
+        streams[4].push_back(it.second);
+        previous_position = it.first;
+    }
+
+    encodeHuffman(streams[5], qualities.data(), qualities.size());
+
+    appendValue<uint64_t>(dst, records.size());
+    appendValue<uint64_t>(dst, raw_size);
+    for (const auto& it: streams) {
+        appendStream(dst, it);
+    }
+}
+
+void decodeReadBlock(ReadBlock& dst, const char* src, uint64_t length) {
+
+    ASSERT(length >= 2 * sizeof(uint64_t), "ReadBlockCodec", "Invalid read block!");
+
+    uint64_t size = readValue<uint64_t>(src);
+    uint64_t raw_size = readValue<uint64_t>(src + sizeof(uint64_t));
+
+    const char* streams[kBlockStreams];
+    uint64_t lengths[kBlockStreams];
+
+    uint64_t ptr = 2 * sizeof(uint64_t);
+    for (uint32_t i = 0; i < kBlockStreams; ++i) {
+        ASSERT(ptr + sizeof(uint64_t) <= length, "ReadBlockCodec", "Truncated read block!");
+        lengths[i] = readValue<uint64_t>(src + ptr);
+        ptr += sizeof(uint64_t);
+
+        ASSERT(ptr + lengths[i] <= length, "ReadBlockCodec", "Truncated read block!");
+        streams[i] = src + ptr;
+        ptr += lengths[i];
+    }
+
+    ASSERT(lengths[1] == size * sizeof(double), "ReadBlockCodec", "Invalid read block!");
+
+    std::vector<char> names;
+    decodeHuffman(names, streams[2], lengths[2]);
+
+    std::vector<char> qualities;
+    decodeHuffman(qualities, streams[5], lengths[5]);
+
+    const char* words = streams[3];
+    const char kBases[] = { 'A', 'C', 'G', 'T' };
+
+    dst.data.clear();
+    dst.data.reserve(raw_size);
+    dst.offsets.clear();
+    dst.offsets.reserve(size);
+
+    uint64_t meta_ptr = 0, names_ptr = 0, qualities_ptr = 0, exceptions_ptr = 0;
+    uint64_t base = 0;
+    bool has_exception = lengths[4] != 0;
+    uint64_t exception = has_exception ?
+        readVarint(streams[4], &exceptions_ptr, lengths[4]) : 0;
+
+    uint32_t id = 0;
+    std::string name;
+
+    for (uint64_t i = 0; i < size; ++i) {
+
+        id += (uint32_t) unzigzag(readVarint(streams[0], &meta_ptr, lengths[0]));
+        uint32_t prefix = readVarint(streams[0], &meta_ptr, lengths[0]);
+        uint32_t suffix = readVarint(streams[0], &meta_ptr, lengths[0]);
+        uint32_t sequence_length = readVarint(streams[0], &meta_ptr, lengths[0]);
+        uint64_t quality = readVarint(streams[0], &meta_ptr, lengths[0]);
+
+        ASSERT(prefix <= name.size() && names_ptr + suffix <= names.size(),
+            "ReadBlockCodec", "Invalid read block!");
+        ASSERT((base + sequence_length + 31) / 32 * sizeof(uint64_t) <= lengths[3],
+            "ReadBlockCodec", "Invalid read block!");
+
+        name.resize(prefix);
+        name.append(names.data() + names_ptr, suffix);
+        names_ptr += suffix;
+
+        dst.offsets.push_back(dst.data.size());
+
+        DepotObjectType type = DepotObjectType::kRead;
+        appendValue(dst.data, type);
+        appendValue<uint32_t>(dst.data, id);
+        appendValue<uint32_t>(dst.data, name.size());
+        dst.data.insert(dst.data.end(), name.begin(), name.end());
+
+        appendValue<uint32_t>(dst.data, sequence_length);
+        uint64_t sequence_begin = dst.data.size();
+        dst.data.resize(sequence_begin + sequence_length);
+        char* sequence = dst.data.data() + sequence_begin;
+
+        uint64_t word = 0;
+        for (uint32_t j = 0; j < sequence_length; ++j, ++base) {
+            if (j == 0 || (base & 31) == 0) {
+                word = readValue<uint64_t>(words + (base >> 5) * sizeof(uint64_t));
+            }
+            sequence[j] = kBases[(word >> ((base & 31) << 1)) & 3];
+        }
+
+        // exceptions hold positions relative to the first base of the block
+        while (has_exception && exception < base) {
+            ASSERT(exceptions_ptr < lengths[4], "ReadBlockCodec", "Invalid read block!");
+            sequence[exception - (base - sequence_length)] = streams[4][exceptions_ptr++];
+
+            has_exception = exceptions_ptr < lengths[4];
+            if (has_exception) {
+                exception += readVarint(streams[4], &exceptions_ptr, lengths[4]);
+            }
+        }
+
+        uint32_t quality_length = quality >> 1;
+        uint32_t field_size = quality_length | ((quality & 1) ? Read::kBinnedQualityFlag : 0);
+        appendValue<uint32_t>(dst.data, field_size);
+        if (field_size > 1) {
+            ASSERT(qualities_ptr + quality_length <= qualities.size(), "ReadBlockCodec",
+                "Invalid read block!");
+            dst.data.insert(dst.data.end(), qualities.data() + qualities_ptr,
+                qualities.data() + qualities_ptr + quality_length);
+            qualities_ptr += quality_length;
+        }
+
+        dst.data.insert(dst.data.end(), streams[1] + i * sizeof(double),
+            streams[1] + (i + 1) * sizeof(double));
+    }
+}
@@ -0,0 +1,82 @@
+/*!
+ * @file ReadBlockCodec.hpp
+ *
+ * @brief Read block codec methods header file
+ * @details Reads serialized with Read::serialize are compressed in blocks
+ * for the depot. A block is split into streams of similar data which
+ * compress well on their own: varint encoded identifier deltas and lengths,
+ * coverages, front coded names, 2-bit packed bases with their non-ACGT
+ * exceptions and qualities. Names and qualities are compressed with a
+ * canonical Huffman code with code lengths limited to 12 bits, so each
+ * symbol is decoded with a single table lookup.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/*!
+ * @brief ReadBlock struct
+ * @details Decoded block of serialized reads
+ */
+struct ReadBlock {
+
+    uint32_t size() const {
+        return offsets.size();
+    }
+
+    /*!
+     * @brief Getter for a serialized read
+     *
+     * @param [in] index index of the read in the block
+     * @return bytes the read was serialized to (see Read::serialize)
+     */
+    const char* record(uint32_t index) const {
+        return data.data() + offsets[index];
+    }
+
+    std::vector<char> data;
+    std::vector<uint64_t> offsets;
+};
+
+/*!
+ * @brief Method for Huffman encoding
+ * @details Appends the number of symbols, the code lengths and the encoded
+ * symbols of src to dst.
+ *
+ * @param [out] dst array of bytes
+ * @param [in] src array of symbols
+ * @param [in] length length of src
+ */
+void encodeHuffman(std::vector<char>& dst, const char* src, uint64_t length);
+
+/*!
+ * @brief Method for Huffman decoding
+ * @details Appends the symbols encoded with encodeHuffman to dst.
+ *
+ * @param [out] dst array of symbols
+ * @param [in] src array of bytes
+ * @param [in] length length of src
+ */
+void decodeHuffman(std::vector<char>& dst, const char* src, uint64_t length);
+
+/*!
+ * @brief Method for read block encoding
+ * @details Appends the compressed block of the given reads to dst.
+ *
+ * @param [out] dst array of bytes
+ * @param [in] records reads serialized with Read::serialize
+ */
+void encodeReadBlock(std::vector<char>& dst, const std::vector<const char*>& records);
+
+/*!
+ * @brief Method for read block decoding
+ * @details Replaces the contents of dst with the reads of a block created
+ * with encodeReadBlock, reads are serialized as by Read::serialize.
+ *
+ * @param [out] dst decoded block
+ * @param [in] src array of bytes
+ * @param [in] length length of src
+ */
+void decodeReadBlock(ReadBlock& dst, const char* src, uint64_t length);
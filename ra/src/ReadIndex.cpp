@@ -13,22 +13,24 @@
 #define E_DELIMITER '#'
 #define SUBSTITUTE "$$$$"
 
-#define FRAGMENT_SIZE 2147483645U // 2GB - 2B for sentinels
+#define FM_DELIMITER '$'
 
-static bool equalSubstr(const char* str1, int s1, int e1, const char* str2, int s2, int e2) {
+#define MAX_SIZE 2147483645U // 2GB - 2B for sentinels
+
+static bool equalSubstr(const char* str1, int64_t s1, int64_t e1, const char* str2, int64_t s2, int64_t e2) {
 
     if (e1 - s1 != e2 - s2) return false;
 
-    for (int i = 0; i <= e1 - s1; ++i) {
+    for (int64_t i = 0; i <= e1 - s1; ++i) {
         if (str1[s1 + i] != str2[s2 + i]) return false;
     }
 
     return true;
 }
 
-static int findChar(char c, const char* str, int s, int e) {
+static int64_t findChar(char c, const char* str, int64_t s, int64_t e) {
 
-    for (int i = s; i < e; ++i) {
+    for (int64_t i = s; i < e; ++i) {
         if (str[i] == c) {
             return i;
         }
@@ -37,100 +39,166 @@ static int findChar(char c, const char* str, int s, int e) {
     return -1;
 }
 
-ReadIndex::ReadIndex(const std::vector<Read*>& reads, int rk) {
+ReadIndex::ReadIndex(const std::vector<Read*>& reads, int rk, int threadLen, ReadIndexType type)
+        : esa_(nullptr), wideEsa_(nullptr), fm_(nullptr) {
+    create(reads, rk, threadLen, type);
+}
+
+ReadIndex::ReadIndex(const ReadStore& reads, int rk, int threadLen, ReadIndexType type)
+        : esa_(nullptr), wideEsa_(nullptr), fm_(nullptr) {
+    create(reads, rk, threadLen, type);
+}
+
+template<typename T>
+void ReadIndex::create(const T& reads, int rk, int threadLen, ReadIndexType type) {
 
     ASSERT(reads.size() > 0, "RI", "invalid number of input reads");
+    ASSERT(threadLen > 0, "RI", "invalid thread number");
 
     Timer timer;
     timer.start();
 
     n_ = reads.size();
 
-    std::string str = "";
+    if (type == ReadIndexType::kFm) {
+        createFm(reads, rk, threadLen);
 
-    int f = 0;
-    size_t j = 0;
+        timer.stop();
+        timer.print("RI", "construction");
+        return;
+    }
 
+    size_t len = 0;
     for (size_t i = 0; i < reads.size(); ++i) {
+        len += reads[i]->length() + 6;
+    }
 
-        if (str.size() + reads[i]->length() + 6 > FRAGMENT_SIZE) {
+    std::string str = "";
+    str.reserve(len);
 
-            fragmentSizes_.push_back(i - j);
-            fragments_.push_back(new EnhancedSuffixArray(str));
+    for (size_t i = 0; i < reads.size(); ++i) {
 
-            updateFragment(f, j, i, reads);
+        str += S_DELIMITER;
 
-            str.clear();
-            j = i;
-            ++f;
-        }
+        size_t offset = str.size();
+        str.resize(offset + reads[i]->length());
+        (rk == 0 ? reads[i]->sequence() : reads[i]->reverse_complement()).copy(&str[offset]);
 
-        str += S_DELIMITER;
-        str += rk == 0 ? reads[i]->sequence() : reads[i]->reverse_complement();
         str += E_DELIMITER;
         str += SUBSTITUTE;
     }
 
-    fragmentSizes_.push_back(reads.size() - j);
-    fragments_.push_back(new EnhancedSuffixArray(str));
-
-    updateFragment(f, j, reads.size(), reads);
+    if (len > MAX_SIZE) {
+        wideEsa_ = new EnhancedSuffixArray<int64_t>(str, threadLen);
+        updateIdentifiers(wideEsa_->getString(), reads);
+    } else {
+        esa_ = new EnhancedSuffixArray<int32_t>(str, threadLen);
+        updateIdentifiers(esa_->getString(), reads);
+    }
 
     timer.stop();
     timer.print("RI", "construction");
 }
 
-ReadIndex::~ReadIndex() {
+template<typename T>
+void ReadIndex::createFm(const T& reads, int rk, int threadLen) {
 
-    for (const auto& it : fragments_) {
-        delete it;
+    size_t len = 0;
+    for (size_t i = 0; i < reads.size(); ++i) {
+        len += reads[i]->length() + 1;
     }
+
+    // reads are reversed so that prefixes of a query are searched backwards
+    // one character at a time and read ends follow their delimiter
+    std::string str = "";
+    str.reserve(len);
+
+    for (size_t i = 0; i < reads.size(); ++i) {
+
+        str += FM_DELIMITER;
+
+        size_t offset = str.size();
+        str.resize(offset + reads[i]->length());
+        (rk == 0 ? reads[i]->sequence() : reads[i]->reverse_complement()).copy(&str[offset]);
+
+        std::reverse(str.begin() + offset, str.end());
+    }
+
+    fm_ = new FmIndex(str, FM_DELIMITER, threadLen);
+}
+
+ReadIndex::~ReadIndex() {
+    delete esa_;
+    delete wideEsa_;
+    delete fm_;
 }
 
 size_t ReadIndex::numberOfOccurrences(const char* pattern, int m) const {
 
-    if (pattern == nullptr || m <= 0) return 0;
+    if (fm_ != nullptr) return fmOccurrences(pattern, m);
 
-    size_t num = 0;
+    return esa_ != nullptr ? occurrences(esa_, pattern, m) : occurrences(wideEsa_, pattern, m);
+}
 
-    for (size_t f = 0; f < fragments_.size(); ++f) {
+template<typename I>
+size_t ReadIndex::occurrences(const EnhancedSuffixArray<I>* esa, const char* pattern, int m) const {
 
-        int i, j;
-        findInterval(&i, &j, f, pattern, m);
+    if (pattern == nullptr || m <= 0) return 0;
 
-        if (i == -1 && j == -1) continue;
+    I i, j;
+    findInterval(&i, &j, esa, pattern, m);
 
-        num += j - i + 1;
-    }
+    if (i == -1 && j == -1) return 0;
 
-    return num;
+    return j - i + 1;
 }
 
 void ReadIndex::readDuplicates(std::vector<int>& dst, const Read* read) const {
 
     if (read == nullptr) return;
 
+    sequenceDuplicates(dst, read->sequence());
+}
+
+void ReadIndex::readDuplicates(std::vector<int>& dst, const ReadView& read) const {
+    sequenceDuplicates(dst, read.sequence());
+}
+
+void ReadIndex::sequenceDuplicates(std::vector<int>& dst, const SequenceView& sequence) const {
+
+    if (fm_ != nullptr) {
+        fmDuplicates(dst, sequence.str());
+        return;
+    }
+
     std::string pattern = "";
 
     pattern += S_DELIMITER;
-    pattern += read->sequence();
+    pattern += sequence.str();
     pattern += E_DELIMITER;
 
-    int m = pattern.size();
+    if (esa_ != nullptr) {
+        sequenceDuplicates(dst, esa_, pattern);
+    } else {
+        sequenceDuplicates(dst, wideEsa_, pattern);
+    }
+}
 
-    for (size_t f = 0; f < fragments_.size(); ++f) {
+template<typename I>
+void ReadIndex::sequenceDuplicates(std::vector<int>& dst, const EnhancedSuffixArray<I>* esa,
+    const std::string& pattern) const {
 
-        int i, j;
-        findInterval(&i, &j, f, pattern.c_str(), m);
+    int m = pattern.size();
 
-        if (i == -1 && j == -1) continue;
+    I i, j;
+    findInterval(&i, &j, esa, pattern.c_str(), m);
 
-        const EnhancedSuffixArray* esa = fragments_[f];
-        const std::string& str = esa->getString();
+    if (i == -1 && j == -1) return;
 
-        for (int k = i; k <= j; ++k) {
-            dst.push_back(*((int32_t*) (str.c_str() + esa->getSuffix(k) + m)));
-        }
+    const std::string& str = esa->getString();
+
+    for (I k = i; k <= j; ++k) {
+        dst.push_back(*((int32_t*) (str.c_str() + esa->getSuffix(k) + m)));
     }
 }
 
@@ -139,75 +207,79 @@ void ReadIndex::readPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, c
 
     if (read == nullptr) return;
 
-    const std::string& pattern = rk == 0 ? read->sequence() : read->reverse_complement();
-    int m = pattern.size();
+    sequencePrefixSuffixMatches(dst, rk == 0 ? read->sequence() : read->reverse_complement(),
+        minOverlapLen);
+}
 
-    int f = 0;
+void ReadIndex::readPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, const ReadView& read,
+    int rk, int minOverlapLen) const {
 
-    for (const auto& it : fragments_) {
+    sequencePrefixSuffixMatches(dst, rk == 0 ? read.sequence() : read.reverse_complement(),
+        minOverlapLen);
+}
 
-        int i, j, c = 0;
+void ReadIndex::sequencePrefixSuffixMatches(std::vector<std::pair<int, int>>& dst,
+    const SequenceView& sequence, int minOverlapLen) const {
 
-        const std::string& str = it->getString();
+    if (fm_ != nullptr) {
+        fmPrefixSuffixMatches(dst, sequence.str(), minOverlapLen);
+    } else if (esa_ != nullptr) {
+        sequencePrefixSuffixMatches(dst, esa_, sequence.str(), minOverlapLen);
+    } else {
+        sequencePrefixSuffixMatches(dst, wideEsa_, sequence.str(), minOverlapLen);
+    }
+}
 
-        it->intervalSubInterval(&i, &j, 1 + 5 * fragmentSizes_[f++], it->getLength() - 1, pattern[c]);
+template<typename I>
+void ReadIndex::sequencePrefixSuffixMatches(std::vector<std::pair<int, int>>& dst,
+    const EnhancedSuffixArray<I>* it, const std::string& pattern, int minOverlapLen) const {
 
-        while (i != -1 && j != -1) {
+    int m = pattern.size();
 
-            if (i != j) {
-                int l = it->intervalLcpLen(i, j);
-                int del = findChar(E_DELIMITER, str.c_str(), it->getSuffix(i) + c + 1, it->getSuffix(i) + l);
+    I i, j;
+    int c = 0;
 
-                if (del == -1) {
-                    int min = l < m ? l : m;
+    const std::string& str = it->getString();
 
-                    bool found = equalSubstr(str.c_str(), it->getSuffix(i) + c, it->getSuffix(i) + min - 1,
-                        pattern.c_str(), c, min - 1);
+    it->intervalSubInterval(&i, &j, 1 + 5 * (I) n_, it->getLength() - 1, pattern[c]);
 
-                    if (!found) break;
-                    c = min;
+    while (i != -1 && j != -1) {
 
-                    if (c == m) {
-                        for (int o = i ; o <= j; ++o) {
-                            if (it->getSuffix(o) + m < it->getLength() && str[it->getSuffix(o) + m] == E_DELIMITER) {
-                                dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + m + 1)), m);
-                            }
-                        }
-                        break;
+        if (i != j) {
+            I l = it->intervalLcpLen(i, j);
+            int64_t del = findChar(E_DELIMITER, str.c_str(), it->getSuffix(i) + c + 1, it->getSuffix(i) + l);
+
+            if (del == -1) {
+                int min = l < m ? l : m;
+
+                bool found = equalSubstr(str.c_str(), it->getSuffix(i) + c, it->getSuffix(i) + min - 1,
+                    pattern.c_str(), c, min - 1);
 
-                    } else {
-                        int b, d;
-                        it->intervalSubInterval(&b, &d, i, j, E_DELIMITER);
+                if (!found) break;
+                c = min;
 
-                        if (b != -1 && d != -1 && min >= minOverlapLen) {
-                            for (int o = b; o <= d; ++o) {
-                                dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + min + 1)), min);
-                            }
+                if (c == m) {
+                    for (I o = i ; o <= j; ++o) {
+                        if (it->getSuffix(o) + m < it->getLength() && str[it->getSuffix(o) + m] == E_DELIMITER) {
+                            dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + m + 1)), m);
                         }
                     }
-
-                    it->intervalSubInterval(&i, &j, i, j, pattern[c]);
+                    break;
 
                 } else {
-                    del -= it->getSuffix(i); // len to delimeter
-                    if (del > m) break;
-
-                    bool found = equalSubstr(str.c_str(), it->getSuffix(i) + c, it->getSuffix(i) + del - 1,
-                        pattern.c_str(), c, del - 1);
+                    I b, d;
+                    it->intervalSubInterval(&b, &d, i, j, E_DELIMITER);
 
-                    if (found) {
-                        for (int o = i; o <= j; ++o) {
-                            dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + del + 1)), del);
+                    if (b != -1 && d != -1 && min >= minOverlapLen) {
+                        for (I o = b; o <= d; ++o) {
+                            dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + min + 1)), min);
                         }
                     }
-
-                    break;
                 }
 
-            } else {
-                int del = findChar(E_DELIMITER, str.c_str(), it->getSuffix(i) + c + 1, it->getLength());
-                if (del == -1) break;
+                it->intervalSubInterval(&i, &j, i, j, pattern[c]);
 
+            } else {
                 del -= it->getSuffix(i); // len to delimeter
                 if (del > m) break;
 
@@ -215,11 +287,29 @@ void ReadIndex::readPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, c
                     pattern.c_str(), c, del - 1);
 
                 if (found) {
-                    dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(i) + del + 1)), del);
+                    for (I o = i; o <= j; ++o) {
+                        dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(o) + del + 1)), del);
+                    }
                 }
 
                 break;
             }
+
+        } else {
+            int64_t del = findChar(E_DELIMITER, str.c_str(), it->getSuffix(i) + c + 1, it->getLength());
+            if (del == -1) break;
+
+            del -= it->getSuffix(i); // len to delimeter
+            if (del > m) break;
+
+            bool found = equalSubstr(str.c_str(), it->getSuffix(i) + c, it->getSuffix(i) + del - 1,
+                pattern.c_str(), c, del - 1);
+
+            if (found) {
+                dst.emplace_back(*((int32_t*) (str.c_str() + it->getSuffix(i) + del + 1)), del);
+            }
+
+            break;
         }
     }
 }
@@ -231,11 +321,14 @@ size_t ReadIndex::sizeInBytes() const {
 
     bytesLen += size; // n_
     bytesLen += size; // number of fragments
-    bytesLen += fragmentSizes_.size() * size;
+    bytesLen += size; // fragment size
 
-    for (const auto& it : fragments_) {
-        bytesLen += sizeof(size_t);
-        bytesLen += it->sizeInBytes();
+    bytesLen += sizeof(size_t);
+
+    if (fm_ != nullptr) {
+        bytesLen += fm_->sizeInBytes();
+    } else {
+        bytesLen += esa_ != nullptr ? esa_->sizeInBytes() : wideEsa_->sizeInBytes();
     }
 
     return bytesLen;
@@ -252,38 +345,43 @@ void ReadIndex::serialize(char** bytes, size_t* bytesLen) const {
     std::memcpy(*bytes + ptr, &n_, size);
     ptr += size;
 
-    int numFragments = fragments_.size();
+    // layout of older indices which were split into fragments, an FmIndex
+    // is stored as the only fragment of an EnhancedSuffixArray would be
+    int numFragments = fm_ != nullptr ? 0 : 1;
 
     std::memcpy(*bytes + ptr, &numFragments, size);
     ptr += size;
 
-    std::memcpy(*bytes + ptr, &fragmentSizes_[0], numFragments * size);
-    ptr += numFragments * size;
+    std::memcpy(*bytes + ptr, &n_, size);
+    ptr += size;
 
-    for (const auto& it : fragments_) {
+    char* bytesPart;
+    size_t bytesPartLen;
 
-        char* bytesPart;
-        size_t bytesPartLen;
-        it->serialize(&bytesPart, &bytesPartLen);
+    if (fm_ != nullptr) {
+        fm_->serialize(&bytesPart, &bytesPartLen);
+    } else if (esa_ != nullptr) {
+        esa_->serialize(&bytesPart, &bytesPartLen);
+    } else {
+        wideEsa_->serialize(&bytesPart, &bytesPartLen);
+    }
 
-        std::memcpy(*bytes + ptr, &bytesPartLen, sizeof(size_t));
-        ptr += sizeof(size_t);
+    std::memcpy(*bytes + ptr, &bytesPartLen, sizeof(size_t));
+    ptr += sizeof(size_t);
 
-        std::memcpy(*bytes + ptr, &bytesPart[0], bytesPartLen);
-        ptr += bytesPartLen;
+    std::memcpy(*bytes + ptr, &bytesPart[0], bytesPartLen);
 
-        delete[] bytesPart;
-    }
+    delete[] bytesPart;
 }
 
 ReadIndex* ReadIndex::deserialize(char* bytes) {
 
-    ReadIndex* rindex = new ReadIndex();
-
     size_t size = sizeof(int);
     size_t ptr = 0;
 
-    std::memcpy(&rindex->n_, bytes + ptr, size);
+    int n = 0;
+
+    std::memcpy(&n, bytes + ptr, size);
     ptr += size;
 
     int numFragments = 0;
@@ -291,20 +389,20 @@ ReadIndex* ReadIndex::deserialize(char* bytes) {
     std::memcpy(&numFragments, bytes + ptr, size);
     ptr += size;
 
-    rindex->fragmentSizes_.resize(numFragments);
-
-    std::memcpy(&rindex->fragmentSizes_[0], bytes + ptr, numFragments * size);
-    ptr += numFragments * size;
-
-    for (int i = 0; i < numFragments; ++i) {
-
-        size_t bytesPartLen = 0;
+    // indices split into fragments have to be created again
+    if (numFragments > 1) return nullptr;
 
-        std::memcpy(&bytesPartLen, bytes + ptr, sizeof(size_t));
-        ptr += sizeof(size_t);
+    ptr += size + sizeof(size_t);
 
-        rindex->fragments_.push_back(EnhancedSuffixArray::deserialize(bytes + ptr));
-        ptr += bytesPartLen;
+    ReadIndex* rindex = new ReadIndex();
+    rindex->n_ = n;
+
+    if (numFragments == 0) {
+        rindex->fm_ = FmIndex::deserialize(bytes + ptr);
+    } else if (isWideEnhancedSuffixArray(bytes + ptr)) {
+        rindex->wideEsa_ = EnhancedSuffixArray<int64_t>::deserialize(bytes + ptr);
+    } else {
+        rindex->esa_ = EnhancedSuffixArray<int32_t>::deserialize(bytes + ptr);
     }
 
     return rindex;
@@ -321,7 +419,7 @@ void ReadIndex::store(const char* path) const {
     delete[] bytes;
 }
 
-ReadIndex* ReadIndex::load(const char* path) {
+ReadIndex* ReadIndex::load(const char* path, ReadIndexType type) {
 
     if (!fileExists(path)) return nullptr;
 
@@ -335,26 +433,34 @@ ReadIndex* ReadIndex::load(const char* path) {
 
     delete[] bytes;
 
+    if (rindex == nullptr) return nullptr;
+
+    if (rindex->type() != type) {
+        delete rindex;
+        return nullptr;
+    }
+
     timer.stop();
     timer.print("RI", "cached construction");
 
     return rindex;
 }
 
-void ReadIndex::findInterval(int* s, int* e, int fragment, const char* pattern, int m) const {
+template<typename I>
+void ReadIndex::findInterval(I* s, I* e, const EnhancedSuffixArray<I>* esa, const char* pattern,
+    int m) const {
 
     *s = -1;
     *e = -1;
 
     if (pattern == nullptr || m <= 0) return;
 
-    const auto& esa = fragments_[fragment];
-
-    int i, j, c = 0;
+    I i, j;
+    int c = 0;
     bool found = false;
 
     const std::string& str = esa->getString();
-    int start = 1 + 5 * fragmentSizes_[fragment];
+    I start = 1 + 5 * (I) n_;
 
     esa->intervalSubInterval(&i, &j, start, esa->getLength() - 1, pattern[c]);
 
@@ -362,7 +468,7 @@ void ReadIndex::findInterval(int* s, int* e, int fragment, const char* pattern,
         found = true;
 
         if (i != j) {
-            int l = esa->intervalLcpLen(i, j);
+            I l = esa->intervalLcpLen(i, j);
             int min = l < m ? l : m;
 
             found = equalSubstr(str.c_str(), esa->getSuffix(i) + c, esa->getSuffix(i) + min - 1,
@@ -374,7 +480,7 @@ void ReadIndex::findInterval(int* s, int* e, int fragment, const char* pattern,
             esa->intervalSubInterval(&i, &j, i, j, pattern[c]);
 
         } else {
-            found = esa->getSuffix(i) + m > (int) str.size() ? false :
+            found = esa->getSuffix(i) + m > (I) str.size() ? false :
                 equalSubstr(str.c_str(), esa->getSuffix(i) + c, esa->getSuffix(i) + m - 1,
                 pattern, c, m - 1);
 
@@ -390,14 +496,76 @@ void ReadIndex::findInterval(int* s, int* e, int fragment, const char* pattern,
     }
 }
 
-void ReadIndex::updateFragment(int fragment, int start, int end, const std::vector<Read*>& reads) {
+template<typename T>
+void ReadIndex::updateIdentifiers(const std::string& str, const T& reads) {
 
-    int len = 0;
-    for (int i = start; i < end; ++i) {
+    size_t len = 0;
+    for (size_t i = 0; i < reads.size(); ++i) {
         len += reads[i]->length() + 2;
 
-        *((int32_t*) (fragments_[fragment]->getString().c_str() + len)) = i;
+        *((int32_t*) (str.c_str() + len)) = i;
 
         len += 4;
     }
 }
+
+size_t ReadIndex::fmOccurrences(const char* pattern, int m) const {
+
+    if (pattern == nullptr || m <= 0) return 0;
+
+    int64_t i = 0, j = fm_->getLength() - 1;
+
+    for (int c = 0; c < m && i != -1; ++c) {
+        fm_->intervalExtension(&i, &j, i, j, pattern[c]);
+    }
+
+    if (i == -1 && j == -1) return 0;
+
+    return j - i + 1;
+}
+
+void ReadIndex::fmDuplicates(std::vector<int>& dst, const std::string& sequence) const {
+
+    int64_t i = 0, j = fm_->getLength() - 1;
+
+    fm_->intervalExtension(&i, &j, i, j, FM_DELIMITER);
+
+    for (size_t c = 0; c < sequence.size() && i != -1; ++c) {
+        fm_->intervalExtension(&i, &j, i, j, sequence[c]);
+    }
+
+    fm_->intervalExtension(&i, &j, i, j, FM_DELIMITER);
+
+    if (i == -1 && j == -1) return;
+
+    for (int64_t k = i; k <= j; ++k) {
+        dst.push_back(fm_->getIdentifier(k));
+    }
+}
+
+void ReadIndex::fmPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst,
+    const std::string& pattern, int minOverlapLen) const {
+
+    int m = pattern.size();
+
+    int64_t i = 0, j = fm_->getLength() - 1;
+
+    for (int c = 0; c < m; ++c) {
+
+        fm_->intervalExtension(&i, &j, i, j, pattern[c]);
+        if (i == -1 && j == -1) break;
+
+        // reads which end with the first c + 1 characters of the pattern
+        int64_t b, d;
+        fm_->intervalExtension(&b, &d, i, j, FM_DELIMITER);
+        if (b == -1 && d == -1) continue;
+
+        // as in the suffix array walk, shorter matches are reported if they span the
+        // whole pattern or if the prefix occurs only at read ends
+        if (c + 1 < minOverlapLen && c + 1 < m && d - b != j - i) continue;
+
+        for (int64_t o = b; o <= d; ++o) {
+            dst.emplace_back(fm_->getIdentifier(o), c + 1);
+        }
+    }
+}
@@ -5,6 +5,8 @@
  * @details Algorithms were rewritten to c++ from following papers: \
  *     1. Title: Replacing suffix trees with enhanced suffix arrays \n
  *        Authors: Mohamed Ibrahim Abouelhoda, Stefan Kurtz, Enno Ohlebusch \n
+ *     2. Title: Efficient construction of an assembly string graph using the FM-index \n
+ *        Authors: Jared T. Simpson, Richard Durbin \n
  *
  * @author rvaser (robert.vaser@gmail.com)
  * @date May 02, 2015
@@ -14,13 +16,27 @@
 
 #include "IO.hpp"
 #include "Read.hpp"
+#include "ReadStore.hpp"
 #include "EnhancedSuffixArray.hpp"
+#include "FmIndex.hpp"
 #include "CommonHeaders.hpp"
 
+/*!
+ * @brief Index structures behind ReadIndex
+ * @details kEsa is an EnhancedSuffixArray (13n or 25n bytes), kFm is an FmIndex of
+ * reversed reads (below n/2 bytes for nucleotide data) with slower queries.
+ */
+enum class ReadIndexType {
+    kEsa,
+    kFm
+};
+
 /*!
  * @brief ReadIndex class
- * @details Wrapper for EnhancedSuffixArray objects which helps to mantain
- * the memory complexity at 13n and also implements patter search methods.
+ * @details Wrapper for an EnhancedSuffixArray or an FmIndex object which implements patter
+ * search methods. Reads up to 2GB are indexed with 32-bit positions (memory complexity 13n),
+ * larger ones with 64-bit positions (memory complexity 25n). Both index types return
+ * the same results.
  */
 class ReadIndex {
 public:
@@ -31,23 +47,46 @@ public:
      * It concatenates the reads together puting % at the begining and #$$$$ at the end
      * of each read to obtain strings for EnhancedSuffixArray construction. After the
      * construction each $$$$ string is replaced by corresponding read identifier. If reads
-     * exceed 2GB then they are split into 2GB fragments and more EnhancedSuffixArray
-     * objects are created.
+     * exceed 2GB the EnhancedSuffixArray is created with 64-bit positions. For kFm the
+     * reversed reads are concatenated, each preceded by $, into an FmIndex.
      *
      * @param [in] read vector of Read object poiters
      * @param [in] rk if true reverse complements are used
+     * @param [in] threadLen number of threads
+     * @param [in] type index structure
+     */
+    ReadIndex(const std::vector<Read*>& reads, int rk = 0, int threadLen = 1,
+        ReadIndexType type = ReadIndexType::kEsa);
+
+    /*!
+     * @brief ReadIndex consructor
+     * @details Same as above but reads are taken from a ReadStore.
+     *
+     * @param [in] reads ReadStore object
+     * @param [in] rk if true reverse complements are used
+     * @param [in] threadLen number of threads
+     * @param [in] type index structure
      */
-    ReadIndex(const std::vector<Read*>& reads, int rk = 0);
+    ReadIndex(const ReadStore& reads, int rk = 0, int threadLen = 1,
+        ReadIndexType type = ReadIndexType::kEsa);
 
     /*!
      * @brief ReadIndex destructor
      */
     ~ReadIndex();
 
+    /*!
+     * @brief Getter for index structure
+     * @return index type
+     */
+    ReadIndexType type() const {
+        return fm_ != nullptr ? ReadIndexType::kFm : ReadIndexType::kEsa;
+    }
+
     /*!
      * @brief Method for number of occurences retrieval
-     * @details For a given pattern the method returns the number of occurences in all
-     * EnhancedSuffixArray objects (complexity: O(m))
+     * @details For a given pattern the method returns the number of occurences in the
+     * index (complexity: O(m))
      *
      * @param [in] pattern query string
      * @param [in] m pattern length
@@ -65,10 +104,19 @@ public:
      */
     void readDuplicates(std::vector<int>& dst, const Read* read) const;
 
+    /*!
+     * @brief Method for duplicates search
+     * @details Same as above for a read kept in a ReadStore.
+     *
+     * @param [out] dst vector of duplicates identifiers
+     * @param [in] read ReadView object
+     */
+    void readDuplicates(std::vector<int>& dst, const ReadView& read) const;
+
     /*!
      * @brief Method for prefix suffix matches search
      * @details Method returns all prefix suffix matches between the query read and all
-     * reads in all EhancedSuffixArray objects. Only matches with length longer than the
+     * reads in the index. Only matches with length longer than the
      * minimal provided (complexity: O(m + z) where m is the length of the read
      * and z is the number of matches)
      *
@@ -80,6 +128,18 @@ public:
     void readPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, const Read* read,
         int rk, int minOverlapLen) const;
 
+    /*!
+     * @brief Method for prefix suffix matches search
+     * @details Same as above for a read kept in a ReadStore.
+     *
+     * @param [out] dst vector of match pairs (identifier, length)
+     * @param [in] read ReadView object
+     * @param [in] rk if 1 the reverse complement of read is used
+     * @param [in] minOverlapLen only matches with longer length are reported
+     */
+    void readPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, const ReadView& read,
+        int rk, int minOverlapLen) const;
+
     /*!
      * @brief Method for object size retrieval
      * @details Method returns the objects size in bytes needed for serialization.
@@ -119,8 +179,10 @@ public:
      * @details Method creates a ReadIndex object from path
      *
      * @param [in] path path to file where the object is stored
+     * @param [in] type index structure
+     * @return ReadIndex object or nullptr if there is none of given type
      */
-    static ReadIndex* load(const char* path);
+    static ReadIndex* load(const char* path, ReadIndexType type = ReadIndexType::kEsa);
 
 private:
 
@@ -128,7 +190,36 @@ private:
      * @brief Private ReadIndex constructor
      * @details Creates an empty ReadIndex object needed for deserialize method.
      */
-    ReadIndex() {}
+    ReadIndex() : esa_(nullptr), wideEsa_(nullptr), fm_(nullptr) {}
+
+    template<typename T>
+    void create(const T& reads, int rk, int threadLen, ReadIndexType type);
+
+    template<typename T>
+    void createFm(const T& reads, int rk, int threadLen);
+
+    size_t fmOccurrences(const char* pattern, int m) const;
+
+    void fmDuplicates(std::vector<int>& dst, const std::string& sequence) const;
+
+    void fmPrefixSuffixMatches(std::vector<std::pair<int, int>>& dst, const std::string& pattern,
+        int minOverlapLen) const;
+
+    template<typename I>
+    size_t occurrences(const EnhancedSuffixArray<I>* esa, const char* pattern, int m) const;
+
+    void sequenceDuplicates(std::vector<int>& dst, const SequenceView& sequence) const;
+
+    template<typename I>
+    void sequenceDuplicates(std::vector<int>& dst, const EnhancedSuffixArray<I>* esa,
+        const std::string& pattern) const;
+
+    void sequencePrefixSuffixMatches(std::vector<std::pair<int, int>>& dst,
+        const SequenceView& sequence, int minOverlapLen) const;
+
+    template<typename I>
+    void sequencePrefixSuffixMatches(std::vector<std::pair<int, int>>& dst,
+        const EnhancedSuffixArray<I>* esa, const std::string& pattern, int minOverlapLen) const;
 
     /*!
      * @brief Method for interval search
@@ -138,25 +229,27 @@ private:
      *
      * @param [out] s interval start position
      * @param [out] e interval end position
-     * @param [in] fragment identifier of EnhancedSuffixArray fragment
+     * @param [in] esa EnhancedSuffixArray object
      * @param [in] pattern query string
      * @param [in] m pattern length
      */
-    void findInterval(int* s, int* e, int fragment, const char* pattern, int m) const;
+    template<typename I>
+    void findInterval(I* s, I* e, const EnhancedSuffixArray<I>* esa, const char* pattern,
+        int m) const;
 
     /*!
-     * @brief Method for fragment update
-     * @details Method updates the EnahcedSuffixArray fragment by replacing all $$$$ strings
+     * @brief Method for identifier update
+     * @details Method updates the EnahcedSuffixArray string by replacing all $$$$ strings
      * with corresponding read identifiers.
      *
-     * @param [in] fragment identifier of EnhancedSuffixArray fragment
-     * @param [in] start starting read which identifier is to be incorporated
-     * @param [in] end ending read which identifier is to be incorporated
-     * @param [in] reads vector of Read object pointers
+     * @param [in] str EnhancedSuffixArray string
+     * @param [in] reads vector of Read object pointers or ReadStore object
      */
-    void updateFragment(int fragment, int start, int end, const std::vector<Read*>& reads);
+    template<typename T>
+    void updateIdentifiers(const std::string& str, const T& reads);
 
     int n_;
-    std::vector<int> fragmentSizes_;
-    std::vector<EnhancedSuffixArray*> fragments_;
+    EnhancedSuffixArray<int32_t>* esa_; // used if reads fit into 2GB
+    EnhancedSuffixArray<int64_t>* wideEsa_; // used otherwise
+    FmIndex* fm_; // used instead of both for kFm
 };
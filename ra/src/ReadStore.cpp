@@ -0,0 +1,212 @@
+/*!
+ * @file ReadStore.cpp
+ *
+ * @brief ReadStore and ReadView classes source file
+ */
+
+#include "Read.hpp"
+#include "ReadStore.hpp"
+
+//*****************************************************************************
+// ReadView
+
+uint32_t ReadView::id() const {
+    return store_->ids_[index_];
+}
+
+const char* ReadView::name() const {
+    return store_->names_.data() + store_->name_offsets_[index_];
+}
+
+SequenceView ReadView::sequence() const {
+
+    uint64_t exceptions_begin = store_->exception_offsets_[index_];
+
+    return SequenceView(store_->words_.data() + store_->word_offsets_[index_],
+        store_->lengths_[index_], store_->exceptions_.data() + exceptions_begin,
+        store_->exception_offsets_[index_ + 1] - exceptions_begin);
+}
+
+SequenceView ReadView::reverse_complement() const {
+    return sequence().reverse_complement();
+}
+
+uint32_t ReadView::length() const {
+    return store_->lengths_[index_];
+}
+
+std::string ReadView::quality() const {
+
+    uint32_t length;
+    bool binned;
+    const char* quality = stored_quality(&length, &binned);
+
+    if (!binned) return std::string(quality, length);
+
+    std::string dst;
+    decodeBinnedQualities(dst, quality, length);
+
+    return dst;
+}
+
+uint32_t ReadView::quality_length() const {
+
+    uint32_t length;
+    bool binned;
+    const char* quality = stored_quality(&length, &binned);
+
+    return binned ? binnedQualitiesLength(quality, length) : length;
+}
+
+const char* ReadView::stored_quality(uint32_t* length, bool* binned) const {
+
+    *length = store_->quality_offsets_[index_ + 1] - store_->quality_offsets_[index_];
+    *binned = store_->quality_binned_[index_];
+
+    return store_->qualities_.data() + store_->quality_offsets_[index_];
+}
+
+double ReadView::coverage() const {
+    return store_->coverages_[index_];
+}
+
+void ReadView::serialize(char** bytes, uint32_t* bytes_length) const {
+    Read::serialize(*this, bytes, bytes_length);
+}
+
+//*****************************************************************************
+// ReadStore
+
+ReadStore::ReadStore()
+        : ids_(), coverages_(), names_(), name_offsets_(), qualities_(),
+        quality_offsets_(1, 0), quality_binned_(), words_(), word_offsets_(), lengths_(),
+        exceptions_(), exception_offsets_(1, 0) {
+}
+
+void ReadStore::reserve(uint32_t reads, uint64_t bases) {
+
+    ids_.reserve(reads);
+    coverages_.reserve(reads);
+    name_offsets_.reserve(reads);
+    quality_offsets_.reserve(reads + 1);
+    quality_binned_.reserve(reads);
+    word_offsets_.reserve(reads);
+    lengths_.reserve(reads);
+    exception_offsets_.reserve(reads + 1);
+
+    words_.reserve(bases / 32 + reads);
+}
+
+void ReadStore::add(uint32_t id, const char* name, uint32_t name_length,
+    const char* sequence, uint32_t sequence_length, const char* quality,
+    uint32_t quality_length, double coverage, bool normalize,
+    QualityMode quality_mode) {
+
+    if (quality_mode == QualityMode::kDrop || quality_length == 0) {
+        add_encoded(id, name, name_length, sequence, sequence_length, "", 0,
+            false, coverage, normalize);
+
+    } else if (quality_mode == QualityMode::kBinned) {
+        std::vector<char> encoded(quality_length);
+        add_encoded(id, name, name_length, sequence, sequence_length, encoded.data(),
+            encodeBinnedQualities(encoded.data(), quality, quality_length),
+            true, coverage, normalize);
+
+    } else {
+        add_encoded(id, name, name_length, sequence, sequence_length, quality,
+            quality_length, false, coverage, normalize);
+    }
+}
+
+void ReadStore::add_encoded(uint32_t id, const char* name, uint32_t name_length,
+    const char* sequence, uint32_t sequence_length, const char* quality,
+    uint32_t quality_length, bool quality_binned, double coverage, bool normalize) {
+
+    ASSERT(name_length > 0 && sequence_length > 0, "ReadStore", "invalid data");
+
+    word_offsets_.push_back(words_.size());
+
+    uint32_t length = packSequence(words_, exceptions_, sequence,
+        sequence_length, normalize);
+
+    ASSERT(length > 0, "ReadStore", "invalid data");
+
+    // exception positions are relative to read start
+    lengths_.push_back(length);
+    exception_offsets_.push_back(exceptions_.size());
+
+    ids_.push_back(id);
+    coverages_.push_back(coverage);
+
+    name_offsets_.push_back(names_.size());
+    names_.insert(names_.end(), name, name + name_length);
+    names_.push_back('\0');
+
+    qualities_.insert(qualities_.end(), quality, quality + quality_length);
+    quality_offsets_.push_back(qualities_.size());
+    quality_binned_.push_back(quality_binned);
+}
+
+template<typename T>
+static void appendOffsets(std::vector<T>& dst, typename std::vector<T>::const_iterator begin,
+    typename std::vector<T>::const_iterator end, T offset) {
+
+    for (auto it = begin; it != end; ++it) {
+        dst.push_back(*it + offset);
+    }
+}
+
+void ReadStore::append(const ReadStore& other) {
+
+    ids_.insert(ids_.end(), other.ids_.begin(), other.ids_.end());
+    coverages_.insert(coverages_.end(), other.coverages_.begin(), other.coverages_.end());
+
+    appendOffsets(name_offsets_, other.name_offsets_.begin(),
+        other.name_offsets_.end(), (uint64_t) names_.size());
+    names_.insert(names_.end(), other.names_.begin(), other.names_.end());
+
+    // first offset of other is 0
+    appendOffsets(quality_offsets_, other.quality_offsets_.begin() + 1,
+        other.quality_offsets_.end(), (uint64_t) qualities_.size());
+    qualities_.insert(qualities_.end(), other.qualities_.begin(), other.qualities_.end());
+    quality_binned_.insert(quality_binned_.end(), other.quality_binned_.begin(),
+        other.quality_binned_.end());
+
+    appendOffsets(word_offsets_, other.word_offsets_.begin(),
+        other.word_offsets_.end(), (uint64_t) words_.size());
+    words_.insert(words_.end(), other.words_.begin(), other.words_.end());
+    lengths_.insert(lengths_.end(), other.lengths_.begin(), other.lengths_.end());
+
+    appendOffsets(exception_offsets_, other.exception_offsets_.begin() + 1,
+        other.exception_offsets_.end(), (uint64_t) exceptions_.size());
+    exceptions_.insert(exceptions_.end(), other.exceptions_.begin(), other.exceptions_.end());
+}
+
+void ReadStore::clear() {
+
+    ids_.clear();
+    coverages_.clear();
+    names_.clear();
+    name_offsets_.clear();
+    qualities_.clear();
+    quality_offsets_.assign(1, 0);
+    quality_binned_.clear();
+    words_.clear();
+    word_offsets_.clear();
+    lengths_.clear();
+    exceptions_.clear();
+    exception_offsets_.assign(1, 0);
+}
+
+size_t ReadStore::size_in_bytes() const {
+    return ids_.capacity() * sizeof(uint32_t) +
+        coverages_.capacity() * sizeof(double) +
+        names_.capacity() + name_offsets_.capacity() * sizeof(uint64_t) +
+        qualities_.capacity() + quality_offsets_.capacity() * sizeof(uint64_t) +
+        quality_binned_.capacity() / 8 +
+        words_.capacity() * sizeof(uint64_t) +
+        word_offsets_.capacity() * sizeof(uint64_t) +
+        lengths_.capacity() * sizeof(uint32_t) +
+        exceptions_.capacity() * sizeof(SequenceException) +
+        exception_offsets_.capacity() * sizeof(uint64_t);
+}
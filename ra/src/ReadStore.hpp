@@ -0,0 +1,259 @@
+/*!
+ * @file ReadStore.hpp
+ *
+ * @brief ReadStore and ReadView classes header file
+ */
+
+#pragma once
+
+#include "PackedSequence.hpp"
+#include "QualityCodec.hpp"
+#include "CommonHeaders.hpp"
+
+class ReadStore;
+
+/*!
+ * @brief ReadView class
+ * @details Lightweight handle to a read kept in a ReadStore. It mirrors the
+ * getters of Read so templated code can use both (operator-> returns the view
+ * itself). A view is invalidated when reads are added to its store.
+ */
+class ReadView {
+public:
+
+    /*!
+     * @brief ReadView constructor
+     *
+     * @param [in] store ReadStore object pointer
+     * @param [in] index index of the read in store
+     */
+    ReadView(const ReadStore* store, uint32_t index)
+            : store_(store), index_(index) {
+    }
+
+    const ReadView* operator->() const {
+        return this;
+    }
+
+    /*!
+     * @brief Getter for identifier
+     * @return identifier
+     */
+    uint32_t id() const;
+
+    /*!
+     * @brief Getter for name
+     * @return null terminated name
+     */
+    const char* name() const;
+
+    /*!
+     * @brief Getter for sequence
+     * @return sequence view
+     */
+    SequenceView sequence() const;
+
+    /*!
+     * @brief Getter for reverse complement
+     * @return reverse complement view
+     */
+    SequenceView reverse_complement() const;
+
+    /*!
+     * @brief Getter for length
+     * @return length
+     */
+    uint32_t length() const;
+
+    /*!
+     * @brief Getter for quality
+     * @details Binned qualities are decoded on access.
+     * @return quality (empty for FASTA reads)
+     */
+    std::string quality() const;
+
+    /*!
+     * @brief Getter for quality length
+     * @return quality length
+     */
+    uint32_t quality_length() const;
+
+    /*!
+     * @brief Getter for quality as kept in the store
+     *
+     * @param [out] length number of stored bytes
+     * @param [out] binned true if the quality is binned and run-length encoded
+     * @return stored quality
+     */
+    const char* stored_quality(uint32_t* length, bool* binned) const;
+
+    /*!
+     * @brief Getter for coverage
+     * @return coverage
+     */
+    double coverage() const;
+
+    /*!
+     * @brief Method for view serialization
+     * @details Serializes the read to a char array in the same format
+     * as Read::serialize.
+     *
+     * @param [out] bytes adress of the char array where the read is serialized
+     * @param [out] bytes_length adress of the variable holding size of the
+     * serialized read
+     */
+    void serialize(char** bytes, uint32_t* bytes_length) const;
+
+private:
+
+    const ReadStore* store_;
+    uint32_t index_;
+};
+
+/*!
+ * @brief ReadStore class
+ * @details Container which keeps names, qualities and 2-bit packed sequences
+ * of all reads in a few contiguous buffers indexed by offset tables, instead
+ * of allocating a Read object (and its strings) per read.
+ */
+class ReadStore {
+public:
+
+    /*!
+     * @brief ReadStore iterator
+     */
+    class const_iterator {
+    public:
+
+        const_iterator(const ReadStore* store, uint32_t idx)
+                : store_(store), idx_(idx) {
+        }
+
+        ReadView operator*() const { return ReadView(store_, idx_); }
+        const_iterator& operator++() { ++idx_; return *this; }
+        bool operator==(const const_iterator& other) const { return idx_ == other.idx_; }
+        bool operator!=(const const_iterator& other) const { return idx_ != other.idx_; }
+
+    private:
+
+        const ReadStore* store_;
+        uint32_t idx_;
+    };
+
+    /*!
+     * @brief ReadStore constructor
+     */
+    ReadStore();
+
+    /*!
+     * @brief ReadStore destructor
+     */
+    ~ReadStore() {};
+
+    /*!
+     * @brief Method for capacity reservation
+     *
+     * @param [in] reads expected number of reads
+     * @param [in] bases expected total number of bases
+     */
+    void reserve(uint32_t reads, uint64_t bases);
+
+    /*!
+     * @brief Method for read insertion
+     * @details Appends a read to the store. Same as in Read constructor,
+     * if normalize is true sequence letters are converted to upper case and
+     * all other characters are skipped, and quality is kept raw, binned or
+     * dropped depending on quality_mode.
+     *
+     * @param [in] id read identifier
+     * @param [in] name read name
+     * @param [in] name_length read name length
+     * @param [in] sequence read sequence
+     * @param [in] sequence_length read sequence length
+     * @param [in] quality read quality
+     * @param [in] quality_length read quality length
+     * @param [in] coverage read coverage
+     * @param [in] normalize if true sequence is normalized
+     * @param [in] quality_mode quality mode
+     */
+    void add(uint32_t id, const char* name, uint32_t name_length,
+        const char* sequence, uint32_t sequence_length, const char* quality,
+        uint32_t quality_length, double coverage, bool normalize = true,
+        QualityMode quality_mode = QualityMode::kRaw);
+
+    /*!
+     * @brief Method for store concatenation
+     * @details Appends all reads of other to the end of this store.
+     *
+     * @param [in] other ReadStore object
+     */
+    void append(const ReadStore& other);
+
+    /*!
+     * @brief Getter for number of reads
+     * @return number of reads
+     */
+    size_t size() const {
+        return ids_.size();
+    }
+
+    /*!
+     * @brief Method for emptiness check
+     * @return true if there are no reads
+     */
+    bool empty() const {
+        return ids_.empty();
+    }
+
+    ReadView operator[](uint32_t idx) const {
+        return ReadView(this, idx);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, ids_.size());
+    }
+
+    /*!
+     * @brief Method for clearing the store
+     */
+    void clear();
+
+    /*!
+     * @brief Method for memory usage retrieval
+     * @return number of bytes allocated for read data
+     */
+    size_t size_in_bytes() const;
+
+    friend class Read;
+    friend class ReadView;
+
+private:
+
+    // appends a read whose quality is already stored as in this class
+    void add_encoded(uint32_t id, const char* name, uint32_t name_length,
+        const char* sequence, uint32_t sequence_length, const char* quality,
+        uint32_t quality_length, bool quality_binned, double coverage,
+        bool normalize = false);
+
+    std::vector<uint32_t> ids_;
+    std::vector<double> coverages_;
+
+    std::vector<char> names_;
+    std::vector<uint64_t> name_offsets_;
+
+    // binned qualities are run-length encoded
+    std::vector<char> qualities_;
+    std::vector<uint64_t> quality_offsets_;
+    std::vector<bool> quality_binned_;
+
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> word_offsets_;
+    std::vector<uint32_t> lengths_;
+
+    std::vector<SequenceException> exceptions_;
+    std::vector<uint64_t> exception_offsets_;
+};
@@ -41,6 +41,10 @@ Edge::Edge(uint32_t id, uint32_t readId, Overlap* overlap, StringGraph* graph) {
 }
 
 void Edge::label(std::string& dst) {
+    dst = labelView().str();
+}
+
+SequenceView Edge::labelView() {
 
     if (src_->getId() == overlap_->a()) {
         // from A to B
@@ -67,7 +71,7 @@ void Edge::label(std::string& dst) {
             }
         }
 
-        dst = (overlap_->is_innie() ? dst_->getReverseComplement() : dst_->getSequence()).substr(start, len);
+        return (overlap_->is_innie() ? dst_->getReverseComplement() : dst_->getSequence()).subview(start, len);
 
     } else {
         // from B to A
@@ -81,7 +85,7 @@ void Edge::label(std::string& dst) {
             len = -1 * overlap_->b_hang();
         }
 
-        dst = dst_->getSequence().substr(start, len);
+        return dst_->getSequence().subview(start, len);
     }
 }
 
@@ -91,9 +95,7 @@ int Edge::labelLength() {
         return labelLength_;
     }
 
-    std::string l;
-    label(l);
-    labelLength_ = l.length();
+    labelLength_ = labelView().length();
 
     assert(labelLength_ == abs(overlap_->a_hang()) || labelLength_ == abs(overlap_->b_hang()));
 
@@ -101,35 +103,7 @@ int Edge::labelLength() {
 }
 
 void Edge::rkLabel(std::string& dst) {
-
-    std::string label;
-    this->label(label);
-
-    dst = "";
-
-    for (int i = label.size() - 1; i >= 0; --i) {
-
-        char c = label[i];
-
-        switch (c) {
-            case 'A':
-                c = 'T';
-                break;
-            case 'T':
-                c = 'A';
-                break;
-            case 'C':
-                c = 'G';
-                break;
-            case 'G':
-                c = 'C';
-                break;
-            default:
-                break;
-        }
-
-        dst += c;
-    }
+    dst = labelView().reverse_complement().str();
 }
 
 Vertex* Edge::oppositeVertex(uint32_t id) {
@@ -1132,7 +1106,7 @@ void StringGraphWalk::addEdge(Edge* edge) {
 void StringGraphWalk::extractSequence(std::string& dst) {
 
   if (edges_.empty()) {
-    dst = std::string(start_->getSequence());
+    dst = start_->getSequence().str();
     return;
   }
 
@@ -1147,10 +1121,10 @@ void StringGraphWalk::extractSequence(std::string& dst) {
 
   bool appendToPrefix = edges_.front()->getOverlap()->is_using_prefix(start_->getId()) ^ startType;
 
-  std::string startSequence = std::string(startType ? start_->getReverseComplement() : start_->getSequence());
+  SequenceView startSequence = startType ? start_->getReverseComplement() : start_->getSequence();
 
   // add start vertex
-  dst = appendToPrefix ? std::string(startSequence.rbegin(), startSequence.rend()) : startSequence;
+  dst = (appendToPrefix ? startSequence.reversed() : startSequence).str();
 
   int prevType = startType;
 
@@ -1161,19 +1135,22 @@ void StringGraphWalk::extractSequence(std::string& dst) {
 
     bool invert = type == prevType ? false : true;
 
-    std::string label;
+    SequenceView label = edge->labelView();
     if (invert) {
-      edge->rkLabel(label);
-    } else {
-      edge->label(label);
+      label = label.reverse_complement();
+    }
+    if (appendToPrefix) {
+      label = label.reversed();
     }
 
-    dst += appendToPrefix ? std::string(label.rbegin(), label.rend()) : label;
+    size_t offset = dst.size();
+    dst.resize(offset + label.length());
+    label.copy(&dst[offset]);
 
     prevType = getType(edge, edge->getDst()->getId()) ^ invert;
   }
 
-  if (appendToPrefix) dst = std::string(dst.rbegin(), dst.rend());
+  if (appendToPrefix) std::reverse(dst.begin(), dst.end());
 }
 
 void StringGraphWalk::extractVertices(std::vector<Vertex*>& dst) {
@@ -106,6 +106,14 @@ public:
      */
     void label(std::string& dst);
 
+    /*!
+     * @brief Method for label view extraction
+     * @details Method returns the edge label without copying bases.
+     *
+     * @return label view
+     */
+    SequenceView labelView();
+
     int labelLength();
 
     /*!
@@ -191,17 +199,17 @@ public:
 
     /*!
      * @brief Getter for read sequence
-     * @return sequence
+     * @return sequence view
      */
-    const std::string& getSequence() {
+    SequenceView getSequence() {
         return read_->sequence();
     }
 
     /*!
      * @brief Getter for read reverse complement
-     * @return reverse complement
+     * @return reverse complement view
      */
-    const std::string& getReverseComplement() {
+    SequenceView getReverseComplement() {
         return read_->reverse_complement();
     }
 
@@ -10,7 +10,11 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
+#include "NucleotideCodec.hpp"
 #include "Utils.hpp"
 
 void debug(const char* fmt, ...) {
@@ -22,6 +26,34 @@ void debug(const char* fmt, ...) {
 #endif
 }
 
+const char* mapFile(const char* path, size_t* length) {
+
+    int fd = open(path, O_RDONLY);
+    ASSERT(fd != -1, "Utils", "cannot open file %s with mode r", path);
+
+    struct stat buf;
+    ASSERT(fstat(fd, &buf) == 0, "Utils", "cannot stat file %s", path);
+
+    *length = buf.st_size;
+
+    if (*length == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ASSERT(data != MAP_FAILED, "Utils", "cannot map file %s", path);
+
+    madvise(data, *length, MADV_SEQUENTIAL);
+    close(fd);
+
+    return (const char*) data;
+}
+
+void unmapFile(const char* data, size_t length) {
+    if (data != nullptr) munmap((void*) data, length);
+}
+
 Timer::Timer() :
     paused_(0), time_(0), timeval_() {
 }
@@ -58,31 +90,9 @@ void Timer::print(const char* location, const char* message) const {
 
 std::string reverseComplement(const std::string& original) {
 
-  std::string res;
-  res.reserve(original.size());
-
-  for (int i = original.size() - 1; i >= 0; --i) {
-
-    char c = original[i];
-
-    switch (c) {
-      case 'A':
-        c = 'T';
-        break;
-      case 'T':
-        c = 'A';
-        break;
-      case 'C':
-        c = 'G';
-        break;
-      case 'G':
-        c = 'C';
-        break;
-      default:
-        break;
-    }
-
-    res.push_back(c);
+  std::string res(original.size(), '\0');
+  if (!original.empty()) {
+    reverseComplementSequence(&res[0], original.data(), original.size());
   }
 
   return res;
@@ -27,6 +27,24 @@ std::string reverseComplement(const std::string& original);
 
 void debug(const char* fmt, ...);
 
+/*!
+ * @brief Method for read only file mapping
+ * @details Maps the whole file into memory and advises sequential access.
+ *
+ * @param [in] path path to file
+ * @param [out] length file size
+ * @return pointer to mapped data (nullptr if the file is empty)
+ */
+const char* mapFile(const char* path, size_t* length);
+
+/*!
+ * @brief Method for unmapping a file mapped with mapFile
+ *
+ * @param [in] data pointer to mapped data
+ * @param [in] length file size
+ */
+void unmapFile(const char* data, size_t length);
+
 /*!
  * @brief Timer class
  */
@@ -10,20 +10,28 @@
 #pragma once
 
 #include "CommonHeaders.hpp"
+#include "CompressedInput.hpp"
 #include "Contig.hpp"
 #include "Depot.hpp"
 #include "DepotObject.hpp"
 #include "EnhancedSuffixArray.hpp"
+#include "FmIndex.hpp"
 #include "Globals.hpp"
 #include "Graph.hpp"
 #include "IO.hpp"
 #include "MhapParser.hpp"
+#include "NucleotideCodec.hpp"
+#include "ObjectPool.hpp"
 #include "Overlap.hpp"
 #include "OverlapFunctions.hpp"
+#include "PackedSequence.hpp"
 #include "PartialOrderAlignment.hpp"
 #include "Preprocess.hpp"
+#include "QualityCodec.hpp"
 #include "Read.hpp"
+#include "ReadBlockCodec.hpp"
 #include "ReadIndex.hpp"
+#include "ReadStore.hpp"
 #include "Settings.hpp"
 #include "StringGraph.hpp"
 #include "StringGraphUtils.hpp"
@@ -5,6 +5,10 @@
 #include "../OverlapFunctions.hpp"
 #include "../IO.hpp"
 
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
 TEST(Depot, Creation) {
   auto depot = new Depot("depot_dummy");
   delete depot;
@@ -21,7 +25,7 @@ TEST(Depot, StoreLoad) {
 
   ASSERT_EQ(reads.front()->id(), read1->id());
   ASSERT_STREQ(reads.front()->name().c_str(), read1->name().c_str());
-  ASSERT_STREQ(reads.front()->sequence().c_str(), read1->sequence().c_str());
+  ASSERT_STREQ(reads.front()->sequence().str().c_str(), read1->sequence().str().c_str());
   ASSERT_STREQ(reads.front()->quality().c_str(), read1->quality().c_str());
   ASSERT_EQ(reads.front()->coverage(), read1->coverage());
   ASSERT_EQ(reads.front()->length(), read1->length());
@@ -50,7 +54,7 @@ TEST(Depot, StoreLoadHeavy) {
       ASSERT_EQ(reads[i]->length(), reads2[i]->length());
       ASSERT_EQ(reads[i]->id(), reads2[i]->id());
       ASSERT_STREQ(reads[i]->name().c_str(), reads2[i]->name().c_str());
-      ASSERT_STREQ(reads[i]->sequence().c_str(), reads2[i]->sequence().c_str());
+      ASSERT_STREQ(reads[i]->sequence().str().c_str(), reads2[i]->sequence().str().c_str());
       ASSERT_STREQ(reads[i]->quality().c_str(), reads2[i]->quality().c_str());
       ASSERT_EQ(reads[i]->coverage(), reads2[i]->coverage());
   }
@@ -83,7 +87,7 @@ TEST(Depot, StoreLoadHeavyByNReads) {
             ASSERT_EQ(reads[i + j]->length(), reads2[j]->length());
             ASSERT_EQ(reads[i + j]->id(), reads2[j]->id());
             ASSERT_STREQ(reads[i + j]->name().c_str(), reads2[j]->name().c_str());
-            ASSERT_STREQ(reads[i + j]->sequence().c_str(), reads2[j]->sequence().c_str());
+            ASSERT_STREQ(reads[i + j]->sequence().str().c_str(), reads2[j]->sequence().str().c_str());
             ASSERT_EQ(reads[i + j]->coverage(), reads2[j]->coverage());
             ASSERT_STREQ(reads[i + j]->quality().c_str(), reads2[j]->quality().c_str());
         }
@@ -119,7 +123,7 @@ TEST(Depot, StoreLoadHeavyBy1Read) {
             ASSERT_EQ(reads[i + j]->length(), reads2[j]->length());
             ASSERT_EQ(reads[i + j]->id(), reads2[j]->id());
             ASSERT_STREQ(reads[i + j]->name().c_str(), reads2[j]->name().c_str());
-            ASSERT_STREQ(reads[i + j]->sequence().c_str(), reads2[j]->sequence().c_str());
+            ASSERT_STREQ(reads[i + j]->sequence().str().c_str(), reads2[j]->sequence().str().c_str());
             ASSERT_EQ(reads[i + j]->coverage(), reads2[j]->coverage());
             ASSERT_STREQ(reads[i + j]->quality().c_str(), reads2[j]->quality().c_str());
         }
@@ -297,3 +301,1070 @@ TEST(Depot, StoreLoadOverlapsHeavyBy1Overlap) {
     for (const auto& it: reads) delete it;
     delete depot;
 }
+
+TEST(Depot, StoreBatches) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  auto depot = new Depot("depot_dummy");
+
+  ReadBatchReader reader("../examples/ERR430949.fastq", ReadFormat::kFastq, 0, 32 * 1024);
+  depot->store_reads(reader);
+
+  ReadSet reads2;
+  depot->load_reads(reads2);
+
+  ASSERT_EQ(reads.size(), reads2.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(reads[i]->id(), reads2[i]->id());
+    ASSERT_EQ(reads[i]->name(), reads2[i]->name());
+    ASSERT_EQ(reads[i]->sequence().str(), reads2[i]->sequence().str());
+    ASSERT_EQ(reads[i]->quality(), reads2[i]->quality());
+  }
+
+  delete depot;
+
+  for (const auto& it: reads2) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, AppendReads) {
+
+  ReadSet reads = { new Read(0, "read0", "ACGT", "", 1),
+    new Read(1, "read1", "CCGGTT", "", 1), new Read(2, "read2", "TTTANA", "", 1) };
+
+  auto depot = new Depot("depot_dummy");
+
+  depot->store_reads(ReadSet(reads.begin(), reads.begin() + 1));
+  depot->append_reads(ReadSet(reads.begin() + 1, reads.end()));
+
+  ReadSet reads2;
+  depot->load_reads(reads2);
+
+  ASSERT_EQ(reads.size(), reads2.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(reads[i]->id(), reads2[i]->id());
+    ASSERT_EQ(reads[i]->sequence().str(), reads2[i]->sequence().str());
+  }
+
+  // store overwrites appended reads
+  depot->store_reads(ReadSet(reads.begin() + 2, reads.end()));
+
+  ReadSet reads3;
+  depot->load_reads(reads3);
+
+  ASSERT_EQ(1U, reads3.size());
+  ASSERT_EQ(2U, reads3.front()->id());
+
+  delete depot;
+
+  for (const auto& it: reads3) delete it;
+  for (const auto& it: reads2) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+static uint64_t readDataSize() {
+  std::ifstream f("depot_dummy/read_data.bin", std::ios::binary | std::ios::ate);
+  return f.tellg();
+}
+
+TEST(Depot, QualityModes) {
+
+  ReadStore raw;
+  readFastqReads(raw, "../examples/ERR430949.fastq");
+
+  uint64_t raw_size = 0;
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(raw);
+    raw_size = readDataSize();
+  }
+
+  const QualityMode modes[] = { QualityMode::kBinned, QualityMode::kDrop };
+
+  for (const auto& mode: modes) {
+    ReadSet reads;
+    readFastqReads(reads, "../examples/ERR430949.fastq", 2, mode);
+
+    ReadStore store;
+    readFastqReads(store, "../examples/ERR430949.fastq", 2, mode);
+
+    ASSERT_LT(store.size_in_bytes(), raw.size_in_bytes());
+
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    // raw qualities are compressed as well
+    ASSERT_LT(readDataSize() * 10, raw_size * (mode == QualityMode::kDrop ? 7 : 9));
+
+    ReadSet reads2;
+    depot.load_reads(reads2);
+
+    ReadStore store2;
+    depot.load_reads(store2);
+
+    ASSERT_EQ(raw.size(), reads2.size());
+    ASSERT_EQ(raw.size(), store2.size());
+
+    for (uint32_t i = 0; i < raw.size(); ++i) {
+      std::string expected = raw[i].quality();
+      if (mode == QualityMode::kDrop) {
+        expected.clear();
+      } else {
+        for (auto& c: expected) c = binQuality(c);
+      }
+
+      ASSERT_EQ(expected, reads[i]->quality());
+      ASSERT_EQ(expected, store[i].quality());
+      ASSERT_EQ(expected.size(), store[i].quality_length());
+      ASSERT_EQ(expected, reads2[i]->quality());
+      ASSERT_EQ(expected, store2[i].quality());
+      ASSERT_EQ(raw[i].sequence().str(), store2[i].sequence().str());
+    }
+
+    for (const auto& it: reads2) delete it;
+    for (const auto& it: reads) delete it;
+  }
+}
+
+TEST(Depot, MappedDepot) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq", 1, QualityMode::kBinned);
+  reads[1]->set_quality_mode(QualityMode::kDrop);
+
+  OverlapSet overlaps;
+  {
+    Depot depot("depot_dummy");
+    overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+  }
+
+  MappedDepot depot("depot_dummy");
+  MappedDepot shared("depot_dummy");
+
+  ASSERT_EQ(reads.size(), depot.reads_size());
+  ASSERT_EQ(overlaps.size(), shared.overlaps_size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    auto read = depot.read(i);
+    ASSERT_EQ(reads[i]->id(), read.id());
+    ASSERT_EQ(reads[i]->name(), std::string(read.name(), read.name_length()));
+    ASSERT_EQ(reads[i]->sequence().str(), std::string(read.sequence(), read.length()));
+    ASSERT_EQ(reads[i]->quality(), read.quality());
+    ASSERT_EQ(reads[i]->coverage(), read.coverage());
+
+    auto copy = read.materialize();
+    ASSERT_EQ(reads[i]->quality(), copy->quality());
+    delete copy;
+  }
+
+  for (uint32_t i = 0; i < overlaps.size(); ++i) {
+    auto overlap = shared.overlap(i);
+    ASSERT_EQ(overlaps[i]->a(), overlap.a());
+    ASSERT_EQ(overlaps[i]->b(), overlap.b());
+    ASSERT_EQ(overlaps[i]->is_innie(), overlap.is_innie());
+    ASSERT_EQ(overlaps[i]->is_dovetail(), overlap.is_dovetail());
+    ASSERT_EQ(overlaps[i]->a_lo(), overlap.a_lo());
+    ASSERT_EQ(overlaps[i]->a_hi(), overlap.a_hi());
+    ASSERT_EQ(overlaps[i]->b_lo(), overlap.b_lo());
+    ASSERT_EQ(overlaps[i]->b_hi(), overlap.b_hi());
+    ASSERT_EQ(overlaps[i]->err_rate(), overlap.err_rate());
+    ASSERT_EQ(overlaps[i]->orig_err_rate(), overlap.orig_err_rate());
+    ASSERT_EQ(overlaps[i]->confirmations(), overlap.confirmations());
+    if (overlap.is_dovetail()) {
+      ASSERT_EQ(overlaps[i]->a_hang(), overlap.a_hang());
+      ASSERT_EQ(overlaps[i]->b_hang(), overlap.b_hang());
+    }
+
+    auto copy = overlap.materialize(reads);
+    ASSERT_EQ(reads[overlap.a()], copy->read_a());
+    ASSERT_EQ(reads[overlap.b()], copy->read_b());
+    delete copy;
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+// objects as stored before the compressed and fixed width formats
+template<typename T>
+static uint64_t storeLegacyObjects(const std::vector<T*>& objects, const std::string& prefix) {
+
+  std::ofstream data("depot_dummy/" + prefix + "_data.bin", std::ios::binary | std::ios::trunc);
+  std::ofstream index("depot_dummy/" + prefix + "_index.bin", std::ios::binary | std::ios::trunc);
+
+  uint64_t header[2] = { objects.size(), 0 };
+  index.write((char*) header, sizeof(header));
+
+  uint64_t offset = 0;
+  for (const auto& it: objects) {
+    char* bytes;
+    uint32_t bytes_length;
+    it->serialize(&bytes, &bytes_length);
+
+    data.write((char*) &bytes_length, sizeof(bytes_length));
+    data.write(bytes, bytes_length);
+    delete[] bytes;
+
+    offset += bytes_length + sizeof(bytes_length);
+    index.write((char*) &offset, sizeof(offset));
+  }
+
+  return offset + (objects.size() + 2) * sizeof(uint64_t);
+}
+
+static uint64_t storeLegacyOverlaps(const OverlapSet& overlaps) {
+  return storeLegacyObjects(overlaps, "overlap");
+}
+
+TEST(Depot, OverlapFormats) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+  ASSERT_LT(0, overlaps.size());
+
+  auto expectEqual = [&](const OverlapSet& loaded) {
+    ASSERT_EQ(overlaps.size(), loaded.size());
+    for (uint32_t i = 0; i < overlaps.size(); ++i) {
+      ASSERT_EQ(overlaps[i]->read_a(), loaded[i]->read_a());
+      ASSERT_EQ(overlaps[i]->read_b(), loaded[i]->read_b());
+      ASSERT_EQ(overlaps[i]->is_innie(), loaded[i]->is_innie());
+      ASSERT_EQ(overlaps[i]->is_dovetail(), loaded[i]->is_dovetail());
+      ASSERT_EQ(overlaps[i]->a_lo(), loaded[i]->a_lo());
+      ASSERT_EQ(overlaps[i]->a_hi(), loaded[i]->a_hi());
+      ASSERT_EQ(overlaps[i]->b_lo(), loaded[i]->b_lo());
+      ASSERT_EQ(overlaps[i]->b_hi(), loaded[i]->b_hi());
+      ASSERT_EQ(overlaps[i]->err_rate(), loaded[i]->err_rate());
+      ASSERT_EQ(overlaps[i]->orig_err_rate(), loaded[i]->orig_err_rate());
+      ASSERT_EQ(overlaps[i]->confirmations(), loaded[i]->confirmations());
+      if (overlaps[i]->is_dovetail()) {
+        ASSERT_EQ(overlaps[i]->a_hang(), loaded[i]->a_hang());
+        ASSERT_EQ(overlaps[i]->b_hang(), loaded[i]->b_hang());
+      }
+    }
+  };
+
+  uint64_t legacy_size = storeLegacyOverlaps(overlaps);
+
+  {
+    Depot depot("depot_dummy");
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    expectEqual(loaded);
+    for (const auto& it: loaded) delete it;
+
+    depot.store_overlaps(overlaps);
+  }
+
+  std::ifstream data("depot_dummy/overlap_data.bin", std::ios::binary | std::ios::ate);
+  std::ifstream index("depot_dummy/overlap_index.bin", std::ios::binary | std::ios::ate);
+  ASSERT_EQ(0, index.tellg());
+  ASSERT_LT((uint64_t) data.tellg() * 5, legacy_size * 4);
+
+  {
+    MappedDepot depot("depot_dummy");
+    ASSERT_TRUE(depot.overlap_columns() != nullptr);
+    ASSERT_EQ(overlaps.size(), depot.overlaps_size());
+
+    OverlapSet loaded;
+    for (uint32_t i = 0; i < depot.overlaps_size(); ++i) {
+      loaded.push_back(depot.overlap(i).materialize(reads));
+    }
+    expectEqual(loaded);
+    for (const auto& it: loaded) delete it;
+  }
+
+  {
+    Depot depot("depot_dummy");
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    expectEqual(loaded);
+
+    auto overlap = depot.load_overlap(overlaps.size() - 1, reads);
+    ASSERT_EQ(overlaps.back()->b_hi(), overlap->b_hi());
+    delete overlap;
+
+    for (const auto& it: loaded) delete it;
+  }
+
+  storeLegacyOverlaps(overlaps);
+  {
+    MappedDepot depot("depot_dummy");
+    ASSERT_TRUE(depot.overlap_columns() == nullptr);
+    ASSERT_EQ(overlaps.size(), depot.overlaps_size());
+    ASSERT_EQ(overlaps.back()->b(), depot.overlap(overlaps.size() - 1).b());
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, ReadBlocks) {
+  srand(23);
+
+  // enough reads for several blocks
+  ReadSet reads;
+  for (uint32_t i = 0; i < 6000; ++i) {
+    std::string sequence, quality;
+    for (uint32_t j = 0, length = 500 + rand() % 1000; j < length; ++j) {
+      sequence.push_back(rand() % 100 == 0 ? 'N' : "ACGT"[rand() % 4]);
+      quality.push_back('!' + rand() % 42);
+    }
+    reads.push_back(new Read(i, "read" + std::to_string(i), sequence, quality, 1,
+      i % 2 == 0 ? QualityMode::kRaw : QualityMode::kBinned));
+  }
+
+  auto expectEqual = [](const Read* expected, const Read* read) {
+    ASSERT_EQ(expected->id(), read->id());
+    ASSERT_EQ(expected->name(), read->name());
+    ASSERT_EQ(expected->sequence().str(), read->sequence().str());
+    ASSERT_EQ(expected->quality(), read->quality());
+  };
+
+  uint64_t legacy_size = storeLegacyObjects(reads, "read");
+
+  {
+    Depot depot("depot_dummy");
+
+    // reads stored in the older format are loaded and appended as before
+    depot.append_reads(ReadSet(reads.begin(), reads.begin() + 10));
+
+    auto read = depot.load_read(6005);
+    expectEqual(reads[5], read);
+    delete read;
+
+    depot.store_reads(reads);
+  }
+
+  std::ifstream index("depot_dummy/read_index.bin", std::ios::binary | std::ios::ate);
+  ASSERT_LT((uint64_t) index.tellg() + readDataSize(), legacy_size / 2);
+
+  {
+    Depot depot("depot_dummy");
+    depot.append_reads(ReadSet(reads.begin(), reads.begin() + 100));
+
+    ReadSet loaded;
+    depot.load_reads(loaded);
+    ASSERT_EQ(reads.size() + 100, loaded.size());
+    for (uint32_t i = 0; i < loaded.size(); ++i) {
+      expectEqual(reads[i % reads.size()], loaded[i]);
+    }
+    for (const auto& it: loaded) delete it;
+
+    ReadStore store;
+    depot.load_reads(store, 1500, 3000);
+    ASSERT_EQ(3000U, store.size());
+    for (uint32_t i = 0; i < store.size(); ++i) {
+      ASSERT_EQ(reads[1500 + i]->sequence().str(), store[i].sequence().str());
+      ASSERT_EQ(reads[1500 + i]->quality(), store[i].quality());
+    }
+
+    for (uint32_t i = 0; i < 100; ++i) {
+      uint32_t j = rand() % reads.size();
+      auto read = depot.load_read(j);
+      expectEqual(reads[j], read);
+      delete read;
+    }
+  }
+
+  {
+    MappedDepot depot("depot_dummy");
+    ASSERT_EQ(reads.size() + 100, depot.reads_size());
+
+    for (uint32_t i = reads.size(); i-- > 0;) {
+      auto read = depot.read(i);
+      ASSERT_EQ(reads[i]->sequence().str(), std::string(read.sequence(), read.length()));
+      ASSERT_EQ(reads[i]->quality(), read.quality());
+    }
+  }
+
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, LoadKeepsOrder) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  Depot depot("depot_dummy");
+  depot.store_reads(reads);
+  depot.store_overlaps(overlaps);
+
+  // objects are appended after the ones already in dst
+  ReadSet reads2 = { reads.front()->clone() };
+  depot.load_reads(reads2, 1, -1);
+  depot.load_reads(reads2, 0, 1);
+
+  ASSERT_EQ(reads.size() + 1, reads2.size());
+  for (uint32_t i = 0; i < reads2.size(); ++i) {
+    ASSERT_EQ(reads[i % reads.size()]->id(), reads2[i]->id());
+    ASSERT_EQ(reads[i % reads.size()]->sequence().str(), reads2[i]->sequence().str());
+  }
+
+  OverlapSet overlaps2;
+  depot.load_overlaps(overlaps2, overlaps.size() / 2, -1, reads);
+  depot.load_overlaps(overlaps2, 0, overlaps.size() / 2, reads);
+
+  ASSERT_EQ(overlaps.size(), overlaps2.size());
+  for (uint32_t i = 0; i < overlaps2.size(); ++i) {
+    const auto& expected = overlaps[(i + overlaps.size() / 2) % overlaps.size()];
+    ASSERT_EQ(expected->read_a(), overlaps2[i]->read_a());
+    ASSERT_EQ(expected->read_b(), overlaps2[i]->read_b());
+    ASSERT_EQ(expected->a_lo(), overlaps2[i]->a_lo());
+  }
+
+  for (const auto& it: overlaps2) delete it;
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads2) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, OverlapSegments) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  auto expectEqual = [](const OverlapSet& expected, const OverlapSet& loaded) {
+    ASSERT_EQ(expected.size(), loaded.size());
+    for (uint32_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i]->read_a(), loaded[i]->read_a());
+      ASSERT_EQ(expected[i]->read_b(), loaded[i]->read_b());
+      ASSERT_EQ(expected[i]->a_lo(), loaded[i]->a_lo());
+      ASSERT_EQ(expected[i]->b_hi(), loaded[i]->b_hi());
+      ASSERT_EQ(expected[i]->err_rate(), loaded[i]->err_rate());
+    }
+  };
+
+  // every third overlap is removed and every fifth one is replaced
+  OverlapSet expected, replaced;
+  for (uint32_t i = 0; i < overlaps.size(); ++i) {
+    if (i % 3 == 0) continue;
+    if (i % 5 == 0) {
+      replaced.push_back(overlaps[i]->clone());
+      continue;
+    }
+    expected.push_back(overlaps[i]);
+  }
+  expected.insert(expected.end(), replaced.begin(), replaced.end());
+
+  auto path = "depot_dummy/overlap_segment_1.bin";
+
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+
+    OverlapSet updated;
+    for (uint32_t i = 0; i < loaded.size(); ++i) {
+      if (i % 3 != 0 && i % 5 != 0) updated.push_back(loaded[i]);
+    }
+    updated.insert(updated.end(), replaced.begin(), replaced.end());
+
+    depot.update_overlaps(loaded, updated);
+    for (const auto& it: loaded) delete it;
+
+    ASSERT_TRUE(std::ifstream(path).good());
+
+    OverlapSet loaded2;
+    depot.load_overlaps(loaded2, reads);
+    expectEqual(expected, loaded2);
+    for (const auto& it: loaded2) delete it;
+
+    auto overlap = depot.load_overlap(expected.size() - 1, reads);
+    ASSERT_EQ(expected.back()->a_hi(), overlap->a_hi());
+    delete overlap;
+
+    // indices refer to overlaps which are not removed
+    depot.remove_overlaps({ 0, 1 });
+    expected.erase(expected.begin(), expected.begin() + 2);
+
+    OverlapSet loaded3;
+    depot.load_overlaps(loaded3, 10, -1, reads);
+    expectEqual(OverlapSet(expected.begin() + 10, expected.end()), loaded3);
+    for (const auto& it: loaded3) delete it;
+  }
+
+  {
+    MappedDepot depot("depot_dummy");
+    ASSERT_TRUE(depot.overlap_columns() == nullptr);
+    ASSERT_EQ(expected.size(), depot.overlaps_size());
+    for (uint32_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i]->b(), depot.overlap(i).b());
+      ASSERT_EQ(expected[i]->b_lo(), depot.overlap(i).b_lo());
+    }
+  }
+
+  {
+    Depot depot("depot_dummy");
+    depot.compact_overlaps();
+
+    ASSERT_FALSE(std::ifstream(path).good());
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    expectEqual(expected, loaded);
+    for (const auto& it: loaded) delete it;
+  }
+
+  {
+    MappedDepot depot("depot_dummy");
+    ASSERT_TRUE(depot.overlap_columns() != nullptr);
+    ASSERT_EQ(expected.size(), depot.overlaps_size());
+  }
+
+  // removal works on overlaps stored in the older format as well
+  storeLegacyOverlaps(overlaps);
+  {
+    Depot depot("depot_dummy");
+    depot.remove_overlaps({ 0 });
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    expectEqual(OverlapSet(overlaps.begin() + 1, overlaps.end()), loaded);
+    for (const auto& it: loaded) delete it;
+
+    depot.compact_overlaps();
+
+    std::ifstream index("depot_dummy/overlap_index.bin", std::ios::binary | std::ios::ate);
+    ASSERT_EQ(0, index.tellg());
+
+    OverlapSet loaded2;
+    depot.load_overlaps(loaded2, reads);
+    expectEqual(OverlapSet(overlaps.begin() + 1, overlaps.end()), loaded2);
+    for (const auto& it: loaded2) delete it;
+  }
+
+  for (const auto& it: replaced) delete it;
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, ReadOverlaps) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  const std::vector<uint32_t> ids = { 0, 7, 7, 100, 511, 1263, 5000 };
+
+  // overlaps of the given reads in depot order
+  auto expectReadOverlaps = [&ids, &reads](Depot& depot) {
+    OverlapSet loaded, selected;
+    depot.load_overlaps(loaded, reads);
+    depot.load_overlaps_for_reads(selected, ids, reads);
+
+    uint32_t j = 0;
+    for (const auto& it: loaded) {
+      if (std::find(ids.begin(), ids.end(), it->a()) == ids.end() &&
+          std::find(ids.begin(), ids.end(), it->b()) == ids.end()) {
+        continue;
+      }
+      ASSERT_LT(j, selected.size());
+      ASSERT_EQ(it->a(), selected[j]->a());
+      ASSERT_EQ(it->b(), selected[j]->b());
+      ASSERT_EQ(it->a_lo(), selected[j]->a_lo());
+      ++j;
+    }
+    ASSERT_EQ(j, selected.size());
+    ASSERT_LT(0U, j);
+
+    for (const auto& it: loaded) delete it;
+    for (const auto& it: selected) delete it;
+  };
+
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+    ASSERT_TRUE(std::ifstream("depot_dummy/overlap_adjacency.bin").good());
+    expectReadOverlaps(depot);
+
+    // removed overlaps are skipped and appended ones are found
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    OverlapSet updated(loaded.begin() + loaded.size() / 2, loaded.end());
+    updated.push_back(loaded[0]->clone());
+    depot.update_overlaps(loaded, updated);
+    delete updated.back();
+    for (const auto& it: loaded) delete it;
+
+    ASSERT_TRUE(std::ifstream("depot_dummy/overlap_adjacency_1.bin").good());
+    expectReadOverlaps(depot);
+  }
+
+  {
+    MappedDepot depot("depot_dummy");
+    uint32_t total = 0;
+    for (const auto& id: ids) {
+      std::vector<uint32_t> indices;
+      depot.read_overlaps(id, indices);
+      for (const auto& it: indices) {
+        ASSERT_TRUE(depot.overlap(it).a() == id || depot.overlap(it).b() == id);
+      }
+      total += indices.size();
+    }
+    ASSERT_LT(0U, total);
+  }
+
+  {
+    Depot depot("depot_dummy");
+    depot.compact_overlaps();
+    ASSERT_FALSE(std::ifstream("depot_dummy/overlap_adjacency_1.bin").good());
+    expectReadOverlaps(depot);
+  }
+
+  // depots without the index are scanned
+  storeLegacyOverlaps(overlaps);
+  {
+    Depot depot("depot_dummy");
+    expectReadOverlaps(depot);
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, OverlapPredicate) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  std::vector<OverlapPredicate> predicates(5);
+  predicates[1].max_err_rate = 0.01;
+  predicates[1].min_length = 100;
+  predicates[2].min_length = 80;
+  predicates[2].max_length = 95;
+  predicates[3].min_covered = 0.9;
+  predicates[4].min_err_rate = 0.005;
+
+  // selected overlaps equal the matching ones in depot order
+  auto expectSelected = [&predicates, &reads](Depot& depot) {
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+
+    for (const auto& predicate: predicates) {
+      std::vector<uint32_t> expected;
+      for (uint32_t i = 0; i < loaded.size(); ++i) {
+        const auto& it = loaded[i];
+        if (predicate.matches(it->err_rate(), it->length(), std::min(
+            it->covered_percentage(it->a()), it->covered_percentage(it->b())))) {
+          expected.push_back(i);
+        }
+      }
+
+      std::vector<uint32_t> selected;
+      depot.select_overlaps(selected, reads, predicate);
+      ASSERT_EQ(expected, selected);
+
+      OverlapSet matching;
+      depot.load_overlaps(matching, reads, predicate);
+      ASSERT_EQ(expected.size(), matching.size());
+      for (uint32_t i = 0; i < matching.size(); ++i) {
+        ASSERT_EQ(loaded[expected[i]]->a(), matching[i]->a());
+        ASSERT_EQ(loaded[expected[i]]->b(), matching[i]->b());
+        ASSERT_EQ(loaded[expected[i]]->a_lo(), matching[i]->a_lo());
+      }
+      for (const auto& it: matching) delete it;
+    }
+
+    std::vector<double> err_rates;
+    depot.load_overlap_err_rates(err_rates);
+    ASSERT_EQ(loaded.size(), err_rates.size());
+    for (uint32_t i = 0; i < loaded.size(); ++i) {
+      ASSERT_EQ(loaded[i]->err_rate(), err_rates[i]);
+    }
+
+    for (const auto& it: loaded) delete it;
+  };
+
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+    ASSERT_TRUE(std::ifstream("depot_dummy/overlap_zones.bin").good());
+    expectSelected(depot);
+
+    OverlapSet loaded;
+    depot.load_overlaps(loaded, reads);
+    OverlapSet updated(loaded.begin() + loaded.size() / 3, loaded.end());
+    updated.push_back(loaded[0]->clone());
+    depot.update_overlaps(loaded, updated);
+    delete updated.back();
+    for (const auto& it: loaded) delete it;
+
+    ASSERT_TRUE(std::ifstream("depot_dummy/overlap_zones_1.bin").good());
+    expectSelected(depot);
+
+    depot.compact_overlaps();
+    ASSERT_FALSE(std::ifstream("depot_dummy/overlap_zones_1.bin").good());
+    expectSelected(depot);
+  }
+
+  // depots without zone maps are checked overlap by overlap
+  storeLegacyOverlaps(overlaps);
+  {
+    Depot depot("depot_dummy");
+    expectSelected(depot);
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, Scan) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+    depot.remove_overlaps({ 0 });
+
+    uint32_t next = 0;
+    depot.scan_reads(100, [&](const ReadStore& batch, uint32_t first) {
+      ASSERT_EQ(next, first);
+      ASSERT_LE(batch.size(), 100U);
+      for (uint32_t i = 0; i < batch.size(); ++i) {
+        ASSERT_EQ(reads[first + i]->id(), batch[i].id());
+        ASSERT_EQ(reads[first + i]->sequence().str(), batch[i].sequence().str());
+      }
+      next += batch.size();
+    });
+    ASSERT_EQ(reads.size(), next);
+
+    // removed overlaps are skipped and objects are reused between batches,
+    // batch sizes leave a shorter last batch, a single one or even batches
+    uint32_t scanned = overlaps.size() - 1;
+    releasePool();
+    for (uint32_t batch_size: { 1000U, scanned - 1, scanned + 1, 7U }) {
+      next = 0;
+      OverlapSet reused;
+      depot.scan_overlaps(batch_size, reads, [&](const OverlapSet& batch, uint32_t first) {
+        ASSERT_EQ(next, first);
+        if (reused.empty()) {
+          reused = batch;
+        }
+        ASSERT_EQ(std::min(batch_size, scanned - first), batch.size());
+        ASSERT_TRUE(std::equal(batch.begin(), batch.end(), reused.begin()));
+        for (uint32_t i = 0; i < batch.size(); ++i) {
+          ASSERT_EQ(overlaps[first + i + 1]->a(), batch[i]->a());
+          ASSERT_EQ(overlaps[first + i + 1]->b(), batch[i]->b());
+          ASSERT_EQ(overlaps[first + i + 1]->a_hi(), batch[i]->a_hi());
+          ASSERT_EQ(overlaps[first + i + 1]->err_rate(), batch[i]->err_rate());
+        }
+        next += batch.size();
+      });
+      ASSERT_EQ(scanned, next);
+      // slabs of the batch were returned by the scan
+      ASSERT_EQ(0U, releasePool());
+    }
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(Depot, ReadOnly) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  {
+    Depot depot("depot_dummy");
+    depot.store_reads(reads);
+    depot.store_overlaps(overlaps);
+  }
+
+  // shared locks allow several readers at once
+  Depot depot("depot_dummy", true);
+  Depot other("depot_dummy", true);
+  MappedDepot mapped("depot_dummy");
+  ASSERT_EQ(overlaps.size(), mapped.overlaps_size());
+
+  ReadSet loaded_reads;
+  other.load_reads(loaded_reads);
+  ASSERT_EQ(reads.size(), loaded_reads.size());
+
+  // loaders do not wait for each other
+  std::vector<OverlapSet> loaded(4);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < loaded.size(); ++i) {
+    threads.emplace_back([&, i]() { depot.load_overlaps(loaded[i], loaded_reads); });
+  }
+  for (auto& it: threads) it.join();
+
+  for (const auto& it: loaded) {
+    ASSERT_EQ(overlaps.size(), it.size());
+    for (uint32_t i = 0; i < overlaps.size(); ++i) {
+      ASSERT_EQ(overlaps[i]->a(), it[i]->a());
+      ASSERT_EQ(overlaps[i]->b_hi(), it[i]->b_hi());
+    }
+    for (const auto& jt: it) delete jt;
+  }
+
+  for (const auto& it: loaded_reads) delete it;
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(ShardedDepot, StoreLoad) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  {
+    ShardedDepot depot("depot_dummy/shards");
+    depot.store(reads, overlaps, 4);
+  }
+
+  ShardedDepot depot("depot_dummy/shards", true);
+  ASSERT_EQ(4U, depot.size());
+  ASSERT_EQ(reads.size(), depot.reads_size());
+
+  uint64_t owned = 0;
+  for (uint32_t k = 0; k < depot.size(); ++k) {
+    const auto& shard = depot.manifest(k);
+    ASSERT_EQ(k == 0 ? 0 : depot.manifest(k - 1).reads_end, shard.reads_begin);
+    ASSERT_LT(shard.reads_begin, shard.reads_end);
+
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(k, shard_reads, shard_overlaps);
+    ASSERT_EQ(reads.size(), shard_reads.size());
+
+    uint32_t loaded_reads = 0;
+    for (uint32_t i = 0; i < shard_reads.size(); ++i) {
+      if (i >= shard.reads_begin && i < shard.reads_end) {
+        ASSERT_EQ(k, depot.shard_of(i));
+        ASSERT_TRUE(shard_reads[i] != nullptr);
+      }
+      if (shard_reads[i] != nullptr) {
+        ASSERT_EQ(reads[i]->sequence().str(), shard_reads[i]->sequence().str());
+        ++loaded_reads;
+      }
+    }
+    ASSERT_EQ(shard.reads_end - shard.reads_begin + shard.boundary_reads, loaded_reads);
+
+    // overlaps of the shard in their original order
+    uint32_t j = 0, boundary = 0;
+    for (const auto& it: overlaps) {
+      uint32_t a = depot.shard_of(it->a()), b = depot.shard_of(it->b());
+      if (a != k && b != k) {
+        continue;
+      }
+      ASSERT_LT(j, shard_overlaps.size());
+      ASSERT_EQ(it->a(), shard_overlaps[j]->a());
+      ASSERT_EQ(it->b(), shard_overlaps[j]->b());
+      ASSERT_EQ(it->a_lo(), shard_overlaps[j]->a_lo());
+      ASSERT_EQ(it->b_hi(), shard_overlaps[j]->b_hi());
+      ++j;
+
+      if (a != b) ++boundary;
+      if (depot.owns(k, *it)) ++owned;
+    }
+    ASSERT_EQ(j, shard_overlaps.size());
+    ASSERT_EQ(shard.overlaps, j);
+    ASSERT_EQ(shard.boundary_overlaps, boundary);
+
+    for (const auto& it: shard_overlaps) delete it;
+    for (const auto& it: shard_reads) delete it;
+  }
+  ASSERT_EQ(overlaps.size(), owned);
+  ASSERT_LT(0U, depot.manifest(0).boundary_overlaps);
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(ShardedDepot, Processes) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  OverlapSet overlaps;
+  overlapReads(overlaps, reads, 75, 1, "depot_dummy/esa");
+
+  const uint32_t shards_size = 3;
+  {
+    ShardedDepot depot("depot_dummy/shards");
+    depot.store(reads, overlaps, shards_size);
+  }
+
+  // each process removes every second overlap owned by its shard
+  std::vector<pid_t> children;
+  for (uint32_t k = 0; k < shards_size; ++k) {
+    pid_t pid = fork();
+    ASSERT_LE(0, pid);
+    if (pid != 0) {
+      children.push_back(pid);
+      continue;
+    }
+
+    ShardedDepot depot("depot_dummy/shards");
+
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(k, shard_reads, shard_overlaps);
+
+    std::vector<uint32_t> removed;
+    uint32_t owned = 0;
+    for (uint32_t i = 0; i < shard_overlaps.size(); ++i) {
+      if (depot.owns(k, *shard_overlaps[i]) && owned++ % 2 == 1) {
+        removed.push_back(i);
+      }
+    }
+    depot.remove_overlaps(k, shard_overlaps, removed);
+
+    _exit(0);
+  }
+
+  for (const auto& it: children) {
+    int status;
+    ASSERT_EQ(it, waitpid(it, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+  }
+
+  ShardedDepot depot("depot_dummy/shards");
+
+  std::vector<uint32_t> owned(shards_size, 0);
+  uint32_t boundary = 0;
+  for (const auto& it: overlaps) {
+    ++owned[depot.owner(*it)];
+    if (depot.shard_of(it->a()) != depot.shard_of(it->b())) ++boundary;
+  }
+  ASSERT_LT(0U, boundary);
+
+  ASSERT_LT(0U, depot.reconcile());
+  ASSERT_EQ(0U, depot.reconcile());
+
+  uint64_t kept = 0;
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> copies(shards_size);
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> originals(shards_size);
+  for (uint32_t k = 0; k < shards_size; ++k) {
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(k, shard_reads, shard_overlaps);
+
+    for (const auto& it: shard_overlaps) {
+      if (depot.owns(k, *it)) {
+        ++kept;
+        if (depot.shard_of(it->a()) != depot.shard_of(it->b())) {
+          originals[k].emplace_back(it->a(), it->b());
+        }
+      } else {
+        copies[depot.owner(*it)].emplace_back(it->a(), it->b());
+      }
+    }
+
+    for (const auto& it: shard_overlaps) delete it;
+    for (const auto& it: shard_reads) delete it;
+  }
+
+  uint64_t expected = 0;
+  for (uint32_t k = 0; k < shards_size; ++k) {
+    expected += owned[k] - owned[k] / 2;
+
+    std::sort(copies[k].begin(), copies[k].end());
+    std::sort(originals[k].begin(), originals[k].end());
+    ASSERT_EQ(originals[k], copies[k]);
+  }
+  ASSERT_EQ(expected, kept);
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(ShardedDepot, EmptyShards) {
+
+  ReadSet reads;
+  for (uint32_t i = 0; i < 4; ++i) {
+    reads.push_back(new Read(i, "read" + std::to_string(i), "ACGTACGTAC", "", 1));
+  }
+
+  // the second shard has no overlaps
+  OverlapSet overlaps = { new Overlap(reads[0], 2, reads[1], 2, false) };
+
+  ShardedDepot depot("depot_dummy/empty_shards");
+  depot.store(reads, overlaps, 2);
+
+  ASSERT_EQ(2U, depot.size());
+  ASSERT_EQ(1U, depot.manifest(0).overlaps);
+  ASSERT_EQ(0U, depot.manifest(1).overlaps);
+
+  for (uint32_t k = 0; k < 2; ++k) {
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(k, shard_reads, shard_overlaps);
+
+    ASSERT_EQ(1U - k, shard_overlaps.size());
+    ASSERT_NE(nullptr, shard_reads[2 * k]);
+    ASSERT_NE(nullptr, shard_reads[2 * k + 1]);
+
+    depot.remove_overlaps(k, shard_overlaps, {});
+
+    for (const auto& it: shard_overlaps) delete it;
+    for (const auto& it: shard_reads) delete it;
+  }
+  ASSERT_EQ(0U, depot.reconcile());
+
+  // the first shard has all of its overlaps removed
+  {
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(0, shard_reads, shard_overlaps);
+    depot.remove_overlaps(0, shard_overlaps, { 0 });
+
+    for (const auto& it: shard_overlaps) delete it;
+    for (const auto& it: shard_reads) delete it;
+  }
+  ASSERT_EQ(0U, depot.reconcile());
+
+  for (uint32_t k = 0; k < 2; ++k) {
+    ReadSet shard_reads;
+    OverlapSet shard_overlaps;
+    depot.load_shard(k, shard_reads, shard_overlaps);
+
+    ASSERT_EQ(0U, shard_overlaps.size());
+
+    for (const auto& it: shard_reads) delete it;
+  }
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+}
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "../EnhancedSuffixArray.hpp"
+
+#include <string>
+#include <vector>
+
+static std::string randomString(uint32_t length, const char* alphabet, uint32_t alphabetSize) {
+  std::string str;
+  for (uint32_t i = 0; i < length; ++i) {
+    str.push_back(alphabet[rand() % alphabetSize]);
+  }
+  return str;
+}
+
+template<typename I>
+static void expectEqual(const EnhancedSuffixArray<I>& a, const EnhancedSuffixArray<I>& b) {
+  char* bytesA;
+  char* bytesB;
+  size_t bytesLenA, bytesLenB;
+  a.serialize(&bytesA, &bytesLenA);
+  b.serialize(&bytesB, &bytesLenB);
+
+  ASSERT_EQ(bytesLenA, bytesLenB);
+  ASSERT_EQ(0, std::memcmp(bytesA, bytesB, bytesLenA));
+
+  delete[] bytesA;
+  delete[] bytesB;
+}
+
+TEST(EnhancedSuffixArray, SuffixOrder) {
+  srand(17);
+
+  const std::string inputs[] = { "A", "ACGTACGTACGT", std::string(300, 'A'),
+    randomString(1000, "AC", 2), randomString(5000, "ACGT", 4) };
+
+  for (const auto& it: inputs) {
+    EnhancedSuffixArray<int32_t> esa(it, 4);
+    const std::string& str = esa.getString();
+
+    for (int i = 1; i < esa.getLength(); ++i) {
+      ASSERT_LT(str.compare(esa.getSuffix(i - 1), std::string::npos, str, esa.getSuffix(i),
+        std::string::npos), 0);
+    }
+
+    expectEqual(EnhancedSuffixArray<int32_t>(it, 1), esa);
+  }
+}
+
+TEST(EnhancedSuffixArray, ParallelConstruction) {
+  srand(19);
+
+  // longer than a block of parallel lookups and with repeats for deep recursion
+  std::string str = randomString(1000000, "ACGT", 4);
+  str += str.substr(1000, 500000);
+
+  EnhancedSuffixArray<int32_t> serial(str, 1);
+  EnhancedSuffixArray<int32_t> parallel(str, 8);
+
+  expectEqual(serial, parallel);
+}
+
+
+TEST(EnhancedSuffixArray, WideIndices) {
+  srand(23);
+
+  std::string str = randomString(20000, "ACGT", 4);
+  str += str.substr(100, 5000);
+
+  EnhancedSuffixArray<int32_t> esa(str, 1);
+  EnhancedSuffixArray<int64_t> wide(str, 4);
+
+  ASSERT_EQ(esa.getLength(), wide.getLength());
+  ASSERT_EQ(esa.getString(), wide.getString());
+
+  for (int32_t i = 0; i < esa.getLength(); ++i) {
+    ASSERT_EQ(esa.getSuffix(i), wide.getSuffix(i));
+  }
+
+  // walk down the lcp-interval tree for all patterns of length 6
+  std::vector<std::pair<int32_t, int32_t>> intervals(1, std::make_pair(0, esa.getLength() - 1));
+
+  for (int depth = 0; depth < 6; ++depth) {
+    std::vector<std::pair<int32_t, int32_t>> children;
+
+    for (const auto& it: intervals) {
+      for (const char c: std::string("ACGT")) {
+        int32_t s, e;
+        int64_t ws, we;
+        esa.intervalSubInterval(&s, &e, it.first, it.second, c);
+        wide.intervalSubInterval(&ws, &we, it.first, it.second, c);
+
+        ASSERT_EQ(s, ws);
+        ASSERT_EQ(e, we);
+        if (s == -1 || s == e) continue;
+
+        ASSERT_EQ(esa.intervalLcpLen(s, e), wide.intervalLcpLen(ws, we));
+        children.emplace_back(s, e);
+      }
+    }
+
+    intervals.swap(children);
+  }
+
+  char* bytes;
+  size_t bytesLen;
+
+  esa.serialize(&bytes, &bytesLen);
+  ASSERT_FALSE(isWideEnhancedSuffixArray(bytes));
+  delete[] bytes;
+
+  wide.serialize(&bytes, &bytesLen);
+  ASSERT_TRUE(isWideEnhancedSuffixArray(bytes));
+
+  EnhancedSuffixArray<int64_t>* copy = EnhancedSuffixArray<int64_t>::deserialize(bytes);
+  expectEqual(wide, *copy);
+
+  delete copy;
+  delete[] bytes;
+}
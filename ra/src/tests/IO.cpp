@@ -0,0 +1,455 @@
+#include "gtest/gtest.h"
+#include "../IO.hpp"
+#include "../Read.hpp"
+#include "../ReadStore.hpp"
+#include "../Overlap.hpp"
+#include "../Contig.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <zlib.h>
+
+static void writeFile(const char* path, const std::string& data) {
+  std::ofstream f(path);
+  f << data;
+  f.close();
+}
+
+static std::string readFile(const char* path) {
+  std::ifstream f(path);
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+static void writeGzipFile(const char* path, const std::string& data) {
+  gzFile f = gzopen(path, "wb");
+  gzwrite(f, data.data(), data.size());
+  gzclose(f);
+}
+
+// small blocks so that records are split between them
+static void writeBgzfFile(const char* path, const std::string& data, uint32_t block_size) {
+  std::ofstream f(path, std::ios::binary);
+
+  for (uint32_t i = 0; i <= data.size(); i += block_size) {
+    uint32_t length = std::min<size_t>(block_size, data.size() - i);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+
+    std::vector<unsigned char> compressed(deflateBound(&stream, length));
+    stream.next_in = (unsigned char*) data.data() + i;
+    stream.avail_in = length;
+    stream.next_out = compressed.data();
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+
+    uint32_t bsize = 18 + stream.total_out + 8 - 1;
+    uint32_t crc = crc32(0, (const unsigned char*) data.data() + i, length);
+
+    unsigned char header[18] = { 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0,
+      (unsigned char) (bsize & 0xff), (unsigned char) (bsize >> 8) };
+    unsigned char footer[8] = { (unsigned char) crc, (unsigned char) (crc >> 8),
+      (unsigned char) (crc >> 16), (unsigned char) (crc >> 24), (unsigned char) length,
+      (unsigned char) (length >> 8), (unsigned char) (length >> 16), (unsigned char) (length >> 24) };
+
+    f.write((const char*) header, 18);
+    f.write((const char*) compressed.data(), stream.total_out);
+    f.write((const char*) footer, 8);
+  }
+
+  f.close();
+}
+
+TEST(IO, FastaMultiline) {
+  writeFile("io_dummy.fasta", ">read0 desc\r\nACGT\r\nacgt\r\n>read1\nNNAC\nGT\n\n>read2\nA");
+
+  ReadSet reads;
+  readFastaReads(reads, "io_dummy.fasta");
+
+  ASSERT_EQ(3U, reads.size());
+  ASSERT_STREQ("read0 desc", reads[0]->name().c_str());
+  ASSERT_STREQ("ACGTACGT", reads[0]->sequence().str().c_str());
+  ASSERT_STREQ("read1", reads[1]->name().c_str());
+  ASSERT_STREQ("NNACGT", reads[1]->sequence().str().c_str());
+  ASSERT_STREQ("read2", reads[2]->name().c_str());
+  ASSERT_STREQ("A", reads[2]->sequence().str().c_str());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(i, reads[i]->id());
+  }
+
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.fasta");
+}
+
+TEST(IO, FastaThreadsDeterministic) {
+  srand(29);
+
+  std::string data;
+  std::vector<std::string> sequences;
+
+  // large enough to be split between threads
+  for (uint32_t i = 0; i < 2000; ++i) {
+    std::string sequence;
+    uint32_t length = 50 + rand() % 400;
+    for (uint32_t j = 0; j < length; ++j) sequence += "ACGT"[rand() % 4];
+
+    data += ">read" + std::to_string(i) + "\n";
+    for (uint32_t j = 0; j < length; j += 60) data += sequence.substr(j, 60) + "\n";
+
+    sequences.push_back(sequence);
+  }
+
+  writeFile("io_dummy.fasta", data);
+
+  ReadSet reads;
+  readFastaReads(reads, "io_dummy.fasta", 8);
+
+  ReadStore store;
+  readFastaReads(store, "io_dummy.fasta", 8);
+
+  ASSERT_EQ(sequences.size(), reads.size());
+  ASSERT_EQ(sequences.size(), store.size());
+
+  for (uint32_t i = 0; i < sequences.size(); ++i) {
+    ASSERT_EQ(i, reads[i]->id());
+    ASSERT_EQ("read" + std::to_string(i), reads[i]->name());
+    ASSERT_EQ(sequences[i], reads[i]->sequence().str());
+
+    ASSERT_EQ(i, store[i].id());
+    ASSERT_STREQ(reads[i]->name().c_str(), store[i].name());
+    ASSERT_EQ(sequences[i], store[i].sequence().str());
+  }
+
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.fasta");
+}
+
+TEST(IO, FastqThreadsDeterministic) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  ReadSet reads2;
+  readFastqReads(reads2, "../examples/ERR430949.fastq", 8);
+
+  ReadStore store;
+  readFastqReads(store, "../examples/ERR430949.fastq", 8);
+
+  ASSERT_EQ(reads.size(), reads2.size());
+  ASSERT_EQ(reads.size(), store.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(i, reads[i]->id());
+    ASSERT_EQ(reads[i]->id(), reads2[i]->id());
+    ASSERT_EQ(reads[i]->name(), reads2[i]->name());
+    ASSERT_EQ(reads[i]->quality(), reads2[i]->quality());
+    ASSERT_EQ(reads[i]->sequence().str(), reads2[i]->sequence().str());
+
+    ASSERT_EQ(reads[i]->id(), store[i].id());
+    ASSERT_STREQ(reads[i]->name().c_str(), store[i].name());
+    ASSERT_EQ(reads[i]->sequence().str(), store[i].sequence().str());
+  }
+
+  for (const auto& it: reads2) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(IO, ReadBatchReader) {
+
+  ReadStore reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  ReadBatchReader reader("../examples/ERR430949.fastq", ReadFormat::kFastq, 100, 0, 4);
+
+  ReadStore batch;
+  uint32_t total = 0;
+
+  while (reader.next_batch(batch)) {
+    ASSERT_LE(batch.size(), 100U);
+
+    for (const auto& read : batch) {
+      ASSERT_EQ(total, read.id());
+      ASSERT_STREQ(reads[total].name(), read.name());
+      ASSERT_EQ(reads[total].quality(), read.quality());
+      ASSERT_EQ(reads[total].sequence().str(), read.sequence().str());
+      ++total;
+    }
+  }
+
+  ASSERT_EQ(reads.size(), total);
+}
+
+TEST(IO, ReadBatchReaderBytes) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  ReadBatchReader reader("../examples/ERR430949.fastq", ReadFormat::kFastq, 0, 16 * 1024);
+
+  ReadSet reads2;
+  uint32_t batches = 0;
+
+  while (reader.next_batch(reads2)) {
+    ++batches;
+  }
+
+  ASSERT_LT(1U, batches);
+  ASSERT_EQ(reads.size(), reads2.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(reads[i]->id(), reads2[i]->id());
+    ASSERT_EQ(reads[i]->name(), reads2[i]->name());
+    ASSERT_EQ(reads[i]->sequence().str(), reads2[i]->sequence().str());
+  }
+
+  for (const auto& it: reads2) delete it;
+  for (const auto& it: reads) delete it;
+}
+
+TEST(IO, CompressedFastq) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  std::string data = readFile("../examples/ERR430949.fastq");
+  writeGzipFile("io_dummy.fastq.gz", data);
+  writeBgzfFile("io_dummy.fastq.bgz", data, 4000);
+
+  const char* paths[] = { "io_dummy.fastq.gz", "io_dummy.fastq.bgz" };
+
+  for (const auto& path: paths) {
+    ReadStore store;
+    readFastqReads(store, path, 4);
+
+    ReadSet reads2;
+    ReadBatchReader reader(path, ReadFormat::kFastq, 0, 16 * 1024, 4);
+    while (reader.next_batch(reads2));
+
+    ASSERT_EQ(reads.size(), store.size());
+    ASSERT_EQ(reads.size(), reads2.size());
+
+    for (uint32_t i = 0; i < reads.size(); ++i) {
+      ASSERT_EQ(reads[i]->id(), store[i].id());
+      ASSERT_STREQ(reads[i]->name().c_str(), store[i].name());
+      ASSERT_EQ(reads[i]->quality(), store[i].quality());
+      ASSERT_EQ(reads[i]->sequence().str(), store[i].sequence().str());
+
+      ASSERT_EQ(reads[i]->id(), reads2[i]->id());
+      ASSERT_EQ(reads[i]->name(), reads2[i]->name());
+      ASSERT_EQ(reads[i]->sequence().str(), reads2[i]->sequence().str());
+    }
+
+    for (const auto& it: reads2) delete it;
+    remove(path);
+  }
+
+  for (const auto& it: reads) delete it;
+}
+
+TEST(IO, CompressedFasta) {
+  std::string data = ">read0\nACGT\nACGT\n>read1\nNNAC\n\n>read2\nA";
+
+  writeBgzfFile("io_dummy.fasta.bgz", data, 7);
+
+  ReadSet reads;
+  readFastaReads(reads, "io_dummy.fasta.bgz", 3);
+
+  ASSERT_EQ(3U, reads.size());
+  ASSERT_STREQ("read0", reads[0]->name().c_str());
+  ASSERT_STREQ("ACGTACGT", reads[0]->sequence().str().c_str());
+  ASSERT_STREQ("read1", reads[1]->name().c_str());
+  ASSERT_STREQ("NNAC", reads[1]->sequence().str().c_str());
+  ASSERT_STREQ("read2", reads[2]->name().c_str());
+  ASSERT_STREQ("A", reads[2]->sequence().str().c_str());
+
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.fasta.bgz");
+}
+
+TEST(IO, WriteOverlapsThreads) {
+  srand(41);
+
+  ReadSet reads;
+  for (uint32_t i = 0; i < 100; ++i) {
+    reads.push_back(new Read(i, "read" + std::to_string(i), std::string(1000, 'A'), "", 1));
+  }
+
+  const double err_rates[] = { -1, 0, 0.125, 1.0 / 3, 12345678.9, 1e-9 };
+
+  OverlapSet overlaps;
+  for (uint32_t i = 0; i < 5000; ++i) {
+    overlaps.push_back(new Overlap(reads[rand() % 100], rand() % 100, 500 + rand() % 500,
+      false, reads[rand() % 100], rand() % 100, 500 + rand() % 500, rand() % 2,
+      err_rates[rand() % 6], err_rates[rand() % 6]));
+  }
+
+  // previous formatting, one record at a time
+  std::ostringstream expected;
+  for (const auto& it: overlaps) expected << *it;
+
+  write_overlaps(overlaps, "io_dummy.mhap", 4);
+  ASSERT_EQ(expected.str(), readFile("io_dummy.mhap"));
+
+  FILE* f = fopen("io_dummy.radump", "w");
+  for (const auto& o: overlaps) {
+    fprintf(f, "%d\t%d\t%c\t%d\t%d\t%d\t%d\t%d\t%d\t%f\t%f\t\n",
+      o->a(), o->b(), o->is_innie() ? 'I' : 'N', o->a_lo(), o->a_hi(), o->read_a()->length(),
+      o->b_lo(), o->b_hi(), o->read_b()->length(), o->orig_err_rate(), o->err_rate());
+  }
+  fclose(f);
+
+  f = fopen("io_dummy.mhap", "w");
+  writeRadumpOverlaps(f, overlaps, 3);
+  fclose(f);
+
+  ASSERT_EQ(readFile("io_dummy.radump"), readFile("io_dummy.mhap"));
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.mhap");
+  remove("io_dummy.radump");
+}
+
+TEST(IO, WriteReadsThreads) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+  reads[0]->add_coverage(1.5);
+
+  std::ostringstream afg, fasta;
+  for (const auto& read: reads) {
+    afg << "{RED" << std::endl << "clr:0," << read->length() << std::endl;
+    afg << "eid:" << read->name() << std::endl << "iid:" << read->id() << std::endl;
+    afg << "qlt:" << read->quality() << std::endl << "." << std::endl;
+    afg << "seq:" << read->sequence() << std::endl << "." << std::endl;
+    afg << "cvg:" << read->coverage() << std::endl << "}" << std::endl;
+
+    fasta << ">" << read->name() << std::endl << read->sequence() << std::endl;
+  }
+
+  writeAfgReads(reads, "io_dummy.afg", 4);
+  ASSERT_EQ(afg.str(), readFile("io_dummy.afg"));
+
+  writeFastaReads(reads, "io_dummy.fasta", 5);
+  ASSERT_EQ(fasta.str(), readFile("io_dummy.fasta"));
+
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.afg");
+  remove("io_dummy.fasta");
+}
+
+TEST(IO, AfgReads) {
+
+  ReadSet expected;
+  readFastqReads(expected, "../examples/ERR430949.fastq");
+  expected[3]->add_coverage(0.25);
+
+  writeAfgReads(expected, "io_dummy.afg");
+
+  ReadSet reads, stream_reads, batch_reads;
+  readAfgReads(reads, "io_dummy.afg", 4);
+
+  std::ifstream input("io_dummy.afg");
+  readAfgReads(stream_reads, input);
+  input.close();
+
+  ReadBatchReader reader("io_dummy.afg", ReadFormat::kAfg, 100, 0, 3);
+  while (reader.next_batch(batch_reads));
+
+  ReadStore store, empty;
+  ReadBatchReader store_reader("io_dummy.afg", ReadFormat::kAfg, 0, 0, 2);
+  ASSERT_TRUE(store_reader.next_batch(store));
+  ASSERT_FALSE(store_reader.next_batch(empty));
+
+  for (const auto& it: { &reads, &stream_reads, &batch_reads }) {
+    ASSERT_EQ(expected.size(), it->size());
+
+    for (uint32_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i]->id(), (*it)[i]->id());
+      ASSERT_EQ(expected[i]->name().substr(0, expected[i]->name().find(' ')), (*it)[i]->name());
+      ASSERT_EQ(expected[i]->sequence().str(), (*it)[i]->sequence().str());
+      ASSERT_EQ(expected[i]->quality(), (*it)[i]->quality());
+      ASSERT_EQ(expected[i]->coverage(), (*it)[i]->coverage());
+    }
+  }
+
+  ASSERT_EQ(expected.size(), store.size());
+  for (uint32_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i]->id(), store[i].id());
+    ASSERT_EQ(expected[i]->sequence().str(), store[i].sequence().str());
+    ASSERT_EQ(expected[i]->quality(), store[i].quality());
+    ASSERT_EQ(expected[i]->coverage(), store[i].coverage());
+  }
+
+  for (const auto& it: batch_reads) delete it;
+  for (const auto& it: stream_reads) delete it;
+  for (const auto& it: reads) delete it;
+  for (const auto& it: expected) delete it;
+  remove("io_dummy.afg");
+}
+
+TEST(IO, AfgMessages) {
+
+  writeFile("io_dummy.afg",
+    "{UNV\niid:1\ncom:\ncomment {RED\n}\n.\n}\n"
+    "{LIB\niid:1\n{DST\nmea:200\nstd:20\n}\n}\n"
+    "{RED\r\niid:0\r\neid:first read\r\nclr:2,10\r\nseq:\r\nACGTAC\r\nGTACGT\r\n.\r\n"
+    "qlt:\r\nABCDEF\r\nGHIJKL\r\n.\r\n}\r\n"
+    "{RED\nclr:0,8\niid:1\neid:second\nseq:TTTTGGGG\n.\nqlt:\n.\ncvg:2.5\n}\n"
+    "{RED\nclr:7,2\niid:2\neid:reversed\nseq:AACCGTTA\n.\nqlt:ABCDEFGH\n.\n}\n"
+    "{RED\niid:3\neid:whole\nclr:0,20\nseq:ACGTTGCA\n.\nqlt:\nHGFEDCBA\n.\n}\n"
+    "{OVL\nadj:I\nrds:1,0\nscr:0\nahg:-3\nbhg:4\n}\n"
+    "{LAY\n{TLE\nclr:0,8\noff:0\nsrc:1\n}\n{TLE\nclr:8,2\noff:5\nsrc:0\n}\n}\n");
+
+  ReadSet reads;
+  readAfgReads(reads, "io_dummy.afg", 2);
+
+  // expected values are the ones of the AMOS reader which was replaced
+  ASSERT_EQ(4, reads.size());
+  ASSERT_EQ(0, reads[0]->id());
+  ASSERT_EQ("first", reads[0]->name());
+  ASSERT_EQ("GTACGTAC", reads[0]->sequence().str());
+  ASSERT_EQ("ABCDEFGHIJKL", reads[0]->quality());
+  ASSERT_EQ(1, reads[0]->coverage());
+  ASSERT_EQ("second", reads[1]->name());
+  ASSERT_EQ("TTTTGGGG", reads[1]->sequence().str());
+  ASSERT_EQ("", reads[1]->quality());
+  ASSERT_EQ(2.5, reads[1]->coverage());
+  ASSERT_EQ("reversed", reads[2]->name());
+  ASSERT_EQ("A", reads[2]->sequence().str());
+  ASSERT_EQ("ABCDEFGH", reads[2]->quality());
+  ASSERT_EQ("whole", reads[3]->name());
+  ASSERT_EQ("ACGTTGCA", reads[3]->sequence().str());
+  ASSERT_EQ("HGFEDCBA", reads[3]->quality());
+
+  OverlapSet overlaps;
+  readAfgOverlaps(overlaps, reads, "io_dummy.afg", 3);
+
+  ASSERT_EQ(1, overlaps.size());
+  ASSERT_EQ(1, overlaps[0]->a());
+  ASSERT_EQ(0, overlaps[0]->b());
+  ASSERT_TRUE(overlaps[0]->is_innie());
+  ASSERT_EQ(-3, overlaps[0]->a_hang());
+  ASSERT_EQ(4, overlaps[0]->b_hang());
+
+  std::vector<Contig*> contigs;
+  readAfgContigs(contigs, "io_dummy.afg", 4);
+
+  ASSERT_EQ(1, contigs.size());
+  const auto& parts = contigs[0]->getParts();
+  ASSERT_EQ(2, parts.size());
+  ASSERT_EQ(1, parts[0].src);
+  ASSERT_EQ(8, parts[0].clr_hi);
+  ASSERT_EQ(0, parts[1].src);
+  ASSERT_EQ(8, parts[1].clr_lo);
+  ASSERT_EQ(2, parts[1].clr_hi);
+  ASSERT_EQ(5, parts[1].offset);
+
+  for (const auto& it: contigs) delete it;
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: reads) delete it;
+  remove("io_dummy.afg");
+}
@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "../MhapParser.hpp"
+#include "../Read.hpp"
+#include "../Overlap.hpp"
+
+#include <fstream>
+#include <sstream>
+
+static void writeFile(const char* path, const std::string& data) {
+  std::ofstream f(path);
+  f << data;
+  f.close();
+}
+
+class MhapParserTest: public ::testing::Test {
+protected:
+
+  void SetUp() {
+    srand(17);
+
+    for (uint32_t i = 0; i < 100; ++i) {
+      std::string sequence(1000 + rand() % 1000, 'A');
+      reads.push_back(new Read(i, "read" + std::to_string(i) + " desc", sequence, "", 1));
+    }
+
+    // enough lines to be split between threads
+    for (uint32_t i = 0; i < 20000; ++i) {
+      uint32_t a = rand() % reads.size(), b = rand() % reads.size();
+      uint32_t a_len = reads[a]->length(), b_len = reads[b]->length();
+      uint32_t a_lo = rand() % 500, a_hi = a_len - 1 - rand() % 500;
+      uint32_t b_lo = rand() % 500, b_hi = b_len - 1 - rand() % 500;
+      uint32_t b_rc = rand() % 2;
+
+      mhap += std::to_string(a + 1) + " " + std::to_string(b + 1) + " 0.17 1.0e2 0 " +
+        std::to_string(a_lo) + " " + std::to_string(a_hi) + " " + std::to_string(a_len) +
+        " " + std::to_string(b_rc) + " " + std::to_string(b_lo) + " " +
+        std::to_string(b_hi) + " " + std::to_string(b_len) + "\n";
+
+      paf += "read" + std::to_string(a) + "\t" + std::to_string(a_len) + "\t" +
+        std::to_string(a_lo) + "\t" + std::to_string(a_hi + 1) + "\t" + (b_rc ? "-" : "+") +
+        "\tread" + std::to_string(b) + "\t" + std::to_string(b_len) + "\t" +
+        std::to_string(b_lo) + "\t" + std::to_string(b_hi + 1) + "\t100\t1000\t60\ttp:A:S\n";
+    }
+  }
+
+  void TearDown() {
+    for (const auto& it: reads) delete it;
+  }
+
+  void expectEqual(const OverlapSet& expected, const OverlapSet& overlaps) {
+    ASSERT_EQ(expected.size(), overlaps.size());
+
+    for (uint32_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i]->a(), overlaps[i]->a());
+      ASSERT_EQ(expected[i]->b(), overlaps[i]->b());
+      ASSERT_EQ(expected[i]->a_lo(), overlaps[i]->a_lo());
+      ASSERT_EQ(expected[i]->a_hi(), overlaps[i]->a_hi());
+      ASSERT_EQ(expected[i]->b_lo(), overlaps[i]->b_lo());
+      ASSERT_EQ(expected[i]->b_hi(), overlaps[i]->b_hi());
+      ASSERT_EQ(expected[i]->is_innie(), overlaps[i]->is_innie());
+    }
+  }
+
+  ReadSet reads;
+  std::string mhap;
+  std::string paf;
+};
+
+TEST_F(MhapParserTest, MhapFile) {
+  writeFile("mhap_dummy.mhap", mhap);
+
+  OverlapSet expected;
+  std::istringstream input(mhap);
+  ASSERT_EQ(20000, MHAP::read_overlaps(expected, reads, input));
+
+  OverlapSet overlaps;
+  ASSERT_EQ(20000, MHAP::read_overlaps(overlaps, reads, "mhap_dummy.mhap", 8));
+
+  expectEqual(expected, overlaps);
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: expected) delete it;
+  remove("mhap_dummy.mhap");
+}
+
+TEST_F(MhapParserTest, PafFile) {
+  writeFile("mhap_dummy.paf", paf);
+
+  OverlapSet expected;
+  std::istringstream input(mhap);
+  MHAP::read_overlaps(expected, reads, input);
+
+  OverlapSet overlaps;
+  ASSERT_EQ(20000, PAF::read_overlaps(overlaps, reads, "mhap_dummy.paf", 3));
+
+  expectEqual(expected, overlaps);
+
+  for (const auto& it: overlaps) delete it;
+  for (const auto& it: expected) delete it;
+  remove("mhap_dummy.paf");
+}
+
+TEST_F(MhapParserTest, EmptyFile) {
+  writeFile("mhap_dummy.mhap", "");
+
+  OverlapSet overlaps;
+  ASSERT_EQ(0, MHAP::read_overlaps(overlaps, reads, "mhap_dummy.mhap", 4));
+  ASSERT_TRUE(overlaps.empty());
+
+  remove("mhap_dummy.mhap");
+}
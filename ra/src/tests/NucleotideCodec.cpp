@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "../NucleotideCodec.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string randomSequence(uint32_t length, const char* alphabet) {
+  std::string sequence;
+  uint32_t alphabet_length = std::strlen(alphabet);
+  for (uint32_t i = 0; i < length; ++i) {
+    sequence += alphabet[rand() % alphabet_length];
+  }
+  return sequence;
+}
+
+static char complement(char c) {
+  switch (c) {
+    case 'A': return 'T';
+    case 'T': return 'A';
+    case 'C': return 'G';
+    case 'G': return 'C';
+    default: return c;
+  }
+}
+
+TEST(NucleotideCodec, Normalize) {
+  srand(17);
+
+  // lengths cover vector bodies and scalar tails
+  for (uint32_t length = 0; length < 200; ++length) {
+    std::string src = length % 3 == 0 ? randomSequence(length, "acgtACGTnN") :
+        randomSequence(length, "acgtACGTnN\r\n -*");
+
+    std::string expected;
+    for (char c : src) {
+      if (isalpha(c)) expected += toupper(c);
+    }
+
+    std::vector<char> dst(length + 1);
+    uint32_t n = normalizeSequence(dst.data(), src.c_str(), length);
+    ASSERT_EQ(expected, std::string(dst.data(), n));
+
+    // in place
+    n = normalizeSequence(&src[0], src.c_str(), length);
+    ASSERT_EQ(expected, src.substr(0, n));
+  }
+}
+
+TEST(NucleotideCodec, ReverseComplement) {
+  srand(19);
+
+  for (uint32_t length = 0; length < 200; ++length) {
+    std::string src = randomSequence(length, "ACGTN");
+
+    std::string expected;
+    for (auto it = src.rbegin(); it != src.rend(); ++it) {
+      expected += complement(*it);
+    }
+
+    std::vector<char> dst(length + 1);
+    reverseComplementSequence(dst.data(), src.c_str(), length);
+    ASSERT_EQ(expected, std::string(dst.data(), length));
+  }
+}
+
+TEST(NucleotideCodec, Encode) {
+  srand(23);
+
+  const unsigned char table[] = { 0, 3, 2, 1, 4 };
+
+  for (uint32_t length = 0; length < 200; ++length) {
+    std::string src = randomSequence(length, "ACGTNacgt");
+
+    std::vector<unsigned char> dst(length + 1);
+    encodeSequence(dst.data(), src.c_str(), length, table);
+
+    for (uint32_t i = 0; i < length; ++i) {
+      unsigned char expected = src[i] == 'A' ? 0 : src[i] == 'C' ? 3 :
+          src[i] == 'G' ? 2 : src[i] == 'T' ? 1 : 4;
+      ASSERT_EQ(expected, dst[i]);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include "../ObjectPool.hpp"
+#include "../Read.hpp"
+#include "../Overlap.hpp"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(ObjectPool, Reuse) {
+
+  std::vector<char*> objects;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    auto object = static_cast<char*>(poolAllocate(40));
+    ASSERT_EQ(0U, (uintptr_t) object % 16);
+    std::memset(object, i % 256, 40);
+    objects.push_back(object);
+  }
+
+  // objects do not overlap
+  for (uint32_t i = 0; i < objects.size(); ++i) {
+    for (uint32_t j = 0; j < 40; ++j) {
+      ASSERT_EQ((char) (i % 256), objects[i][j]);
+    }
+  }
+
+  // objects created one after another are adjacent
+  ASSERT_EQ(objects[0] + 48, objects[1]);
+
+  auto last = objects.back();
+  poolDeallocate(last, 40);
+  ASSERT_EQ(last, poolAllocate(40));
+
+  for (const auto& it: objects) poolDeallocate(it, 40);
+
+  auto large = poolAllocate(4096);
+  poolDeallocate(large, 4096);
+}
+
+TEST(ObjectPool, Threads) {
+
+  Read read(0, "read", "ACGTACGT", "!!!!!!!!", 1);
+
+  // objects are created on several threads and deleted on another one
+  std::vector<std::vector<Overlap*>> overlaps(4);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < overlaps.size(); ++i) {
+    threads.emplace_back([i, &overlaps, &read]() {
+      for (uint32_t j = 0; j < 20000; ++j) {
+        overlaps[i].push_back(new Overlap(&read, i, &read, j, false));
+      }
+    });
+  }
+  for (auto& it: threads) it.join();
+
+  std::set<Overlap*> unique;
+  for (uint32_t i = 0; i < overlaps.size(); ++i) {
+    for (uint32_t j = 0; j < overlaps[i].size(); ++j) {
+      ASSERT_EQ((int32_t) i, overlaps[i][j]->a_hang());
+      ASSERT_EQ((int32_t) j, overlaps[i][j]->b_hang());
+      unique.insert(overlaps[i][j]);
+    }
+  }
+  ASSERT_EQ(80000U, unique.size());
+
+  for (const auto& it: overlaps) {
+    for (const auto& jt: it) delete jt;
+  }
+
+  auto clone = read.clone();
+  ASSERT_EQ(read.sequence().str(), clone->sequence().str());
+  delete clone;
+}
+
+TEST(ObjectPool, Release) {
+
+  // objects of this size are not used elsewhere, slabs hold 4096 objects
+  const size_t size = 496;
+  const size_t slab_size = 4096 * size;
+  releasePool();
+
+  std::vector<char*> objects;
+  for (uint32_t i = 0; i < 3 * 4096; ++i) {
+    objects.push_back(static_cast<char*>(poolAllocate(size)));
+  }
+  std::memset(objects.front(), 7, size);
+
+  for (uint32_t i = 1; i < objects.size(); ++i) {
+    poolDeallocate(objects[i], size);
+  }
+
+  // the slab of the remaining object is kept
+  ASSERT_EQ(2 * slab_size, releasePool());
+  ASSERT_EQ(7, objects.front()[size - 1]);
+  ASSERT_EQ(0U, releasePool());
+
+  auto object = poolAllocate(size);
+  poolDeallocate(object, size);
+
+  poolDeallocate(objects.front(), size);
+  ASSERT_EQ(slab_size, releasePool());
+}
+
+TEST(ObjectPool, ReleaseThreads) {
+
+  Read read(0, "read", "ACGTACGT", "!!!!!!!!", 1);
+  releasePool();
+
+  // a large set created on several threads and deleted on another one
+  std::vector<std::vector<Overlap*>> overlaps(4);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < overlaps.size(); ++i) {
+    threads.emplace_back([i, &overlaps, &read]() {
+      for (uint32_t j = 0; j < 5 * 4096; ++j) {
+        overlaps[i].push_back(new Overlap(&read, i, &read, j, false));
+      }
+    });
+  }
+  for (auto& it: threads) it.join();
+
+  for (const auto& it: overlaps) {
+    for (const auto& jt: it) delete jt;
+  }
+
+  // each thread filled at least four slabs of its own
+  ASSERT_LE(4 * 4 * 4096 * sizeof(Overlap), releasePool());
+  ASSERT_EQ(0U, releasePool());
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "../PackedSequence.hpp"
+#include "../Utils.hpp"
+
+TEST(PackedSequence, RoundTrip) {
+  // longer than one 64-bit word
+  std::string expected = "ACGTTGCAACGTNACGTTTTGGGGCCCCAAAAACGTBACGTACGTACGT";
+  PackedSequence sequence(expected.c_str(), expected.size());
+
+  ASSERT_EQ(expected.size(), sequence.length());
+  ASSERT_EQ(expected, SequenceView(&sequence).str());
+
+  for (uint32_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i], sequence.at(i));
+  }
+}
+
+TEST(PackedSequence, Set) {
+  std::string expected = "ACGTNACGT";
+  PackedSequence sequence(expected.c_str(), expected.size());
+
+  sequence.set(4, 'G');
+  sequence.set(0, 'N');
+  expected[4] = 'G';
+  expected[0] = 'N';
+
+  ASSERT_EQ(expected, SequenceView(&sequence).str());
+}
+
+TEST(SequenceView, ReverseComplement) {
+  std::string original = "CNGTTTTNCGTGTGNNNNCCCCGTGTGTGTGTACGTACGTAAACCCGGGTTT";
+  PackedSequence sequence(original.c_str(), original.size());
+
+  SequenceView rc(&sequence, true);
+
+  ASSERT_EQ(reverseComplement(original), rc.str());
+  ASSERT_EQ(original, rc.reverse_complement().str());
+  ASSERT_EQ(std::string(original.rbegin(), original.rend()), SequenceView(&sequence).reversed().str());
+
+  for (uint32_t i = 0; i < original.size(); ++i) {
+    ASSERT_EQ(reverseComplement(original)[i], rc[i]);
+  }
+}
+
+TEST(SequenceView, Subview) {
+  std::string original = "AAACNGTTTTGCA";
+  PackedSequence sequence(original.c_str(), original.size());
+
+  SequenceView forward(&sequence);
+  SequenceView rc(&sequence, true);
+
+  ASSERT_EQ(original.substr(3, 4), forward.substr(3, 4));
+  ASSERT_EQ(original.substr(5), forward.substr(5));
+  ASSERT_EQ(reverseComplement(original).substr(2, 6), rc.substr(2, 6));
+  ASSERT_EQ(reverseComplement(original).substr(2, 6).substr(1, 3), rc.subview(2, 6).substr(1, 3));
+
+  std::string prefix = original.substr(0, 6);
+  ASSERT_EQ(std::string(prefix.rbegin(), prefix.rend()), forward.subview(0, 6).reversed().str());
+}
+
+TEST(SequenceView, Encode) {
+  std::string original = "ACGTN";
+  PackedSequence sequence(original.c_str(), original.size());
+
+  const unsigned char table[] = { 0, 1, 2, 3, 4 };
+  unsigned char codes[5];
+
+  SequenceView(&sequence).encode(codes, table);
+  for (uint32_t i = 0; i < 5; ++i) {
+    ASSERT_EQ(i, codes[i]);
+  }
+
+  // NACGT -> 4 0 1 2 3
+  SequenceView(&sequence, true).encode(codes, table);
+  ASSERT_EQ(4, codes[0]);
+  for (uint32_t i = 1; i < 5; ++i) {
+    ASSERT_EQ(i - 1, codes[i]);
+  }
+}
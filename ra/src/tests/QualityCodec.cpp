@@ -0,0 +1,38 @@
+#include "gtest/gtest.h"
+#include "../QualityCodec.hpp"
+
+TEST(QualityCodec, Bin) {
+  ASSERT_EQ('!', binQuality('!'));
+  ASSERT_EQ('!', binQuality('"'));
+  ASSERT_EQ('!' + 6, binQuality('!' + 2));
+  ASSERT_EQ('!' + 15, binQuality('!' + 19));
+  ASSERT_EQ('!' + 22, binQuality('!' + 20));
+  ASSERT_EQ('!' + 27, binQuality('!' + 29));
+  ASSERT_EQ('!' + 33, binQuality('!' + 30));
+  ASSERT_EQ('!' + 37, binQuality('!' + 39));
+  ASSERT_EQ('!' + 40, binQuality('!' + 41));
+}
+
+TEST(QualityCodec, RunLengthEncoding) {
+  srand(5);
+
+  std::string quality;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    // long runs and single values
+    quality.append(i % 2 == 0 ? 1 + rand() % 100 : 1, '!' + rand() % 42);
+  }
+
+  std::string encoded(quality.size(), '\0');
+  encoded.resize(encodeBinnedQualities(&encoded[0], quality.c_str(), quality.size()));
+
+  ASSERT_LT(encoded.size(), quality.size());
+  ASSERT_EQ(quality.size(), binnedQualitiesLength(encoded.c_str(), encoded.size()));
+
+  std::string decoded;
+  decodeBinnedQualities(decoded, encoded.c_str(), encoded.size());
+
+  ASSERT_EQ(quality.size(), decoded.size());
+  for (uint32_t i = 0; i < quality.size(); ++i) {
+    ASSERT_EQ(binQuality(quality[i]), decoded[i]);
+  }
+}
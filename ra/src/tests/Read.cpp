@@ -1,12 +1,13 @@
 #include "gtest/gtest.h"
 #include "../Read.hpp"
+#include "../Utils.hpp"
 
 TEST(Read, AcceptsN) {
   // C.GTTTT
   const char* expected = "CNGTTTT";
   auto read2 = new Read(2, "read2", expected, "", 1);
 
-  ASSERT_STREQ(expected, read2->sequence().c_str());
+  ASSERT_STREQ(expected, read2->sequence().str().c_str());
 
   delete read2;
 }
@@ -24,7 +25,7 @@ TEST(Read, Serialization) {
 
     ASSERT_EQ(read1->id(), read2->id());
     ASSERT_STREQ(read1->name().c_str(), read2->name().c_str());
-    ASSERT_STREQ(read1->sequence().c_str(), read2->sequence().c_str());
+    ASSERT_STREQ(read1->sequence().str().c_str(), read2->sequence().str().c_str());
     ASSERT_STREQ(read1->quality().c_str(), read2->quality().c_str());
     ASSERT_EQ(read1->coverage(), read2->coverage());
 
@@ -32,3 +33,16 @@ TEST(Read, Serialization) {
     delete[] bytes;
     delete read2;
 }
+
+TEST(Read, ReverseComplementView) {
+  const char* expected = "CNGTTTTNCGTGTGNNNNCCCCGTGTGTGTGT";
+  auto read = new Read(1, "read1", expected, "", 1);
+
+  ASSERT_EQ(reverseComplement(expected), read->reverse_complement().str());
+
+  read->correct_base(1, 'A');
+  ASSERT_EQ('A', read->sequence()[1]);
+  ASSERT_EQ('T', read->reverse_complement()[read->length() - 2]);
+
+  delete read;
+}
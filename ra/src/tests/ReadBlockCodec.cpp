@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "../ReadBlockCodec.hpp"
+#include "../Read.hpp"
+
+#include <string>
+
+static std::string decodeHuffman(const std::vector<char>& encoded) {
+  std::vector<char> decoded;
+  decodeHuffman(decoded, encoded.data(), encoded.size());
+  return std::string(decoded.begin(), decoded.end());
+}
+
+TEST(ReadBlockCodec, Huffman) {
+  srand(11);
+
+  // skewed distribution with long codes for rare symbols
+  std::string src;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    uint32_t r = rand() % (1 << 20);
+    src.push_back(r < (1 << 19) ? 'F' : (char) (r % 256));
+  }
+
+  std::vector<char> encoded;
+  encodeHuffman(encoded, src.data(), src.size());
+  ASSERT_LT(encoded.size(), src.size());
+  ASSERT_EQ(src, decodeHuffman(encoded));
+
+  const std::string inputs[] = { "", "A", "AAAAAAAA", "AB", std::string(1000, '\0') };
+  for (const auto& it: inputs) {
+    encoded.clear();
+    encodeHuffman(encoded, it.data(), it.size());
+    ASSERT_EQ(it, decodeHuffman(encoded));
+  }
+}
+
+TEST(ReadBlockCodec, ReadBlock) {
+  srand(13);
+
+  const QualityMode modes[] = { QualityMode::kRaw, QualityMode::kBinned, QualityMode::kDrop };
+
+  ReadSet reads;
+  for (uint32_t i = 0; i < 300; ++i) {
+    std::string sequence, quality;
+    for (uint32_t j = 0, length = 1 + rand() % 500; j < length; ++j) {
+      sequence.push_back(rand() % 50 == 0 ? 'N' : "ACGT"[rand() % 4]);
+      quality.push_back('!' + rand() % 42);
+    }
+
+    // identifiers are not required to be ordered
+    reads.push_back(new Read(i % 7 == 0 ? 1000 - i : i, "read" + std::to_string(i / 3),
+      sequence, i % 5 == 0 ? "" : quality, i * 0.5, modes[i % 3]));
+  }
+
+  std::vector<const char*> records;
+  std::vector<uint32_t> records_length;
+  for (const auto& it: reads) {
+    char* bytes;
+    uint32_t bytes_length;
+    it->serialize(&bytes, &bytes_length);
+    records.push_back(bytes);
+    records_length.push_back(bytes_length);
+  }
+
+  std::vector<char> encoded;
+  encodeReadBlock(encoded, records);
+
+  ReadBlock block;
+  decodeReadBlock(block, encoded.data(), encoded.size());
+
+  ASSERT_EQ(reads.size(), block.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(0, std::memcmp(records[i], block.record(i), records_length[i]));
+
+    auto read = Read::deserialize(block.record(i));
+    ASSERT_EQ(reads[i]->id(), read->id());
+    ASSERT_EQ(reads[i]->name(), read->name());
+    ASSERT_EQ(reads[i]->sequence().str(), read->sequence().str());
+    ASSERT_EQ(reads[i]->quality(), read->quality());
+    ASSERT_EQ(reads[i]->coverage(), read->coverage());
+    delete read;
+  }
+
+  for (const auto& it: records) delete[] it;
+  for (const auto& it: reads) delete it;
+}
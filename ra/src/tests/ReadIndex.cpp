@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+#include "../ra.hpp"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// short overlapping reads with duplicates and Ns
+static std::vector<Read*> randomReads(uint32_t length) {
+  std::string genome;
+  for (int i = 0; i < 300; ++i) {
+    genome.push_back("ACGT"[rand() % 4]);
+  }
+
+  std::vector<Read*> reads;
+  for (uint32_t i = 0; i < length; ++i) {
+    int len = 1 + rand() % 25;
+    std::string sequence = genome.substr(rand() % (genome.size() - len), len);
+    if (rand() % 10 == 0) sequence[rand() % len] = 'N';
+
+    reads.push_back(new Read(i, "read" + std::to_string(i), sequence, "", 1));
+    if (rand() % 5 == 0 && ++i < length) {
+      reads.push_back(new Read(i, "read" + std::to_string(i), sequence, "", 1));
+    }
+  }
+
+  return reads;
+}
+
+static void expectEqual(const ReadIndex& a, const ReadIndex& b, const std::vector<Read*>& reads,
+    int minOverlapLen) {
+
+  for (const auto& read: reads) {
+    std::vector<int> duplicatesA, duplicatesB;
+    a.readDuplicates(duplicatesA, read);
+    b.readDuplicates(duplicatesB, read);
+    std::sort(duplicatesA.begin(), duplicatesA.end());
+    std::sort(duplicatesB.begin(), duplicatesB.end());
+    ASSERT_EQ(duplicatesA, duplicatesB);
+
+    for (int rk = 0; rk < 2; ++rk) {
+      std::vector<std::pair<int, int>> matchesA, matchesB;
+      a.readPrefixSuffixMatches(matchesA, read, rk, minOverlapLen);
+      b.readPrefixSuffixMatches(matchesB, read, rk, minOverlapLen);
+      std::sort(matchesA.begin(), matchesA.end());
+      std::sort(matchesB.begin(), matchesB.end());
+      ASSERT_EQ(matchesA, matchesB);
+    }
+
+    std::string sequence = read->sequence().str();
+    for (int m = 1; m <= (int) sequence.size(); m += 3) {
+      ASSERT_EQ(a.numberOfOccurrences(sequence.c_str(), m),
+        b.numberOfOccurrences(sequence.c_str(), m));
+    }
+  }
+}
+
+TEST(ReadIndex, FmIndexMatchesEnhancedSuffixArray) {
+  srand(29);
+
+  std::vector<Read*> reads = randomReads(500);
+
+  for (int rk = 0; rk < 2; ++rk) {
+    ReadIndex esa(reads, rk, 1, ReadIndexType::kEsa);
+    ReadIndex fm(reads, rk, 2, ReadIndexType::kFm);
+
+    ASSERT_EQ(ReadIndexType::kEsa, esa.type());
+    ASSERT_EQ(ReadIndexType::kFm, fm.type());
+    ASSERT_LT(fm.sizeInBytes(), esa.sizeInBytes());
+
+    for (int minOverlapLen: { 1, 5, 12 }) {
+      expectEqual(esa, fm, reads, minOverlapLen);
+    }
+  }
+
+  for (const auto& read: reads) delete read;
+}
+
+TEST(ReadIndex, FmIndexSerialization) {
+  srand(31);
+
+  std::vector<Read*> reads = randomReads(200);
+
+  ReadIndex fm(reads, 0, 1, ReadIndexType::kFm);
+
+  char* bytes;
+  size_t bytesLen;
+  fm.serialize(&bytes, &bytesLen);
+  ASSERT_EQ(fm.sizeInBytes(), bytesLen);
+
+  ReadIndex* copy = ReadIndex::deserialize(bytes);
+  ASSERT_EQ(ReadIndexType::kFm, copy->type());
+  expectEqual(fm, *copy, reads, 5);
+
+  delete copy;
+  delete[] bytes;
+
+  const char* path = "read_index_dummy.nra";
+
+  fm.store(path);
+  ASSERT_EQ(nullptr, ReadIndex::load(path, ReadIndexType::kEsa));
+
+  ReadIndex* loaded = ReadIndex::load(path, ReadIndexType::kFm);
+  ASSERT_NE(nullptr, loaded);
+  expectEqual(fm, *loaded, reads, 5);
+
+  delete loaded;
+  unlink(path);
+
+  for (const auto& read: reads) delete read;
+}
+
+// library calls of ra_overlap and ra_correct give the same results with both indices
+TEST(ReadIndex, FmIndexPipeline) {
+
+  using OverlapKey = std::tuple<uint32_t, uint32_t, int32_t, int32_t, bool>;
+
+  std::vector<OverlapKey> keys[2];
+  std::vector<std::string> corrected[2];
+  bool success[2];
+
+  const ReadIndexType types[2] = { ReadIndexType::kEsa, ReadIndexType::kFm };
+  const char* paths[2] = { "read_index_dummy_esa", "read_index_dummy_fm" };
+
+  for (int t = 0; t < 2; ++t) {
+    ReadSet reads;
+    readFastqReads(reads, "../examples/ERR430949.fastq");
+
+    ReadSet filtered;
+    filterReads(filtered, reads, true, types[t]);
+
+    OverlapSet overlaps;
+    overlapReads(overlaps, filtered, 75, 2, "", types[t]);
+    ASSERT_LT(0U, overlaps.size());
+
+    for (const auto& it: overlaps) {
+      keys[t].emplace_back(it->a(), it->b(), it->a_hang(), it->b_hang(), it->is_innie());
+    }
+    std::sort(keys[t].begin(), keys[t].end());
+
+    success[t] = correctReads(reads, 15, 3, 2, paths[t], types[t]);
+    for (const auto& it: reads) {
+      corrected[t].push_back(it->sequence().str());
+    }
+    unlink((std::string(paths[t]) + ".cra").c_str());
+
+    for (const auto& it: overlaps) delete it;
+    for (const auto& it: reads) delete it;
+  }
+
+  ASSERT_EQ(keys[0], keys[1]);
+  ASSERT_TRUE(success[0]);
+  ASSERT_TRUE(success[1]);
+  ASSERT_EQ(corrected[0], corrected[1]);
+}
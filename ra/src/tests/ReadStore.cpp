@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "../ReadStore.hpp"
+#include "../Read.hpp"
+#include "../Depot.hpp"
+#include "../IO.hpp"
+
+TEST(ReadStore, Add) {
+  ReadStore store;
+
+  const char* sequence = "acgtNNacgt-tttt";
+  store.add(7, "read7", 5, sequence, std::strlen(sequence), "", 0, 2.5);
+
+  ASSERT_EQ(1U, store.size());
+  ASSERT_EQ(7U, store[0].id());
+  ASSERT_STREQ("read7", store[0].name());
+  ASSERT_STREQ("ACGTNNACGTTTTT", store[0].sequence().str().c_str());
+  ASSERT_STREQ("AAAAACGTNNACGT", store[0].reverse_complement().str().c_str());
+  ASSERT_EQ(14U, store[0].length());
+  ASSERT_EQ(0U, store[0].quality_length());
+  ASSERT_EQ(2.5, store[0].coverage());
+}
+
+TEST(ReadStore, MatchesReadSet) {
+
+  ReadSet reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  ReadStore store;
+  readFastqReads(store, "../examples/ERR430949.fastq");
+
+  ASSERT_EQ(reads.size(), store.size());
+
+  uint32_t i = 0;
+  for (const auto& read : store) {
+    ASSERT_EQ(reads[i]->id(), read.id());
+    ASSERT_EQ(reads[i]->length(), read.length());
+    ASSERT_STREQ(reads[i]->name().c_str(), read.name());
+    ASSERT_EQ(reads[i]->quality(), read.quality());
+    ASSERT_EQ(reads[i]->sequence().str(), read.sequence().str());
+    ASSERT_EQ(reads[i]->reverse_complement().str(), read.reverse_complement().str());
+    ++i;
+  }
+
+  for (const auto& it: reads) delete it;
+}
+
+TEST(ReadStore, DepotStoreLoad) {
+
+  ReadStore reads;
+  readFastqReads(reads, "../examples/ERR430949.fastq");
+
+  auto depot = new Depot("depot_dummy");
+  depot->store_reads(reads);
+
+  // stored in the same format as Read objects
+  ReadSet reads2;
+  depot->load_reads(reads2);
+
+  ReadStore reads3;
+  depot->load_reads(reads3);
+
+  ASSERT_EQ(reads.size(), reads2.size());
+  ASSERT_EQ(reads.size(), reads3.size());
+
+  for (uint32_t i = 0; i < reads.size(); ++i) {
+    ASSERT_EQ(reads[i].id(), reads2[i]->id());
+    ASSERT_STREQ(reads[i].name(), reads2[i]->name().c_str());
+    ASSERT_EQ(reads[i].quality(), reads2[i]->quality());
+    ASSERT_EQ(reads[i].sequence().str(), reads2[i]->sequence().str());
+    ASSERT_EQ(reads[i].coverage(), reads2[i]->coverage());
+
+    ASSERT_EQ(reads[i].id(), reads3[i].id());
+    ASSERT_STREQ(reads[i].name(), reads3[i].name());
+    ASSERT_EQ(reads[i].quality(), reads3[i].quality());
+    ASSERT_EQ(reads[i].sequence().str(), reads3[i].sequence().str());
+    ASSERT_EQ(reads[i].coverage(), reads3[i].coverage());
+  }
+
+  delete depot;
+
+  for (const auto& it: reads2) delete it;
+}
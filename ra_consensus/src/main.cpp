@@ -54,10 +54,10 @@ int main(int argc, char* argv[]) {
     ASSERT(contigsPath, "IO", "missing option -j (overaps file)");
 
     std::vector<Read*> reads;
-    readAfgReads(reads, readsPath);
+    readAfgReads(reads, readsPath, threadLen);
 
     std::vector<Contig*> contigs;
-    readAfgContigs(contigs, contigsPath);
+    readAfgContigs(contigs, contigsPath, threadLen);
 
     std::vector<Read*> transcripts;
 
@@ -77,7 +77,7 @@ int main(int argc, char* argv[]) {
     timer.stop();
     timer.print("Consensus", "poa");
 
-    writeFastaReads(transcripts, outPath);
+    writeFastaReads(transcripts, outPath, threadLen);
 
     for (const auto& it : transcripts) delete it;
 
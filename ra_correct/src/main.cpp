@@ -9,6 +9,7 @@ const struct option options[] = {
     {"threshold", required_argument, 0, 'c'},
     {"threads", required_argument, 0, 't'},
     {"out", required_argument, 0, 'o'},
+    {"fm-index", no_argument, 0, 'f'},
     {"help", no_argument, 0, 'h'},
     {0, 0, 0, 0}
 };
@@ -26,6 +27,8 @@ int main(int argc, char* argv[]) {
 
     char* outPath = nullptr;
 
+    ReadIndexType indexType = ReadIndexType::kEsa;
+
     while (1) {
 
         char argument = getopt_long(argc, argv, "i:o:k:c:t:h", options, nullptr);
@@ -50,6 +53,9 @@ int main(int argc, char* argv[]) {
         case 't':
             threadLen = atoi(optarg);
             break;
+        case 'f':
+            indexType = ReadIndexType::kFm;
+            break;
         default:
             help();
             return -1;
@@ -60,10 +66,10 @@ int main(int argc, char* argv[]) {
     ASSERT(threadLen > 0, "IO", "invalid thread number");
 
     std::vector<Read*> reads;
-    readAfgReads(reads, readsPath);
+    readAfgReads(reads, readsPath, threadLen);
 
-    if (correctReads(reads, k, c, threadLen, readsPath)) {
-        writeAfgReads(reads, outPath);
+    if (correctReads(reads, k, c, threadLen, readsPath, indexType)) {
+        writeAfgReads(reads, outPath, threadLen);
     }
 
     for (const auto& read : reads) delete read;
@@ -89,6 +95,10 @@ static void help() {
     "    -o, --out <file>\n"
     "        default: cout\n"
     "        output afg corrected reads file\n"
+    "    --fm-index\n"
+    "        default: false\n"
+    "        index reads with an FM-index instead of an enhanced suffix array\n"
+    "        (under a byte per base instead of 13, slower queries)\n"
     "    -h, -help\n"
     "        prints out the help\n");
 }
\ No newline at end of file
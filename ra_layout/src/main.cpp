@@ -70,10 +70,10 @@ int main(int argc, char* argv[]) {
     ASSERT(overlapsPath, "IO", "missing option -j (overaps file)");
 
     std::vector<Read*> reads;
-    readAfgReads(reads, readsPath);
+    readAfgReads(reads, readsPath, threadLen);
 
     std::vector<Overlap*> overlaps;
-    readAfgOverlaps(overlaps, overlapsPath);
+    readAfgOverlaps(overlaps, reads, overlapsPath, threadLen);
 
     StringGraph* graph = new StringGraph(reads, overlaps);
 
@@ -104,7 +104,7 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        writeFastaReads(transcripts, "transcripts.layout.fasta");
+        writeFastaReads(transcripts, "transcripts.layout.fasta", threadLen);
 
         for (const auto& it : transcripts) delete it;
     }
@@ -127,7 +127,7 @@ int main(int argc, char* argv[]) {
     timer.stop();
     timer.print("Layout", "contig extraction");
 
-    writeAfgContigs(contigs, outPath);
+    writeAfgContigs(contigs, outPath, threadLen);
 
     for (const auto& it : contigs) delete it;
 
@@ -9,6 +9,7 @@ const struct option options[] = {
     {"threads", required_argument, 0, 't'},
     {"reads-out", required_argument, 0, 'r'},
     {"out", required_argument, 0, 'o'},
+    {"fm-index", no_argument, 0, 'f'},
     {"help", no_argument, 0, 'h'},
     {0, 0, 0, 0}
 };
@@ -25,6 +26,8 @@ int main(int argc, char* argv[]) {
     char* readsOut = nullptr;
     char* overlapsOut = nullptr;
 
+    ReadIndexType indexType = ReadIndexType::kEsa;
+
     while (1) {
 
         char argument = getopt_long(argc, argv, "i:m:t:o:h", options, nullptr);
@@ -49,6 +52,9 @@ int main(int argc, char* argv[]) {
         case 'o':
             overlapsOut = optarg;
             break;
+        case 'f':
+            indexType = ReadIndexType::kFm;
+            break;
         default:
             help();
             return -1;
@@ -60,13 +66,13 @@ int main(int argc, char* argv[]) {
     ASSERT(threadLen > 0, "IO", "invalid thread number");
 
     std::vector<Read*> reads;
-    readAfgReads(reads, readsPath);
+    readAfgReads(reads, readsPath, threadLen);
 
     std::vector<Read*> filtered;
-    filterReads(filtered, reads);
+    filterReads(filtered, reads, true, indexType);
 
     std::vector<Overlap*> overlaps;
-    overlapReads(overlaps, filtered, minOverlapLen, threadLen, readsPath);
+    overlapReads(overlaps, filtered, minOverlapLen, threadLen, readsPath, indexType);
 
     std::vector<Overlap*> notContained;
     filterContainedOverlaps(notContained, overlaps, filtered);
@@ -77,7 +83,7 @@ int main(int argc, char* argv[]) {
     updateOverlapIds(notTransitive, filtered);
 
     writeOverlaps(notTransitive, overlapsOut);
-    writeAfgReads(reads, readsOut == nullptr ? "reads.afg" : readsOut);
+    writeAfgReads(reads, readsOut == nullptr ? "reads.afg" : readsOut, threadLen);
 
     for (const auto& it : overlaps) delete it;
 
@@ -107,6 +113,10 @@ static void help() {
     "    -o, --out <file>\n"
     "        default: cout\n"
     "        output afg overlaps file\n"
+    "    --fm-index\n"
+    "        default: false\n"
+    "        index reads with an FM-index instead of an enhanced suffix array\n"
+    "        (under a byte per base instead of 13, slower queries)\n"
     "    -h, -help\n"
     "        prints out the help\n");
 }
@@ -6,11 +6,14 @@
 const struct option options[] = {
     {"reads", required_argument, 0, 'i'},
     {"fastq", no_argument, 0, 'q'},
+    {"threads", required_argument, 0, 't'},
     {"out", required_argument, 0, 'o'},
     {"help", no_argument, 0, 'h'},
     {0, 0, 0, 0}
 };
 
+static const uint64_t kBatchSize = 256 * 1024 * 1024;
+
 static void help();
 
 int main(int argc, char* argv[]) {
@@ -19,11 +22,13 @@ int main(int argc, char* argv[]) {
 
     bool fastq = false;
 
+    int threadLen = std::max(std::thread::hardware_concurrency(), 1U);
+
     char* outPath = nullptr;
 
     while (1) {
 
-        char argument = getopt_long(argc, argv, "i:o:h", options, nullptr);
+        char argument = getopt_long(argc, argv, "i:t:o:h", options, nullptr);
 
         if (argument == -1) {
             break;
@@ -39,6 +44,9 @@ int main(int argc, char* argv[]) {
         case 'q':
             fastq = true;
             break;
+        case 't':
+            threadLen = atoi(optarg);
+            break;
         default:
             help();
             return -1;
@@ -46,18 +54,23 @@ int main(int argc, char* argv[]) {
     }
 
     ASSERT(readsPath, "IO", "missing option -i (reads file)");
+    ASSERT(threadLen > 0, "IO", "invalid thread number");
 
-    std::vector<Read*> reads;
+    std::ofstream file;
+    if (outPath != nullptr) file.open(outPath, std::ios::out);
 
-    if (fastq) {
-        readFastqReads(reads, readsPath);
-    } else {
-        readFastaReads(reads, readsPath);
-    }
+    std::ostream& out = outPath == nullptr ? std::cout : file;
+
+    // reads are converted in batches so memory usage is bounded
+    ReadBatchReader reader(readsPath, fastq ? ReadFormat::kFastq : ReadFormat::kFasta,
+        0, kBatchSize, threadLen);
 
-    writeAfgReads(reads, outPath);
+    ReadStore reads;
+    while (reader.next_batch(reads)) {
+        writeAfgReads(reads, out, threadLen);
+    }
 
-    for (const auto& read : reads) delete read;
+    if (outPath != nullptr) file.close();
 
     return 0;
 }
@@ -70,10 +83,13 @@ static void help() {
     "arguments:\n"
     "    -i, --reads <file>\n"
     "        (required)\n" 
-    "        input fasta/fastq reads file\n"
+    "        input fasta/fastq reads file (optionally gzip or BGZF compressed)\n"
     "    --fastq\n"
     "        default: fasta format\n"
     "        format of input reads file\n"
+    "    -t, --threads <int>\n"
+    "        default: approx. number of processors/cores\n"
+    "        number of threads used for parsing and decompression\n"
     "    -o, --out <file>\n"
     "        output afg reads file\n"
     "    -h, -help\n"
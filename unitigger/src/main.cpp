@@ -256,7 +256,8 @@ int main(int argc, char **argv) {
   vector<Read*> reads;
   vector<Overlap*> overlaps;
 
-  Depot depot(depot_path);
+  // several unitigger runs can read the same depot at once
+  Depot depot(depot_path, true);
 
   depot.load_reads(reads);
   fprintf(stderr, "Read %lu reads\n", reads.size());
@@ -285,7 +286,7 @@ int main(int argc, char **argv) {
     Contig *unitig = new Contig(unitig_walk);
     unitigs.push_back(unitig);
   }
-  writeAfgContigs(unitigs, (working_directory + "/unitigs.afg").c_str());
+  writeAfgContigs(unitigs, (working_directory + "/unitigs.afg").c_str(), thread_num);
 
   std::vector<StringGraphWalk*> contig_walks;
   extract_contig_walks(&contig_walks, graph);
@@ -301,11 +302,11 @@ int main(int argc, char **argv) {
     Contig *contig = new Contig(contig_walk);
     contigs.push_back(contig);
   }
-  writeAfgContigs(contigs, (working_directory + "/contigs.afg").c_str());
+  writeAfgContigs(contigs, (working_directory + "/contigs.afg").c_str(), thread_num);
 
   vector<Overlap*> remaining_overlaps;
   graph->extractOverlaps(remaining_overlaps);
-  write_overlaps(remaining_overlaps, working_directory + "/final.mhap");
+  write_overlaps(remaining_overlaps, working_directory + "/final.mhap", thread_num);
 
   //Graph::Graph* g = Graph::Graph::from_overlaps(remaining_overlaps);
   //auto calculator = new Graph::BestBuddyCalculator(g);
@@ -72,6 +72,9 @@ int main(int argc, char **argv) {
   depot.load_overlaps(overlaps, reads);
   fprintf(stderr, "Read %lu overlaps\n", overlaps.size());
 
+  // only widened overlaps are appended to the depot, others are kept or removed
+  vector<Overlap*> loaded(overlaps);
+
   int size_before = overlaps.size();
   filterNonDovetailOverlaps(&overlaps);
   int size_after = overlaps.size();
@@ -80,13 +83,18 @@ int main(int argc, char **argv) {
   fprintf(stderr, "Filtered %d (%lf%%) overlaps\n", non_dovetail, 100. * non_dovetail/(double) size_before);
 
   vector<Overlap*> dovetail_overlaps(overlaps.size());
+  vector<Overlap*> widened_overlaps;
   set<const Read*> contained_reads;
   for (int i = 0; i < (int) overlaps.size(); ++i) {
-    auto o = forcedDovetailOverlap(overlaps[i], true);
+    auto o = overlaps[i]->is_dovetail() ? overlaps[i] : forcedDovetailOverlap(overlaps[i], true);
     if (o == nullptr) {
       continue;
     }
 
+    if (o != overlaps[i]) {
+      widened_overlaps.push_back(o);
+    }
+
     dovetail_overlaps[i] = o;
 
     if (o->is_using_prefix(o->a()) && o->is_using_suffix(o->a())) {
@@ -120,12 +128,14 @@ int main(int argc, char **argv) {
 
   dovetail_overlaps.resize(idx);
 
-  fprintf(stderr, "Writing %u overlaps to depot...\n", dovetail_overlaps.size());
-  depot.store_overlaps(dovetail_overlaps);
+  fprintf(stderr, "Writing %zu overlaps to depot...\n", dovetail_overlaps.size());
+  // the depot is not rewritten in input order anymore: kept dovetail overlaps
+  // stay in place and widened ones are loaded after them (last segment)
+  depot.update_overlaps(loaded, dovetail_overlaps);
 
   for (auto r: reads)               delete r;
-  for (auto o: overlaps)            delete o;
-  for (auto do_: dovetail_overlaps) delete do_;
+  for (auto o: loaded)              delete o;
+  for (auto wo: widened_overlaps)   delete wo;
 
   return 0;
 }
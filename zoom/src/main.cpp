@@ -4,34 +4,36 @@
 #include <algorithm>
 #include <ctime>
 #include <iostream>
-#include <list>
 #include <map>
 #include <sys/stat.h>
 #include <vector>
 
 using std::cout;
 using std::endl;
-using std::list;
 using std::map;
 using std::string;
 using std::vector;
 
-map<int, list<Overlap*>> edges;
-
-void dfs(vector<Overlap*>* neighborhood, map<Overlap*, bool>* used, const int node, const int depth) {
+void dfs(vector<uint32_t>* neighborhood, map<uint32_t, bool>* used, const MappedDepot& depot,
+    const int node, const int depth) {
   if (depth <= 0) {
     return;
   }
 
-  for (auto e: edges[node]) {
-    auto next = e->a() == node ? e->b() : e->a();
+  // overlap indices of the node are looked up in the depot index
+  vector<uint32_t> edges;
+  depot.read_overlaps(node, edges);
+
+  for (auto e: edges) {
+    auto overlap = depot.overlap(e);
+    auto next = (int) overlap.a() == node ? overlap.b() : overlap.a();
     if (used->count(e)) {
       continue;
     }
     (*used)[e] = true;
 
     neighborhood->push_back(e);
-    dfs(neighborhood, used, next, depth - 1);
+    dfs(neighborhood, used, depot, next, depth - 1);
   }
 }
 
@@ -50,32 +52,21 @@ int main(int argc, char **argv) {
   const int depth = args.get<int>("depth");
   const string depot_path = args.get<string>("depot");
 
-  Depot depot(depot_path);
-
-  vector<Read*> reads;
-  depot.load_reads(reads);
-  fprintf(stderr, "%lu reads loaded\n", reads.size());
-
-  vector<Overlap*> overlaps;
-  depot.load_overlaps(overlaps, reads);
-  fprintf(stderr, "%lu overlaps loaded\n", overlaps.size());
+  // overlaps are read in place, only the neighborhood is printed
+  MappedDepot depot(depot_path);
+  fprintf(stderr, "%u overlaps mapped\n", depot.overlaps_size());
 
-  for (auto o: overlaps) {
-    edges[o->a()].push_back(o);
-    edges[o->b()].push_back(o);
-  }
-
-  vector<Overlap*> neighborhood;
-  map<Overlap*, bool> used;
-  dfs(&neighborhood, &used, root, depth);
+  vector<uint32_t> neighborhood;
+  map<uint32_t, bool> used;
+  dfs(&neighborhood, &used, depot, root, depth);
 
+  // same as Overlap::print
   fprintf(stderr, "%lu overlaps written\n", neighborhood.size());
   for (auto e: neighborhood) {
-    std::cout << *e;
-  }
-
-  for (auto o: overlaps) {
-    delete o;
+    auto o = depot.overlap(e);
+    cout << o.a() << "\t" << o.b() << "\t" << (o.is_innie() ? 'I' : 'N') << "\t";
+    cout << o.a_hang() << "\t" << o.b_hang() << "\t" << o.err_rate() << "\t";
+    cout << o.orig_err_rate() << endl;
   }
 
   return 0;